@@ -83,20 +83,22 @@ isEmpty(PREVIEW) {
   }
 }
 
-include(templates/templates.pri)
-include(parser/parser.pri)
+include(../libinyokaparser/libinyokaparser.pri)
 
 HEADERS       += inyokaedit.h \
+                 batchrenderer.h \
+                 connectivitymonitor.h \
                  download.h \
                  downloadimg.h \
                  fileoperations.h \
                  findreplace.h \
+                 livesyntaxcheck.h \
                  plugins.h \
+                 previewcontent.h \
                  texteditor.h \
                  session.h \
                  settings.h \
                  settingsdialog.h \
-                 syntaxcheck.h \
                  upload.h \
                  utils.h \
                  xmlparser.h \
@@ -104,16 +106,19 @@ HEADERS       += inyokaedit.h \
 
 SOURCES       += main.cpp \
                  inyokaedit.cpp \
+                 batchrenderer.cpp \
+                 connectivitymonitor.cpp \
                  download.cpp \
                  downloadimg.cpp \
                  fileoperations.cpp \
                  findreplace.cpp \
+                 livesyntaxcheck.cpp \
                  plugins.cpp \
+                 previewcontent.cpp \
                  texteditor.cpp \
                  session.cpp \
                  settings.cpp \
                  settingsdialog.cpp \
-                 syntaxcheck.cpp \
                  upload.cpp \
                  xmlparser.cpp \
                  utils.cpp
@@ -0,0 +1,405 @@
+/**
+ * \file batchrenderer.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Render articles to HTML and an error report without any GUI.
+ */
+
+#include "./batchrenderer.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QScopedPointer>
+#include <QSet>
+#include <QSettings>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "./parser/parser.h"
+#include "./templates/templates.h"
+
+namespace {
+struct WorkerSetup {
+  QString sSharePath;
+  QString sUserDataDir;
+  QString sCommunity;
+  QString sInyokaUrl;
+  QString sPygmentize;
+  bool bPreferPygments;
+  bool bCompare;
+};
+
+// Markers differ between block-wise and whole article parsing
+auto removeBlockMarkers(QString sHtml) -> QString {
+  sHtml.remove(QLatin1String(Parser::BLOCK_MARKER));
+  const QLatin1String sEndMarker(Parser::BLOCK_END_MARKER);
+  const QLatin1String sLinesMarker(Parser::SOURCE_LINES_MARKER);
+  const int nEnd = sHtml.indexOf(sEndMarker);
+  if (-1 != nEnd) {
+    sHtml.remove(nEnd, sEndMarker.size());
+    if (sHtml.midRef(nEnd, sLinesMarker.size()) == sLinesMarker) {
+      const int nLinesEnd = sHtml.indexOf(QLatin1String("-->"), nEnd);
+      if (-1 != nLinesEnd) {
+        sHtml.remove(nEnd, nLinesEnd + 3 - nEnd);
+      }
+    }
+  }
+  return sHtml;
+}
+
+class RenderWorker : public QRunnable {
+ public:
+    RenderWorker(const WorkerSetup &setup, BatchRenderer::RenderJob *pJobs,
+                 const int nJobs, QAtomicInt *pNextJob)
+      : m_Setup(setup),
+        m_pJobs(pJobs),
+        m_nJobs(nJobs),
+        m_pNextJob(pNextJob) {
+    }
+
+    void run() override {
+      Templates templates(m_Setup.sCommunity, m_Setup.sSharePath,
+                          m_Setup.sUserDataDir);
+      Parser parser(m_Setup.sSharePath,
+                    QDir(m_Setup.sUserDataDir + "/tmpImages"),
+                    m_Setup.sInyokaUrl, false, &templates,
+                    m_Setup.sCommunity, m_Setup.sPygmentize,
+                    m_Setup.bPreferPygments);
+      // Reference output for checking the block-wise parsing
+      QScopedPointer<Parser> pWholeParser;
+      if (m_Setup.bCompare) {
+        pWholeParser.reset(new Parser(m_Setup.sSharePath,
+                                      QDir(m_Setup.sUserDataDir +
+                                           "/tmpImages"),
+                                      m_Setup.sInyokaUrl, false, &templates,
+                                      m_Setup.sCommunity, m_Setup.sPygmentize,
+                                      m_Setup.bPreferPygments));
+        pWholeParser->setBlockwise(false);
+      }
+      QVector<SyntaxDiagnostic> diagnostics;
+      QObject::connect(&parser, &Parser::hightlightSyntaxError,
+                       [&diagnostics](const QVector<SyntaxDiagnostic> &d) {
+        diagnostics = d;
+      });
+
+      int i;
+      while ((i = m_pNextJob->fetchAndAddOrdered(1)) < m_nJobs) {
+        BatchRenderer::RenderJob &job = m_pJobs[i];
+        QElapsedTimer timer;
+        timer.start();
+
+        QFile inFile(job.sInput);
+        if (!inFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+          job.sFailure = inFile.errorString();
+          continue;
+        }
+        QTextStream in(&inFile);
+        in.setCodec("UTF-8");
+        QString sText(in.readAll());
+        inFile.close();
+
+        diagnostics.clear();
+        const QString sHtml(parser.genOutput(job.sInput, sText, true));
+        job.diagnostics = diagnostics;
+
+        QDir().mkpath(QFileInfo(job.sOutput).absolutePath());
+        QFile outFile(job.sOutput);
+        if (!outFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+          job.sFailure = outFile.errorString();
+          continue;
+        }
+        QTextStream out(&outFile);
+        out.setCodec("UTF-8");
+        out << sHtml;
+        outFile.close();
+        job.bRendered = true;
+        job.nElapsed = timer.elapsed();
+
+        if (!pWholeParser.isNull()) {
+          const QString sWhole(pWholeParser->genOutput(job.sInput, sText));
+          job.bDiffers = removeBlockMarkers(sHtml) !=
+                         removeBlockMarkers(sWhole);
+          if (job.bDiffers) {
+            QFile wholeFile(job.sOutput.left(job.sOutput.lastIndexOf('.')) +
+                            ".whole.html");
+            if (wholeFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+              QTextStream whole(&wholeFile);
+              whole.setCodec("UTF-8");
+              whole << sWhole;
+              wholeFile.close();
+            }
+          }
+        }
+      }
+    }
+
+ private:
+    const WorkerSetup m_Setup;
+    BatchRenderer::RenderJob *m_pJobs;
+    const int m_nJobs;
+    QAtomicInt *m_pNextJob;
+};
+}  // namespace
+
+BatchRenderer::BatchRenderer(const QString &sSharePath,
+                             const QDir &userDataDir)
+  : m_sSharePath(sSharePath),
+    m_UserDataDir(userDataDir),
+    m_bPreferPygments(true) {
+  this->readSettings();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void BatchRenderer::readSettings() {
+  // Same settings as used by the editor, but read only
+#if defined __linux__
+  QSettings settings(QSettings::NativeFormat, QSettings::UserScope,
+                     qApp->applicationName().toLower(),
+                     qApp->applicationName().toLower());
+#else
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     qApp->applicationName().toLower(),
+                     qApp->applicationName().toLower());
+#endif
+
+  m_sPygmentize = settings.value(QStringLiteral("Pygmentize"),
+                                 "/usr/bin/pygmentize").toString();
+  m_bPreferPygments = settings.value(QStringLiteral("PreferPygments"),
+                                     true).toBool();
+
+  settings.beginGroup(QStringLiteral("Inyoka"));
+  m_sCommunity = settings.value(QStringLiteral("Community"),
+                                "ubuntuusers_de").toString();
+  m_sInyokaUrl = settings.value(QStringLiteral("WikiUrl"), "").toString();
+  settings.endGroup();
+
+  if (m_sInyokaUrl.isEmpty()) {
+    QSettings communityConfig(m_sSharePath + "/community/" +
+                              m_sCommunity + "/community.conf",
+                              QSettings::IniFormat);
+    communityConfig.setIniCodec("UTF-8");
+    m_sInyokaUrl = communityConfig.value(
+                     QStringLiteral("WikiUrl"), "").toString();
+    if (m_sInyokaUrl.isEmpty()) {
+      qWarning() << "Inyoka wiki URL not found!";
+    }
+  }
+  if (m_sInyokaUrl.endsWith(QLatin1String("/"))) {
+    m_sInyokaUrl.chop(1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto BatchRenderer::run(const QStringList &sListInputs,
+                        const QString &sOutDir, const int nJobs,
+                        const bool bCompare) -> int {
+  QTextStream err(stderr);
+  const QDir outDir(sOutDir);
+  if (!outDir.exists() && !outDir.mkpath(outDir.absolutePath())) {
+    err << "Could not create output folder: " << sOutDir << "\n";
+    return 1;
+  }
+  if (!this->collectJobs(sListInputs, outDir)) {
+    return 1;
+  }
+  if (m_Jobs.isEmpty()) {
+    err << "No articles found to be rendered.\n";
+    return 1;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  WorkerSetup setup;
+  setup.sSharePath = m_sSharePath;
+  setup.sUserDataDir = m_UserDataDir.absolutePath();
+  setup.sCommunity = m_sCommunity;
+  setup.sInyokaUrl = m_sInyokaUrl;
+  setup.sPygmentize = m_sPygmentize;
+  setup.bPreferPygments = m_bPreferPygments;
+  setup.bCompare = bCompare;
+
+  // No more workers than files; each worker sets up its own parser
+  const int nWorkers = qBound(1, nJobs, m_Jobs.size());
+  QAtomicInt nNextJob(0);
+  QThreadPool pool;
+  pool.setMaxThreadCount(nWorkers);
+  for (int i = 0; i < nWorkers; i++) {
+    pool.start(new RenderWorker(setup, m_Jobs.data(), m_Jobs.size(),
+                                &nNextJob));
+  }
+  pool.waitForDone();
+
+  const qint64 nElapsed = timer.elapsed();
+  const QString sReportFile(outDir.absoluteFilePath(
+                              QStringLiteral("report.json")));
+  bool bFailed = !this->writeReport(sReportFile, nElapsed);
+  bool bSyntaxErrors = false;
+  int nRendered = 0;
+  for (const auto &job : qAsConst(m_Jobs)) {
+    if (!job.bRendered) {
+      bFailed = true;
+      err << "Failed: " << job.sInput << " (" << job.sFailure << ")\n";
+    } else {
+      nRendered++;
+    }
+    if (job.bDiffers) {
+      bFailed = true;
+      err << "Differs from whole article parsing: " << job.sInput << "\n";
+    }
+    for (const auto &diagnostic : job.diagnostics) {
+      bSyntaxErrors = true;
+      err << job.sInput << ":" << diagnostic.nLine << ":"
+          << diagnostic.nColumn << ": " << diagnostic.sCode;
+      if (!diagnostic.sDetail.isEmpty()) {
+        err << " " << diagnostic.sDetail;
+      }
+      err << "\n";
+    }
+  }
+  err << "Rendered " << nRendered << " of " << m_Jobs.size() << " files in "
+      << nElapsed << " ms using " << nWorkers << " worker(s).\n";
+
+  if (bFailed) {
+    return 1;
+  }
+  return bSyntaxErrors ? 2 : 0;
+}
+
+// ----------------------------------------------------------------------------
+
+auto BatchRenderer::collectJobs(const QStringList &sListInputs,
+                                const QDir &outDir) -> bool {
+  const QStringList sListFilter(QStringLiteral("*.iny"));
+  QStringList sListFiles;
+  QStringList sListOutputs;
+
+  for (const auto &sInput : sListInputs) {
+    const QFileInfo fi(sInput);
+    if (fi.isDir()) {
+      // Keep folder structure below the given folder
+      const QDir inDir(fi.absoluteFilePath());
+      QDirIterator it(inDir.absolutePath(), sListFilter, QDir::Files,
+                      QDirIterator::Subdirectories);
+      while (it.hasNext()) {
+        const QString sFile(it.next());
+        const QString sRelative(inDir.relativeFilePath(sFile));
+        sListFiles << sFile;
+        sListOutputs << outDir.absoluteFilePath(
+                          sRelative.left(sRelative.lastIndexOf('.')) +
+                          ".html");
+      }
+    } else if (fi.isFile()) {
+      sListFiles << fi.absoluteFilePath();
+      sListOutputs << outDir.absoluteFilePath(fi.completeBaseName() +
+                                              ".html");
+    } else {
+      QTextStream(stderr) << "File or folder not found: " << sInput << "\n";
+      return false;
+    }
+  }
+
+  m_Jobs.clear();
+  m_Jobs.reserve(sListFiles.size());
+  QSet<QString> setOutputs;
+  for (int i = 0; i < sListFiles.size(); i++) {
+    RenderJob job;
+    job.sInput = sListFiles[i];
+    // Same names from different folders get a number appended
+    job.sOutput = sListOutputs[i];
+    const QString sBase(job.sOutput.left(job.sOutput.lastIndexOf('.')));
+    for (int n = 2; setOutputs.contains(job.sOutput); n++) {
+      job.sOutput = sBase + "-" + QString::number(n) + ".html";
+    }
+    setOutputs << job.sOutput;
+    job.bRendered = false;
+    job.bDiffers = false;
+    job.nElapsed = 0;
+    m_Jobs << job;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+auto BatchRenderer::writeReport(const QString &sReportFile,
+                                const qint64 nElapsed) const -> bool {
+  QJsonArray files;
+  for (const auto &job : m_Jobs) {
+    QJsonObject file;
+    file.insert(QStringLiteral("input"), job.sInput);
+    file.insert(QStringLiteral("output"), job.sOutput);
+    file.insert(QStringLiteral("rendered"), job.bRendered);
+    if (job.bDiffers) {
+      file.insert(QStringLiteral("differs"), true);
+    }
+    if (!job.sFailure.isEmpty()) {
+      file.insert(QStringLiteral("failure"), job.sFailure);
+    }
+    file.insert(QStringLiteral("elapsed_ms"), job.nElapsed);
+
+    QJsonArray errors;
+    for (const auto &diagnostic : job.diagnostics) {
+      QJsonObject error;
+      error.insert(QStringLiteral("code"), diagnostic.sCode);
+      if (!diagnostic.sDetail.isEmpty()) {
+        error.insert(QStringLiteral("detail"), diagnostic.sDetail);
+      }
+      error.insert(QStringLiteral("line"), diagnostic.nLine);
+      error.insert(QStringLiteral("column"), diagnostic.nColumn);
+      error.insert(QStringLiteral("end_line"), diagnostic.nEndLine);
+      error.insert(QStringLiteral("end_column"), diagnostic.nEndColumn);
+      errors << error;
+    }
+    file.insert(QStringLiteral("errors"), errors);
+    files << file;
+  }
+
+  QJsonObject report;
+  report.insert(QStringLiteral("version"),
+                QCoreApplication::applicationVersion());
+  report.insert(QStringLiteral("community"), m_sCommunity);
+  report.insert(QStringLiteral("elapsed_ms"), nElapsed);
+  report.insert(QStringLiteral("files"), files);
+
+  QFile reportFile(sReportFile);
+  if (!reportFile.open(QIODevice::WriteOnly)) {
+    QTextStream(stderr) << "Could not write report: " << sReportFile << "\n";
+    return false;
+  }
+  reportFile.write(QJsonDocument(report).toJson());
+  reportFile.close();
+  return true;
+}
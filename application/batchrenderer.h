@@ -0,0 +1,80 @@
+/**
+ * \file batchrenderer.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for headless batch rendering.
+ */
+
+#ifndef APPLICATION_BATCHRENDERER_H_
+#define APPLICATION_BATCHRENDERER_H_
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "./syntaxcheck.h"
+
+/**
+ * \class BatchRenderer
+ * \brief Render articles to HTML without any GUI.
+ *
+ * Every worker thread builds its own templates and parser once and
+ * processes files from a shared queue until all files are rendered.
+ */
+class BatchRenderer {
+ public:
+    BatchRenderer(const QString &sSharePath, const QDir &userDataDir);
+
+    // Returns 0 on success, 1 on failed files, 2 on syntax errors only.
+    // bCompare additionally parses each article as a whole; differing
+    // output is saved as *.whole.html and counted as failure.
+    auto run(const QStringList &sListInputs, const QString &sOutDir,
+             const int nJobs, const bool bCompare = false) -> int;
+
+    struct RenderJob {
+      QString sInput;
+      QString sOutput;
+      bool bRendered;
+      bool bDiffers;  // From parsing the whole article at once
+      QString sFailure;
+      QVector<SyntaxDiagnostic> diagnostics;
+      qint64 nElapsed;  // Milliseconds
+    };
+
+ private:
+    void readSettings();
+    auto collectJobs(const QStringList &sListInputs,
+                     const QDir &outDir) -> bool;
+    auto writeReport(const QString &sReportFile,
+                     const qint64 nElapsed) const -> bool;
+
+    const QString m_sSharePath;
+    const QDir m_UserDataDir;
+    QString m_sCommunity;
+    QString m_sInyokaUrl;
+    QString m_sPygmentize;
+    bool m_bPreferPygments;
+    QVector<RenderJob> m_Jobs;
+};
+
+#endif  // APPLICATION_BATCHRENDERER_H_
@@ -0,0 +1,145 @@
+/**
+ * \file connectivitymonitor.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Non-blocking detection of the internet connection state.
+ */
+
+#include "./connectivitymonitor.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+
+namespace {
+const qint64 ONLINE_TTL = 5 * 60 * 1000;  // Milliseconds
+const qint64 OFFLINE_TTL = 30 * 1000;
+const int PROBE_TIMEOUT = 10000;
+const char PROBE_URL[] = "https://github.com/inyokaproject/inyokaedit";
+}  // namespace
+
+auto ConnectivityMonitor::instance() -> ConnectivityMonitor * {
+  static auto *pInstance = new ConnectivityMonitor();
+  return pInstance;
+}
+
+// ----------------------------------------------------------------------------
+
+ConnectivityMonitor::ConnectivityMonitor()
+  : m_nState(Unknown),
+    m_nUpdatedAt(0),
+    m_bProbing(1),
+    m_pProbeReply(nullptr) {
+  m_pNwManager = new QNetworkAccessManager(this);
+  m_pProbeTimeout = new QTimer(this);
+  m_pProbeTimeout->setSingleShot(true);
+  m_pProbeTimeout->setInterval(PROBE_TIMEOUT);
+  connect(m_pProbeTimeout, &QTimer::timeout, this, [this]() {
+    if (nullptr != m_pProbeReply) {
+      m_pProbeReply->abort();
+    }
+  });
+
+  // Network requests and timers are handled by the main event loop,
+  // independent of the thread which asked first
+  if (nullptr != QCoreApplication::instance()) {
+    this->moveToThread(QCoreApplication::instance()->thread());
+  }
+  QMetaObject::invokeMethod(this, "probe", Qt::QueuedConnection);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto ConnectivityMonitor::isOnline() -> bool {
+  const int nState = m_nState.loadAcquire();
+  const qint64 nAge = QDateTime::currentMSecsSinceEpoch() -
+                      m_nUpdatedAt.loadAcquire();
+  const qint64 nTtl = (Offline == nState) ? OFFLINE_TTL : ONLINE_TTL;
+
+  if ((Unknown == nState || nAge > nTtl) &&
+      m_bProbing.testAndSetOrdered(0, 1)) {
+    QMetaObject::invokeMethod(this, "probe", Qt::QueuedConnection);
+  }
+  return Offline != nState;
+}
+
+// ----------------------------------------------------------------------------
+
+void ConnectivityMonitor::reportReply(const QNetworkReply *pReply) {
+  if (nullptr == pReply) {
+    return;
+  }
+
+  // Any HTTP answer (even an error page) means the server was reached
+  if (pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid()) {
+    this->setOnline(true);
+  } else if (QNetworkReply::NoError != pReply->error() &&
+             QNetworkReply::OperationCanceledError != pReply->error()) {
+    this->setOnline(false);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void ConnectivityMonitor::probe() {
+  if (nullptr != m_pProbeReply) {
+    return;
+  }
+  m_pProbeReply = m_pNwManager->head(QNetworkRequest(QUrl(PROBE_URL)));
+  connect(m_pProbeReply, &QNetworkReply::finished,
+          this, &ConnectivityMonitor::probeFinished);
+  m_pProbeTimeout->start();
+}
+
+// ----------------------------------------------------------------------------
+
+void ConnectivityMonitor::probeFinished() {
+  m_pProbeTimeout->stop();
+  const bool bOnline = m_pProbeReply->attribute(
+                         QNetworkRequest::HttpStatusCodeAttribute).isValid();
+  m_pProbeReply->deleteLater();
+  m_pProbeReply = nullptr;
+  m_bProbing.storeRelease(0);
+  this->setOnline(bOnline);
+}
+
+// ----------------------------------------------------------------------------
+
+void ConnectivityMonitor::setOnline(const bool bOnline) {
+  const int nState = bOnline ? Online : Offline;
+  const int nOldState = m_nState.fetchAndStoreOrdered(nState);
+  m_nUpdatedAt.storeRelease(QDateTime::currentMSecsSinceEpoch());
+
+  if (nOldState != nState) {
+    if (!bOnline) {
+      qDebug() << "NO internet connection available!";
+    }
+    emit this->onlineStateChanged(bOnline);
+  }
+}
@@ -0,0 +1,81 @@
+/**
+ * \file connectivitymonitor.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for connectivity monitor.
+ */
+
+#ifndef APPLICATION_CONNECTIVITYMONITOR_H_
+#define APPLICATION_CONNECTIVITYMONITOR_H_
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QObject>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+/**
+ * \class ConnectivityMonitor
+ * \brief Cached online state, probed in background.
+ *
+ * Reading the state never blocks. Expired states are refreshed in the
+ * background; replies of real requests update the state as well.
+ */
+class ConnectivityMonitor : public QObject {
+  Q_OBJECT
+
+ public:
+    static auto instance() -> ConnectivityMonitor *;
+
+    // Thread-safe; optimistic as long as nothing is known yet
+    auto isOnline() -> bool;
+    // Thread-safe; learn from any finished network reply
+    void reportReply(const QNetworkReply *pReply);
+
+ signals:
+    void onlineStateChanged(const bool bOnline);
+
+ private slots:
+    void probe();
+    void probeFinished();
+
+ private:
+    ConnectivityMonitor();
+    void setOnline(const bool bOnline);
+
+    enum OnlineState {
+      Unknown,
+      Online,
+      Offline
+    };
+
+    QAtomicInt m_nState;
+    QAtomicInteger<qint64> m_nUpdatedAt;
+    QAtomicInt m_bProbing;
+    QNetworkAccessManager *m_pNwManager;
+    QNetworkReply *m_pProbeReply;
+    QTimer *m_pProbeTimeout;
+};
+
+#endif  // APPLICATION_CONNECTIVITYMONITOR_H_
@@ -33,6 +33,7 @@
 #include <QNetworkReply>
 #include <QTimer>
 
+#include "./connectivitymonitor.h"
 #include "./downloadimg.h"
 #include "./session.h"
 #include "./utils.h"
@@ -160,6 +161,7 @@ void Download::replyFinished(QNetworkReply *pReply) {
     // Handle only requests from Download class
     return;
   }
+  ConnectivityMonitor::instance()->reportReply(pReply);
 
 #ifndef QT_NO_CURSOR
   QApplication::restoreOverrideCursor();
@@ -34,6 +34,8 @@
 #include <QNetworkReply>
 #include <QProgressDialog>
 
+#include "./connectivitymonitor.h"
+
 DownloadImg::DownloadImg(QNetworkAccessManager* pNwManager, QObject *pObj)
   : m_pNwManager(pNwManager),
     m_pProgessDialog(nullptr),
@@ -118,6 +120,7 @@ void DownloadImg::downloadFinished(QNetworkReply *pReply) {
                                    QNetworkRequest::RedirectionTargetAttribute);
   m_urlRedirectedTo = DownloadImg::redirectUrl(possibleRedirectUrl.toUrl(),
                                                m_urlRedirectedTo);
+  ConnectivityMonitor::instance()->reportReply(pReply);
 
   // Error
   if (QNetworkReply::NoError != pReply->error()) {
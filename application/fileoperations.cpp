@@ -47,6 +47,7 @@
 #endif
 
 #include "./findreplace.h"
+#include "./previewcontent.h"
 #include "./settings.h"
 #include "./texteditor.h"
 
@@ -57,14 +58,14 @@
 #include "./3rdparty/miniz/miniz.c"
 
 FileOperations::FileOperations(QWidget *pParent, QTabWidget *pTabWidget,
-                               Settings *pSettings, const QString &sPreviewFile,
+                               Settings *pSettings, PreviewContent *pPreview,
                                const QString &sUserDataDir,
                                const QStringList &sListTplMacros, QObject *pObj)
   : m_pParent(pParent),
     m_pDocumentTabs(pTabWidget),
     m_pCurrentEditor(nullptr),
     m_pSettings(pSettings),
-    m_sPreviewFile(sPreviewFile),
+    m_pPreview(pPreview),
     m_sFileFilter(tr("Inyoka article") + " (*.iny *.inyoka);;" +
                   tr("Inyoka article + images") + " (*.inyzip);;" +
                   tr("All files") + " (*)"),
@@ -486,20 +487,7 @@ auto FileOperations::saveInyArchive(const QString &sArchive) -> bool {
   }
 
   // Grab images from html preview
-  QFile html(m_sPreviewFile);
-  // No permission to read
-  if (!html.open(QFile::ReadOnly | QFile::Text)) {
-    QMessageBox::warning(m_pParent, qApp->applicationName(),
-                         tr("Error while packing image files:\n%1.")
-                         .arg(html.errorString()));
-    qWarning() << "Error while packing image files:" << html.errorString();
-    return false;
-  }
-
-  QTextStream in(&html);
-  in.setCodec("UTF-8");
-  in.setAutoDetectUnicode(true);
-  QString sHtml(in.readAll());
+  QString sHtml(m_pPreview->getHtml());
 
   QRegularExpression imgTagRegex(
         QStringLiteral("\\<img[^\\>]*src\\s*=\\s*\"([^\"]*)\"[^\\>]*\\>"),
@@ -626,7 +614,6 @@ void FileOperations::printPreview() {
   QWebEngineView previewWebView;
 #endif
   QPrinter printer;
-  QFile previewFile(m_sPreviewFile);
   QString sHtml(QLatin1String(""));
 
   const QList <QPrinterInfo> listPrinters = QPrinterInfo::availablePrinters();
@@ -653,20 +640,12 @@ void FileOperations::printPreview() {
   printer.setOutputFormat(QPrinter::NativeFormat);
 #endif
 
-  if (!previewFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(nullptr, tr("Warning"),
-                         tr("Could not open preview file for printing!"));
-    qWarning() << "Could not open text html preview file for printing:"
-               << m_sPreviewFile;
-    return;
-  }
-
-  QTextStream in(&previewFile);
+  const QStringList sListLines(m_pPreview->getHtml().split('\n'));
   QString sTmpLine1;
   QString sTmpLine2;
-  while (!in.atEnd()) {
-    sTmpLine1 = in.readLine() + "\n";
-    sTmpLine2 = in.readLine() + "\n";
+  for (int i = 0; i < sListLines.size(); i += 2) {
+    sTmpLine1 = sListLines.at(i) + "\n";
+    sTmpLine2 = sListLines.value(i + 1) + "\n";
     // If line == </body> skip previous line
     // See below: <div class=\"wrap\">...</div>\n</body>)
     if ("</body>" == sTmpLine2.trimmed()) {
@@ -676,12 +655,6 @@ void FileOperations::printPreview() {
       sHtml += sTmpLine2;
     }
   }
-  previewFile.close();
-
-  /*
-  // Load preview from url
-  previewWebView.load(QUrl::fromLocalFile(m_sPreviewFile));
-  */
 
   // Add style format; remove unwanted div for printing
   sHtml.replace(QLatin1String("</style>"),
@@ -690,16 +663,7 @@ void FileOperations::printPreview() {
                   "body{background-color:#ffffff;\n</style>"));
   sHtml.remove(QStringLiteral("<div class=\"wrap\">"));
 
-  previewWebView.setHtml(sHtml, QUrl::fromLocalFile(
-                           QFileInfo(m_sPreviewFile)
-                           .absoluteDir().absolutePath() + "/"));
-
-  /*
-  previewWebView.setContent(sHtml.toLocal8Bit(), "application/xhtml+xml",
-                            QUrl::fromLocalFile(QFileInfo(m_sPreviewFile)
-                                                .absoluteDir()
-                                                .absolutePath() + "/"));
-  */
+  previewWebView.setHtml(sHtml, QUrl::fromLocalFile(m_sUserDataDir + "/"));
 
   QPrintDialog printDialog(&printer);
   if (QDialog::Accepted == printDialog.exec()) {
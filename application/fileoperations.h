@@ -34,6 +34,7 @@ class QTabWidget;
 class QTimer;
 
 class FindReplace;
+class PreviewContent;
 class Settings;
 class TextEditor;
 
@@ -46,7 +47,7 @@ class FileOperations : public QObject {
 
  public:
     FileOperations(QWidget *pParent, QTabWidget *pTabWidget,
-                   Settings *pSettings, const QString &sPreviewFile,
+                   Settings *pSettings, PreviewContent *pPreview,
                    const QString &sUserDataDir,
                    const QStringList &sListTplMacros,
                    QObject *pObj = nullptr);
@@ -119,7 +120,7 @@ class FileOperations : public QObject {
 
     QList<QAction *> m_LastOpenedFilesAct;
 
-    QString m_sPreviewFile;
+    PreviewContent *m_pPreview;
     const QString m_sFileFilter;
 
     bool m_bLoadPreview;
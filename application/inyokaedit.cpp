@@ -26,6 +26,7 @@
 
 #include "./inyokaedit.h"
 
+#include <QAbstractTextDocumentLayout>
 #include <QComboBox>
 #include <QDesktopServices>
 #include <QGridLayout>
@@ -36,6 +37,8 @@
 #include <QSettings>
 #include <QSplitter>
 #include <QTextBlock>
+#include <QTextDocument>
+#include <QThread>
 #include <QTimer>
 #include <QToolButton>
 #include <QToolTip>
@@ -44,17 +47,21 @@
 #include <QtWebKitWidgets/QWebView>
 #include <QWebFrame>
 #include <QWebHistory>
+#include <QWebSecurityOrigin>
 #endif
 #ifdef USEQTWEBENGINE
 #include <QWebEngineView>
 #include <QWebEngineHistory>
+#include <QWebEngineProfile>
 #endif
 
 #include "./download.h"
 #include "./fileoperations.h"
 #include "./ieditorplugin.h"
+#include "./livesyntaxcheck.h"
 #include "./parser/parser.h"
 #include "./plugins.h"
+#include "./previewcontent.h"
 #include "./settings.h"
 #include "./session.h"
 #include "./templates/templates.h"
@@ -64,6 +71,14 @@
 #include "./xmlparser.h"
 #include "ui_inyokaedit.h"
 
+namespace {
+const int SCROLL_SYNC_INTERVAL = 16;  // Milliseconds, about one frame
+const int SOURCE_MAP_DELAY = 100;  // Milliseconds after last resize
+const int PREVIEW_CACHE_BYTES = 32 * 1024 * 1024;  // Of all open documents
+// Marks own extra selections, others (e.g. of plugins) are kept
+const int SYNTAX_ERROR_PROPERTY = QTextFormat::UserProperty + 1;
+}  // namespace
+
 InyokaEdit::InyokaEdit(const QDir &userDataDir, const QDir &sharePath,
                        const QString &sArg, QWidget *parent)
   : QMainWindow(parent),
@@ -74,10 +89,20 @@ InyokaEdit::InyokaEdit(const QDir &userDataDir, const QDir &sharePath,
     m_sPreviewFile(m_UserDataDir.absolutePath() + "/tmpinyoka.html"),
     m_tmpPreviewImgDir(m_UserDataDir.absolutePath() + "/tmpImages"),
     m_pPreviewTimer(new QTimer(this)),
+    m_pScrollSyncTimer(new QTimer(this)),
+    m_pSourceMapTimer(new QTimer(this)),
+    m_nPreviewGeneration(0),
+    m_nPreviewedRevision(-1),
+    m_nPreviewedHash(0),
+    m_nPreviewedSettings(-1),
+    m_nSettingsGeneration(0),
+    m_PreviewCache(PREVIEW_CACHE_BYTES),
     m_bOpenFileAfterStart(false),
-    m_bEditorScrolling(false),
+    m_nSyncedWebviewPos(-1),
+    m_bSyncFromEditor(true),
     m_bWebviewScrolling(false),
-    m_bReloadPreviewBlocked(false) {
+    m_bReloadPreviewBlocked(false),
+    m_bLoadingPreview(false) {
   m_pUi->setupUi(this);
 
   if (!sharePath.exists()) {
@@ -127,6 +152,11 @@ InyokaEdit::InyokaEdit(const QDir &userDataDir, const QDir &sharePath,
 }
 
 InyokaEdit::~InyokaEdit() {
+  // Abort running parsing and stop parser thread (deletes parser)
+  m_pParser->cancelOutdatedParsing(++m_nPreviewGeneration);
+  m_pParserThread->quit();
+  m_pParserThread->wait();
+
   delete m_pUi;
   m_pUi = nullptr;
 }
@@ -158,6 +188,10 @@ void InyokaEdit::createObjects() {
   // Has to be created before parser
   m_pTemplates = new Templates(m_pSettings->getInyokaCommunity(),
                                m_sSharePath, m_UserDataDir.absolutePath());
+  const QStringList sListWarnings(m_pTemplates->getWarnings());
+  for (const auto &sWarning : sListWarnings) {
+    QMessageBox::warning(nullptr, QStringLiteral("Warning"), sWarning);
+  }
 
   m_pSession = new Session(this, m_pSettings->getInyokaHash());
 
@@ -174,9 +208,36 @@ void InyokaEdit::createObjects() {
                          m_pSettings->getCheckLinks(),
                          m_pTemplates,
                          m_pSettings->getInyokaCommunity(),
-                         m_pSettings->getPygmentize());
-  connect(m_pParser, &Parser::hightlightSyntaxError,
-          this, &InyokaEdit::highlightSyntaxError);
+                         m_pSettings->getPygmentize(),
+                         m_pSettings->getPreferPygments());
+
+  // Syntax is checked while typing instead of while parsing
+  m_pLiveSyntaxCheck = new LiveSyntaxCheck(
+                         SyntaxCheck::prepareRules(
+                           m_pTemplates->getListTplNamesINY(),
+                           m_pTemplates->getListSmilies(),
+                           m_pParser->getTplTranslations()), this);
+  connect(m_pLiveSyntaxCheck, &LiveSyntaxCheck::diagnosticsChanged,
+          this, &InyokaEdit::markSyntaxErrors);
+
+  // Parsing is done in a separate thread, only the result is handled here
+  m_pParserThread = new QThread(this);
+  m_pParser->moveToThread(m_pParserThread);
+  connect(m_pParserThread, &QThread::finished,
+          m_pParser, &QObject::deleteLater);
+  connect(this, &InyokaEdit::parsePreview,
+          m_pParser, &Parser::parseRequested);
+  connect(m_pParser, &Parser::parsingFinished,
+          this, &InyokaEdit::showPreview);
+  connect(m_pParser, &Parser::linkStateChanged,
+          this, &InyokaEdit::updateLinkState);
+#ifndef NOPREVIEW
+  connect(this, &InyokaEdit::parseSyntaxOverview,
+          m_pParser, &Parser::parseSyntaxOverview);
+  connect(m_pParser, &Parser::syntaxOverviewFinished,
+          this, &InyokaEdit::showSyntaxOverviewPage);
+#endif
+  m_pParserThread->start();
 
   m_pDocumentTabs = new QTabWidget;
   m_pDocumentTabs->setTabPosition(QTabWidget::North);
@@ -185,14 +246,15 @@ void InyokaEdit::createObjects() {
   // Attention: Currently tab order is fixed (same as m_pListEditors)
   m_pDocumentTabs->setMovable(false);
 
+  m_pPreviewContent = new PreviewContent(m_sPreviewFile, this);
   m_pFileOperations = new FileOperations(this, m_pDocumentTabs, m_pSettings,
-                                         m_sPreviewFile,
+                                         m_pPreviewContent,
                                          m_UserDataDir.absolutePath(),
                                          m_pTemplates->getListTplMacrosALL());
   m_pCurrentEditor = m_pFileOperations->getCurrentEditor();
 
   connect(m_pFileOperations, &FileOperations::callPreview,
-          this, &InyokaEdit::previewInyokaPage);
+          this, &InyokaEdit::previewCurrentDocument);
   connect(m_pFileOperations, &FileOperations::modifiedDoc,
           this, &InyokaEdit::setWindowModified);
   connect(m_pFileOperations, &FileOperations::changedCurrentEditor,
@@ -218,6 +280,11 @@ void InyokaEdit::createObjects() {
           this, &InyokaEdit::syncScrollbarsEditor);
 
   m_pWebview->settings()->setDefaultTextEncoding(QStringLiteral("utf-8"));
+  // Preview is served from memory
+  QWebSecurityOrigin::addLocalScheme(
+        QString::fromLatin1(PreviewContent::SCHEME));
+  m_pWebview->page()->setNetworkAccessManager(
+        new PreviewNetworkAccessManager(m_pPreviewContent, m_pWebview));
 #endif
 #ifdef USEQTWEBENGINE
   m_pWebview = new QWebEngineView(this);
@@ -228,6 +295,10 @@ void InyokaEdit::createObjects() {
           this, &InyokaEdit::syncScrollbarsWebview);
   connect(m_pFileOperations, &FileOperations::movedEditorScrollbar,
           this, &InyokaEdit::syncScrollbarsEditor);
+  // Preview is served from memory
+  m_pWebview->page()->profile()->installUrlSchemeHandler(
+        PreviewContent::SCHEME,
+        new PreviewSchemeHandler(m_pPreviewContent, m_pWebview));
 #endif
 #ifndef NOPREVIEW
   m_pWebview->installEventFilter(this);
@@ -244,6 +315,16 @@ void InyokaEdit::setCurrentEditor() {
   m_pCurrentEditor = m_pFileOperations->getCurrentEditor();
   m_pPlugins->setCurrentEditor(m_pCurrentEditor);
   m_pUploadModule->setEditor(m_pCurrentEditor, m_pCurrentEditor->getFileName());
+  m_pLiveSyntaxCheck->setDocument(m_pSettings->getSyntaxCheck()
+                                  ? m_pCurrentEditor->document() : nullptr);
+  // Only edits of the current document restart the timed preview, thus
+  // background and closed documents are disconnected
+  disconnect(m_EditedDocConnection);
+  m_EditedDocConnection = connect(m_pCurrentEditor->document(),
+                                  &QTextDocument::contentsChanged,
+                                  this, &InyokaEdit::editedDocument);
+  connect(m_pCurrentEditor->document(), &QTextDocument::destroyed,
+          this, &InyokaEdit::removeCachedPreview, Qt::UniqueConnection);
 }
 
 // ----------------------------------------------------------------------------
@@ -253,8 +334,23 @@ void InyokaEdit::setupEditor() {
   qDebug() << "Calling" << Q_FUNC_INFO;
 
   // Timed preview
+  m_pPreviewTimer->setSingleShot(true);
   connect(m_pPreviewTimer, &QTimer::timeout,
-          this, &InyokaEdit::previewInyokaPage);
+          this, &InyokaEdit::previewChangedDocument);
+
+  // Scrollbar synchronization, at most once per frame
+  m_pScrollSyncTimer->setSingleShot(true);
+  m_pScrollSyncTimer->setInterval(SCROLL_SYNC_INTERVAL);
+  connect(m_pScrollSyncTimer, &QTimer::timeout,
+          this, &InyokaEdit::syncScrollPosition);
+
+#ifndef NOPREVIEW
+  // Block positions are read once resizing has finished
+  m_pSourceMapTimer->setSingleShot(true);
+  m_pSourceMapTimer->setInterval(SOURCE_MAP_DELAY);
+  connect(m_pSourceMapTimer, &QTimer::timeout,
+          this, &InyokaEdit::updateSourceMap);
+#endif
 
 #ifdef USEQTWEBKIT
   connect(m_pWebview, &QWebView::loadFinished,
@@ -794,36 +890,194 @@ void InyokaEdit::openFile() {
 
 // Call parser
 void InyokaEdit::previewInyokaPage() {
+  const QString sRawDoc(m_pCurrentEditor->toPlainText());
+  m_pPreviewTimer->stop();  // Pending timed preview is included
+  m_pPreviewedDoc = m_pCurrentEditor->document();
+  m_nPreviewedRevision = m_pPreviewedDoc->revision();
+  m_nPreviewedHash = qHash(sRawDoc);
+  m_sPreviewedFile = m_pFileOperations->getCurrentFile();
+  m_nPreviewedSettings = m_nSettingsGeneration;
+
+  // A new request supersedes all running / queued ones
+  m_nPreviewGeneration++;
+  m_pParser->cancelOutdatedParsing(m_nPreviewGeneration);
+  emit parsePreview(m_nPreviewGeneration, m_sPreviewedFile, sRawDoc, false);
+
+  if (m_pSettings->getSyntaxCheck()) {
+    this->highlightSyntaxError(m_pLiveSyntaxCheck->getDiagnostics());
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Switching tabs shows the last rendered preview, if it is up to date
+void InyokaEdit::previewCurrentDocument() {
+  const QTextDocument *pDoc = m_pCurrentEditor->document();
+  const CachedPreview *pCached = m_PreviewCache.object(pDoc);
+  // Hash in addition, since revisions may start again when a file is
+  // loaded into the same document
+  if (nullptr == pCached || pCached->nRevision != pDoc->revision() ||
+      pCached->nSettings != m_nSettingsGeneration ||
+      pCached->sFile != m_pFileOperations->getCurrentFile() ||
+      pCached->nHash != qHash(m_pCurrentEditor->toPlainText())) {
+    this->previewInyokaPage();
+    return;
+  }
+
+  m_pPreviewTimer->stop();
+  m_pPreviewedDoc = m_pCurrentEditor->document();
+  m_nPreviewedRevision = pCached->nRevision;
+  m_nPreviewedHash = pCached->nHash;
+  m_sPreviewedFile = pCached->sFile;
+  m_nPreviewedSettings = pCached->nSettings;
+  const QHash<QString, bool> linkStates(pCached->linkStates);
+
+  // Results of running requests are not needed anymore
+  m_nPreviewGeneration++;
+  m_pParser->cancelOutdatedParsing(m_nPreviewGeneration);
+  this->displayPreview(pCached->sHtml);
+
+  m_LinkStates = linkStates;
+  QHashIterator<QString, bool> it(m_LinkStates);
+  while (it.hasNext()) {
+    it.next();
+    this->patchLinkState(it.key(), it.value());
+  }
+
+  if (m_pSettings->getSyntaxCheck()) {
+    this->highlightSyntaxError(m_pLiveSyntaxCheck->getDiagnostics());
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::removeCachedPreview(QObject *pDoc) {
+  // Object is destroyed already, only the address is used
+  m_PreviewCache.remove(static_cast<QTextDocument *>(pDoc));
+}
+
+// ----------------------------------------------------------------------------
+
+// Timed preview; unlike explicit requests (e.g. F5, which also picks up new
+// images) nothing is parsed if the input did not change
+void InyokaEdit::previewChangedDocument() {
+  const QTextDocument *pDoc = m_pCurrentEditor->document();
+  if (pDoc == m_pPreviewedDoc &&
+      m_nPreviewedSettings == m_nSettingsGeneration &&
+      m_sPreviewedFile == m_pFileOperations->getCurrentFile()) {
+    if (pDoc->revision() == m_nPreviewedRevision) {
+      return;
+    }
+    // E.g. text typed and removed again
+    if (qHash(m_pCurrentEditor->toPlainText()) == m_nPreviewedHash) {
+      m_nPreviewedRevision = pDoc->revision();
+      return;
+    }
+  }
+  this->previewInyokaPage();
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::editedDocument() {
+  // Restarted with every edit
+  if (0 != m_pSettings->getTimedPreview()) {
+    m_pPreviewTimer->start();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::showPreview(const int nGeneration, const QString &sHtml) {
+  // Drop results of outdated requests
+  if (nGeneration != m_nPreviewGeneration) {
+    return;
+  }
+
+  // Input of the latest request belongs to this result
+  if (!m_pPreviewedDoc.isNull()) {
+    auto *pCached = new CachedPreview;
+    pCached->nRevision = m_nPreviewedRevision;
+    pCached->nHash = m_nPreviewedHash;
+    pCached->sFile = m_sPreviewedFile;
+    pCached->nSettings = m_nPreviewedSettings;
+    pCached->sHtml = sHtml;
+    // Cache takes ownership; deleted at once if larger than the budget
+    m_PreviewCache.insert(m_pPreviewedDoc.data(), pCached,
+                          sHtml.size() * static_cast<int>(sizeof(QChar)));
+  }
+
+  this->displayPreview(sHtml);
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::displayPreview(const QString &sHtml) {
 #ifndef NOPREVIEW
+  // If the preview is shown already, only changed blocks are replaced;
+  // scroll position, images and layout are kept
+  QString sPatch;
+  const bool bPatch = !m_bLoadingPreview &&
+                      m_pPreviewContent->isPreviewUrl(m_pWebview->url()) &&
+                      m_pPreviewContent->createPatch(sHtml, sPatch);
   m_pWebview->history()->clear();  // Clear history (clicked links)
 #endif
+  m_LinkStates.clear();  // Already included in new preview
 
-  QString sRetHTML(QLatin1String(""));
-  sRetHTML = m_pParser->genOutput(m_pFileOperations->getCurrentFile(),
-                                  m_pCurrentEditor->document(),
-                                  m_pSettings->getSyntaxCheck());
-
-  // File for temporary html output
-  QFile tmphtmlfile(m_sPreviewFile);
-
-  // No write permission
-  if (!tmphtmlfile.open(QFile::WriteOnly | QFile::Text)) {
+  // Kept in memory; written to a file only for the external browser
+  if (!m_pPreviewContent->setHtml(sHtml)) {
     QMessageBox::warning(this, qApp->applicationName(),
                          tr("Could not create temporary HTML file!"));
-    qWarning() << "Could not create temporary HTML file:"
-               << m_sPreviewFile;
     return;
   }
 
-  // Stream for output in file
-  QTextStream tmpoutputstream(&tmphtmlfile);
-  tmpoutputstream.setCodec("UTF-8");
-  tmpoutputstream.setAutoDetectUnicode(true);
+#ifdef NOPREVIEW
+  static bool bOpenedBrowser = false;
+  if (!bOpenedBrowser) {
+    QDesktopServices::openUrl(m_pPreviewContent->getUrl());
+    bOpenedBrowser = true;
+  }
+#else
+  if (bPatch) {
+    this->patchPreview(sPatch);
+  } else {
+    this->reloadPreview();
+  }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+#ifndef NOPREVIEW
+void InyokaEdit::patchPreview(const QString &sScript) {
+  m_bReloadPreviewBlocked = false;
+  if (sScript.isEmpty()) {
+    return;
+  }
+
+  // Script fails if the page has been modified otherwise
+#ifdef USEQTWEBKIT
+  if (m_pWebview->page()->mainFrame()->evaluateJavaScript(sScript).toBool()) {
+    this->updateSourceMap();
+  } else {
+    this->reloadPreview();
+  }
+#endif
+#ifdef USEQTWEBENGINE
+  m_pWebview->page()->runJavaScript(sScript, [this](const QVariant &result) {
+    if (result.toBool()) {
+      this->updateSourceMap();
+    } else {
+      this->reloadPreview();
+    }
+  });
+#endif
+}
 
-  // Write HTML code into output file
-  tmpoutputstream << sRetHTML;
-  tmphtmlfile.close();
+// ----------------------------------------------------------------------------
 
+void InyokaEdit::reloadPreview() {
   // Store scroll position
 #ifdef USEQTWEBKIT
   m_WebviewScrollPosition = m_pWebview->page()->mainFrame()->scrollPosition();
@@ -831,69 +1085,164 @@ void InyokaEdit::previewInyokaPage() {
 #ifdef USEQTWEBENGINE
   m_WebviewScrollPosition = m_pWebview->page()->scrollPosition().toPoint();
 #endif
+  m_bLoadingPreview = true;
+  m_pWebview->load(m_pPreviewContent->getUrl());
+}
 
-#ifdef NOPREVIEW
-  static bool bOpenedBrowser = false;
-  if (!bOpenedBrowser) {
-    QDesktopServices::openUrl(
-          QUrl::fromLocalFile(
-            QFileInfo(tmphtmlfile).absoluteFilePath()));
-    bOpenedBrowser = true;
+// ----------------------------------------------------------------------------
+
+// Positions of the blocks change with every render and resize
+void InyokaEdit::updateSourceMap() {
+  if (!m_pPreviewContent->isPreviewUrl(m_pWebview->url())) {
+    m_pPreviewContent->setSourceMap(QVariant());
+    return;
   }
-#else
-  m_pWebview->load(
-        QUrl::fromLocalFile(
-          QFileInfo(tmphtmlfile).absoluteFilePath()));
+  if (m_bLoadingPreview) {
+    return;  // Updated as soon as loading has finished
+  }
+
+  const QString sScript(m_pPreviewContent->getSourceMapScript());
+#ifdef USEQTWEBKIT
+  m_pPreviewContent->setSourceMap(
+        m_pWebview->page()->mainFrame()->evaluateJavaScript(sScript));
+#endif
+#ifdef USEQTWEBENGINE
+  m_pWebview->page()->runJavaScript(sScript, [this](const QVariant &result) {
+    m_pPreviewContent->setSourceMap(result);
+  });
 #endif
 }
+#endif
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void InyokaEdit::highlightSyntaxError(const QPair<int, QString> &error) {
-  QList<QTextEdit::ExtraSelection> extras;
-  QTextEdit::ExtraSelection selection;
+// Link check results arrive after the preview has been rendered
+void InyokaEdit::updateLinkState(const QString &sPageUrl,
+                                 const bool bMissing) {
+  m_LinkStates.insert(sPageUrl, bMissing);
+  this->patchLinkState(sPageUrl, bMissing);
+
+  // The requesting document may not be the previewed one anymore (e.g.
+  // after switching tabs), thus every cached preview containing the link
+  // (with or without anchor) is updated
+  const QString sHref("href=\"" + sPageUrl);
+  const QList<const QTextDocument *> listDocs(m_PreviewCache.keys());
+  for (const auto *pDoc : listDocs) {
+    CachedPreview *pCached = m_PreviewCache.object(pDoc);
+    if (pCached->sHtml.contains(sHref + "\"") ||
+        pCached->sHtml.contains(sHref + "#")) {
+      pCached->linkStates.insert(sPageUrl, bMissing);
+    }
+  }
+}
 
-  selection.format.setBackground(m_colorSyntaxError);
-  selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+void InyokaEdit::patchLinkState(const QString &sPageUrl,
+                                const bool bMissing) {
+#ifdef NOPREVIEW
+  Q_UNUSED(sPageUrl)
+  Q_UNUSED(bMissing)
+#else
+  // Escape for CSS string first, then for JavaScript string
+  QString sUrl(sPageUrl);
+  sUrl.replace(QLatin1String("\\"), QLatin1String("\\\\"));
+  sUrl.replace(QLatin1String("\""), QLatin1String("\\\""));
+  sUrl.replace(QLatin1String("\\"), QLatin1String("\\\\"));
+  sUrl.replace(QLatin1String("'"), QLatin1String("\\'"));
+  const QString sScript(
+        QStringLiteral("(function() {"
+                       "  var links = document.querySelectorAll("
+                       "    'a.internal[href=\"%1\"],"
+                       "     a.internal[href^=\"%1#\"]');"
+                       "  for (var i = 0; i < links.length; i++) {"
+                       "    links[i].classList.%2('missing');"
+                       "  }"
+                       "})();")
+        .arg(sUrl, bMissing ? QStringLiteral("add")
+                            : QStringLiteral("remove")));
+#ifdef USEQTWEBKIT
+  m_pWebview->page()->mainFrame()->evaluateJavaScript(sScript);
+#endif
+#ifdef USEQTWEBENGINE
+  m_pWebview->page()->runJavaScript(sScript);
+#endif
+#endif
+}
 
-  extras.clear();
-  if (-1 != error.first) {
-    QTextCursor initialCur = m_pCurrentEditor->textCursor();
-    selection.cursor = m_pCurrentEditor->textCursor();
-    selection.cursor.setPosition(error.first);
-    selection.cursor.clearSelection();
-    extras << selection;
-    m_pCurrentEditor->setTextCursor(selection.cursor);
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::highlightSyntaxError(
+    const QVector<SyntaxDiagnostic> &diagnostics) {
+  this->markSyntaxErrors(diagnostics);
 
+  if (!diagnostics.isEmpty()) {
+    QTextCursor cursor(m_pCurrentEditor->document());
+    cursor.setPosition(qBound(
+                         0, diagnostics.first().nStart,
+                         m_pCurrentEditor->document()->characterCount() - 1));
     QFontMetrics fm1(QToolTip::font());
     QFontMetrics fm2(m_pSettings->getEditorFont());
-    QPoint cur = m_pCurrentEditor->cursorRect().topLeft();
+    QPoint cur = m_pCurrentEditor->cursorRect(cursor).topLeft();
     cur.setY(cur.y() + m_pCurrentEditor->viewport()->mapToGlobal(
           m_pCurrentEditor->pos()).y() - fm1.height() - fm2.height() - 10);
     cur.setX(cur.x() + m_pCurrentEditor->viewport()->mapToGlobal(
           m_pCurrentEditor->pos()).x());
-    QString sError(error.second);
-    if ("OPEN_PAR_MISSING" == sError) {
-      sError = tr("Opening parenthesis missing!");
-    } else if ("CLOSE_PAR_MISSING" == sError) {
-      sError = tr("Closing parenthesis missing!");
-    } else if (sError.startsWith(QLatin1String("UNKNOWN_TPL|"))) {
-      sError = sError.remove(QStringLiteral("UNKNOWN_TPL|"));
-      sError = tr("Unknown template:") + " " + sError;
-    } else {
-      qWarning() << "Unknown syntax error code: " + sError;
-      sError = tr("Syntax error");
+    QString sError(InyokaEdit::getSyntaxErrorText(diagnostics.first()));
+    if (diagnostics.size() > 1) {
+      sError += "\n" + tr("%n more problem(s) found.", "",
+                          diagnostics.size() - 1);
     }
     QToolTip::showText(cur, sError);
+  }
+}
+
+// ----------------------------------------------------------------------------
 
-    // Reset cursor to initial position to not disturb writing
-    m_pCurrentEditor->setTextCursor(initialCur);
+void InyokaEdit::markSyntaxErrors(
+    const QVector<SyntaxDiagnostic> &diagnostics) {
+  QList<QTextEdit::ExtraSelection> extras;
+  const QList<QTextEdit::ExtraSelection> current(
+        m_pCurrentEditor->extraSelections());
+  for (const auto &extra : current) {
+    if (!extra.format.hasProperty(SYNTAX_ERROR_PROPERTY)) {
+      extras << extra;
+    }
+  }
+
+  QTextEdit::ExtraSelection selection;
+  selection.format.setBackground(m_colorSyntaxError);
+  selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+  selection.format.setProperty(SYNTAX_ERROR_PROPERTY, true);
+
+  // Document may have been changed in the meantime
+  const int nMaxPos = m_pCurrentEditor->document()->characterCount() - 1;
+  for (const auto &diagnostic : diagnostics) {
+    selection.cursor = QTextCursor(m_pCurrentEditor->document());
+    selection.cursor.setPosition(qBound(0, diagnostic.nStart, nMaxPos));
+    extras << selection;
   }
 
   m_pCurrentEditor->setExtraSelections(extras);
 }
 
+// ----------------------------------------------------------------------------
+
+auto InyokaEdit::getSyntaxErrorText(
+    const SyntaxDiagnostic &diagnostic) -> QString {
+  if ("OPEN_PAR_MISSING" == diagnostic.sCode) {
+    return tr("Opening parenthesis missing!");
+  }
+  if ("CLOSE_PAR_MISSING" == diagnostic.sCode) {
+    return tr("Closing parenthesis missing!");
+  }
+  if ("UNKNOWN_TPL" == diagnostic.sCode) {
+    return tr("Unknown template:") + " " + diagnostic.sDetail;
+  }
+  qWarning() << "Unknown syntax error code: " + diagnostic.sCode;
+  return tr("Syntax error");
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
@@ -1041,6 +1390,7 @@ void InyokaEdit::displayArticleText(const QString &sArticleText,
 #ifndef NOPREVIEW
 // Wait until loading has finished
 void InyokaEdit::loadPreviewFinished(const bool bSuccess) {
+  m_bLoadingPreview = false;
   if (bSuccess) {
     // Enable / disbale back button
     if (m_pWebview->history()->canGoBack()) {
@@ -1066,11 +1416,20 @@ void InyokaEdit::loadPreviewFinished(const bool bSuccess) {
           .arg(m_WebviewScrollPosition.x())
           .arg(m_WebviewScrollPosition.y()));
 #endif
+    this->updateSourceMap();
+
+    // Link checks which finished while loading
+    QHashIterator<QString, bool> it(m_LinkStates);
+    while (it.hasNext()) {
+      it.next();
+      this->patchLinkState(it.key(), it.value());
+    }
     m_bReloadPreviewBlocked = false;
   } else {
     QMessageBox::warning(this, qApp->applicationName(),
                          tr("Error while loading preview."));
-    qWarning() << "Error while loading preview:" << m_sPreviewFile;
+    qWarning() << "Error while loading preview:"
+               << m_pPreviewContent->getUrl();
   }
 }
 
@@ -1081,12 +1440,18 @@ void InyokaEdit::changedUrl() {
 }
 
 void InyokaEdit::clickedLink(const QUrl &newUrl) {
-  if (!newUrl.toString().contains(m_sPreviewFile)
-      && newUrl.isLocalFile()) {
-    qDebug() << "Trying to open file:" << newUrl;
-    QDesktopServices::openUrl(newUrl);
+  QUrl url(newUrl);
+  // Local files referenced by the preview are resolved below its scheme
+  if (QLatin1String(PreviewContent::SCHEME) == url.scheme()
+      && !m_pPreviewContent->isPreviewUrl(url)) {
+    url = QUrl::fromLocalFile(url.path());
+  }
+
+  if (!m_pPreviewContent->isPreviewUrl(url) && url.isLocalFile()) {
+    qDebug() << "Trying to open file:" << url;
+    QDesktopServices::openUrl(url);
   } else {
-    m_pWebview->load(newUrl);
+    m_pWebview->load(url);
   }
 }
 #endif
@@ -1095,9 +1460,18 @@ void InyokaEdit::clickedLink(const QUrl &newUrl) {
 // ----------------------------------------------------------------------------
 
 void InyokaEdit::updateEditorSettings() {
-  m_pParser->updateSettings(m_pSettings->getInyokaUrl(),
-                            m_pSettings->getCheckLinks(),
-                            m_pSettings->getTimedPreview());
+#ifdef NOPREVIEW
+  // External browser has to reload the file by itself
+  const quint32 nRefresh = m_pSettings->getTimedPreview();
+#else
+  const quint32 nRefresh = 0;  // Updated by showPreview()
+#endif
+  // Parser is living in parser thread
+  QMetaObject::invokeMethod(m_pParser, "updateSettings", Qt::QueuedConnection,
+                            Q_ARG(QString, m_pSettings->getInyokaUrl()),
+                            Q_ARG(bool, m_pSettings->getCheckLinks()),
+                            Q_ARG(quint32, nRefresh));
+  m_nSettingsGeneration++;  // Next timed preview is parsing again
 
   if (m_pSettings->getPreviewHorizontal()) {
     m_pWidgetSplitter->setOrientation(Qt::Vertical);
@@ -1106,10 +1480,9 @@ void InyokaEdit::updateEditorSettings() {
   }
 
   m_pPreviewTimer->stop();
-  if (m_pSettings->getTimedPreview() != 0) {
-    m_pPreviewTimer->start(static_cast<int>(
-                             m_pSettings->getTimedPreview() * 1000));
-  }
+  m_pPreviewTimer->setInterval(static_cast<int>(
+                                 m_pSettings->getTimedPreview() * 1000));
+  this->editedDocument();
 
   m_pSession->updateSettings(m_pSettings->getInyokaUrl(),
                              m_pSettings->getInyokaUser(),
@@ -1122,6 +1495,8 @@ void InyokaEdit::updateEditorSettings() {
   m_pPlugins->setEditorlist(m_pFileOperations->getEditors());
 
   m_colorSyntaxError = InyokaEdit::getHighlightErrorColor();
+  m_pLiveSyntaxCheck->setDocument(m_pSettings->getSyntaxCheck()
+                                  ? m_pCurrentEditor->document() : nullptr);
 
   // Setting proxy if available
   Utils::setProxy(m_pSettings->getProxyHostName(),
@@ -1192,7 +1567,10 @@ auto InyokaEdit::eventFilter(QObject *pObj, QEvent *pEvent) -> bool {
     }
   }
 #ifndef NOPREVIEW
-  else if (pObj == m_pWebview && pEvent->type() == QEvent::MouseButtonPress) {
+  else if (pObj == m_pWebview && pEvent->type() == QEvent::Resize) {
+    m_pSourceMapTimer->start();  // Restarted by every resize event
+  } else if (pObj == m_pWebview &&
+             pEvent->type() == QEvent::MouseButtonPress) {
     // Forward / backward mouse button
     auto *mouseEvent = static_cast<QMouseEvent*>(pEvent);
 
@@ -1260,72 +1638,97 @@ void InyokaEdit::deleteAutoSaveBackups() {
 // ----------------------------------------------------------------------------
 
 void InyokaEdit::syncScrollbarsEditor() {
-#ifdef USEQTWEBKIT
+#ifndef NOPREVIEW
   if (!m_bWebviewScrolling && m_pSettings->getSyncScrollbars()) {
-    int nSizeEditorBar = m_pCurrentEditor->verticalScrollBar()->maximum();
-    int nSizeWebviewBar = m_pWebview->page()->mainFrame()->scrollBarMaximum(
-                            Qt::Vertical);
-    auto nR = static_cast<float>(nSizeWebviewBar) / nSizeEditorBar;
-
-    m_bEditorScrolling = true;
-    m_pWebview->page()->mainFrame()->setScrollPosition(
-          QPoint(
-            0,
-            static_cast<int>(
-              m_pCurrentEditor->verticalScrollBar()->sliderPosition() * nR)));
-    m_bEditorScrolling = false;
+    m_bSyncFromEditor = true;
+    if (!m_pScrollSyncTimer->isActive()) {
+      m_pScrollSyncTimer->start();
+    }
   }
 #endif
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::syncScrollbarsWebview() {
+#ifndef NOPREVIEW
+#ifdef USEQTWEBKIT
+  const int nPos = m_pWebview->page()->mainFrame()->scrollPosition().y();
+#endif
 #ifdef USEQTWEBENGINE
-  if (!m_bWebviewScrolling && m_pSettings->getSyncScrollbars()) {
-    m_pWebview->page()->runJavaScript(
-          QStringLiteral("document.documentElement.scrollHeight"),
-          [this](const QVariant &v) {
-      int nSizeEditorBar = m_pCurrentEditor->verticalScrollBar()->maximum();
-      int nSizeWebviewBar = v.toInt();
-      auto nR = static_cast<float>(nSizeWebviewBar) / nSizeEditorBar;
-      nSizeWebviewBar = static_cast<int>(
-            m_pCurrentEditor->verticalScrollBar()->sliderPosition() * nR);
-
-      m_bEditorScrolling = true;
-      m_pWebview->page()->runJavaScript(QStringLiteral("window.scrollTo(0,%1);")
-                                        .arg(nSizeWebviewBar));
-      m_bEditorScrolling = false;
-    });
+  const int nPos = static_cast<int>(m_pWebview->page()->scrollPosition().y());
+#endif
+  // Ignore scrolling caused by syncScrollPosition()
+  if (nPos != m_nSyncedWebviewPos && m_pSettings->getSyncScrollbars()) {
+    m_nSyncedWebviewPos = -1;
+    m_bSyncFromEditor = false;
+    if (!m_pScrollSyncTimer->isActive()) {
+      m_pScrollSyncTimer->start();
+    }
   }
 #endif
 }
 
 // ----------------------------------------------------------------------------
 
-void InyokaEdit::syncScrollbarsWebview() {
-#ifdef USEQTWEBKIT
-  if (!m_bEditorScrolling && m_pSettings->getSyncScrollbars()) {
-    int nSizeEditorBar = m_pCurrentEditor->verticalScrollBar()->maximum();
-    int nSizeWebviewBar = m_pWebview->page()->mainFrame()->scrollBarMaximum(
-                            Qt::Vertical);
-    auto nRatio = static_cast<float>(nSizeEditorBar) / nSizeWebviewBar;
+// Lines and positions are interpolated between the blocks of the source map
+void InyokaEdit::syncScrollPosition() {
+#ifndef NOPREVIEW
+  QScrollBar *pEditorBar = m_pCurrentEditor->verticalScrollBar();
+  const QAbstractTextDocumentLayout *pLayout =
+      m_pCurrentEditor->document()->documentLayout();
+
+  if (m_bSyncFromEditor) {
+    // First visible line including the hidden part of it
+    const QTextBlock block(
+          m_pCurrentEditor->cursorForPosition(QPoint(0, 0)).block());
+    const QRectF rect(pLayout->blockBoundingRect(block));
+    double dLine = block.blockNumber() + 1;
+    if (rect.height() > 0) {
+      dLine += qBound(0.0, (pEditorBar->value() - rect.top()) / rect.height(),
+                      1.0);
+    }
+    const double dPos = m_pPreviewContent->getScrollPosition(dLine);
+    if (dPos < 0) {
+      return;
+    }
 
-    m_bWebviewScrolling = true;
-    m_pCurrentEditor->verticalScrollBar()->setSliderPosition(static_cast<int>(
-          m_pWebview->page()->mainFrame()->scrollPosition().y() * nRatio));
-    m_bWebviewScrolling = false;
-  }
+#ifdef USEQTWEBKIT
+    QWebFrame *pFrame = m_pWebview->page()->mainFrame();
+    m_nSyncedWebviewPos = qMin(static_cast<int>(dPos),
+                               pFrame->scrollBarMaximum(Qt::Vertical));
+    pFrame->setScrollPosition(QPoint(pFrame->scrollPosition().x(),
+                                     m_nSyncedWebviewPos));
 #endif
 #ifdef USEQTWEBENGINE
-  if (!m_bEditorScrolling && m_pSettings->getSyncScrollbars()) {
+    const int nMax = static_cast<int>(
+          m_pWebview->page()->contentsSize().height() -
+          m_pWebview->height() / m_pWebview->zoomFactor());
+    m_nSyncedWebviewPos = qBound(0, static_cast<int>(dPos), qMax(0, nMax));
     m_pWebview->page()->runJavaScript(
-          QStringLiteral("document.documentElement.scrollHeight"),
-          [this](const QVariant &v) {
-      int nSizeEditorBar = m_pCurrentEditor->verticalScrollBar()->maximum();
-      int nSizeWebviewBar = v.toInt();
-      auto nRatio = static_cast<float>(nSizeEditorBar) / nSizeWebviewBar;
-
-      m_bWebviewScrolling = true;
-      m_pCurrentEditor->verticalScrollBar()->setSliderPosition(static_cast<int>(
-            m_pWebview->page()->scrollPosition().y() * nRatio));
-      m_bWebviewScrolling = false;
-    });
+          QStringLiteral("window.scrollTo(window.pageXOffset, %1);")
+          .arg(m_nSyncedWebviewPos));
+#endif
+  } else {
+#ifdef USEQTWEBKIT
+    const double dPos = m_pWebview->page()->mainFrame()->scrollPosition().y();
+#endif
+#ifdef USEQTWEBENGINE
+    const double dPos = m_pWebview->page()->scrollPosition().y();
+#endif
+    const double dLine = m_pPreviewContent->getSourceLine(dPos);
+    const QTextBlock block(m_pCurrentEditor->document()->findBlockByNumber(
+                             static_cast<int>(dLine) - 1));
+    if (dLine < 0 || !block.isValid()) {
+      return;
+    }
+
+    const QRectF rect(pLayout->blockBoundingRect(block));
+    m_bWebviewScrolling = true;
+    pEditorBar->setValue(static_cast<int>(
+                           rect.top() + (dLine - static_cast<int>(dLine)) *
+                           rect.height()));
+    m_bWebviewScrolling = false;
   }
 #endif
 }
@@ -1392,17 +1795,6 @@ void InyokaEdit::changeEvent(QEvent *pEvent) {
 
 #ifndef NOPREVIEW
 void InyokaEdit::showSyntaxOverview() {
-  auto *pDialog = new QDialog(this, this->windowFlags()
-                              & ~Qt::WindowContextHelpButtonHint);
-  auto *pLayout = new QGridLayout(pDialog);
-#ifdef USEQTWEBKIT
-  auto *pWebview = new QWebView();
-#endif
-#ifdef USEQTWEBENGINE
-  auto *pWebview = new QWebEngineView();
-#endif
-  auto *pTextDocument = new QTextDocument(this);
-
   QFile OverviewFile(m_sSharePath + "/community/" +
                      m_pSettings->getInyokaCommunity() +
                      "/SyntaxOverview.tpl");
@@ -1413,18 +1805,29 @@ void InyokaEdit::showSyntaxOverview() {
                          tr("Could not open syntax overview file!"));
     qWarning() << "Could not open syntax overview file:"
                << OverviewFile.fileName();
-    delete pLayout;
-    pLayout = nullptr;
-    delete pWebview;
-    pWebview = nullptr;
-    delete pTextDocument;
-    pTextDocument = nullptr;
     return;
   }
-  pTextDocument->setPlainText(in.readAll());
+  const QString sRawDoc(in.readAll());
   OverviewFile.close();
 
-  QString sRet(m_pParser->genOutput(QLatin1String(""), pTextDocument));
+  // Parsed in the parser thread; shown by showSyntaxOverviewPage()
+  emit parseSyntaxOverview(sRawDoc);
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaEdit::showSyntaxOverviewPage(const QString &sHtml) {
+  auto *pDialog = new QDialog(this, this->windowFlags()
+                              & ~Qt::WindowContextHelpButtonHint);
+  auto *pLayout = new QGridLayout(pDialog);
+#ifdef USEQTWEBKIT
+  auto *pWebview = new QWebView();
+#endif
+#ifdef USEQTWEBENGINE
+  auto *pWebview = new QWebEngineView();
+#endif
+
+  QString sRet(sHtml);
   sRet.remove(
         QRegularExpression(QStringLiteral("<h1 class=\"pagetitle\">.*</h1>"),
                            QRegularExpression::DotMatchesEverythingOption));
@@ -1433,14 +1836,13 @@ void InyokaEdit::showSyntaxOverview() {
                            QRegularExpression::DotMatchesEverythingOption));
   sRet.replace(QLatin1String("</style>"),
                QLatin1String("#page table{margin:0px;}</style>"));
-  pTextDocument->setPlainText(sRet);
 
   pLayout->setContentsMargins(2, 2, 2, 2);
   pLayout->setSpacing(0);
   pLayout->addWidget(pWebview);
   pDialog->setWindowTitle(tr("Syntax overview"));
 
-  pWebview->setHtml(pTextDocument->toPlainText(),
+  pWebview->setHtml(sRet,
                     QUrl::fromLocalFile(m_UserDataDir.absolutePath() + "/"));
   pDialog->show();
 }
@@ -27,13 +27,21 @@
 #ifndef APPLICATION_INYOKAEDIT_H_
 #define APPLICATION_INYOKAEDIT_H_
 
+#include <QCache>
 #include <QDir>
+#include <QHash>
 #include <QMainWindow>
+#include <QPointer>
 #include <QTranslator>
+#include <QVector>
+
+#include "./syntaxcheck.h"
 
 class QComboBox;
 class QFile;
 class QSplitter;
+class QTextDocument;
+class QThread;
 class QToolButton;
 #ifdef USEQTWEBKIT
 class QWebView;
@@ -44,8 +52,10 @@ class QWebEngineView;
 
 class Download;
 class FileOperations;
+class LiveSyntaxCheck;
 class Parser;
 class Plugins;
+class PreviewContent;
 class Settings;
 class Session;
 class Templates;
@@ -84,6 +94,9 @@ class InyokaEdit : public QMainWindow {
 
  signals:
     void updateUiLang();
+    void parsePreview(const int nGeneration, const QString &sActFile,
+                      const QString &sRawDoc, const bool bSyntaxCheck);
+    void parseSyntaxOverview(const QString &sRawDoc);
 
  private slots:
     void loadLanguage(const QString &sLang);
@@ -92,18 +105,27 @@ class InyokaEdit : public QMainWindow {
     void insertMacro(const QString &sInsert);
     void dropdownXmlChanged(int nIndex);
     void deleteTempImages();
-    void highlightSyntaxError(const QPair<int, QString> &error);
+    void highlightSyntaxError(const QVector<SyntaxDiagnostic> &diagnostics);
+    void markSyntaxErrors(const QVector<SyntaxDiagnostic> &diagnostics);
     static QColor getHighlightErrorColor();
     // Preview
     void previewInyokaPage();
+    void previewCurrentDocument();
+    void previewChangedDocument();
+    void removeCachedPreview(QObject *pDoc);
+    void editedDocument();
+    void showPreview(const int nGeneration, const QString &sHtml);
+    void updateLinkState(const QString &sPageUrl, const bool bMissing);
     void syncScrollbarsEditor();
     void syncScrollbarsWebview();
+    void syncScrollPosition();
     void showAbout();
 #ifndef NOPREVIEW
     void loadPreviewFinished(const bool bSuccess);
     void clickedLink(const QUrl &newUrl);
     void changedUrl();
     void showSyntaxOverview();
+    void showSyntaxOverviewPage(const QString &sHtml);
 #endif
 
  private:
@@ -116,6 +138,15 @@ class InyokaEdit : public QMainWindow {
     void deleteAutoSaveBackups();
     void readSettings();
     void writeSettings();
+    void displayPreview(const QString &sHtml);
+    void patchLinkState(const QString &sPageUrl, const bool bMissing);
+#ifndef NOPREVIEW
+    void patchPreview(const QString &sScript);
+    void reloadPreview();
+    void updateSourceMap();
+#endif
+    static auto getSyntaxErrorText(
+        const SyntaxDiagnostic &diagnostic) -> QString;
     static auto switchTranslator(
         QTranslator *translator,
         const QString &sFile,
@@ -130,6 +161,9 @@ class InyokaEdit : public QMainWindow {
     TextEditor *m_pCurrentEditor{};
     Plugins *m_pPlugins{};
     Parser *m_pParser{};
+    PreviewContent *m_pPreviewContent{};
+    LiveSyntaxCheck *m_pLiveSyntaxCheck{};
+    QThread *m_pParserThread{};
     Settings *m_pSettings{};
     Session *m_pSession{};
     Download *m_pDownloadModule{};
@@ -138,6 +172,7 @@ class InyokaEdit : public QMainWindow {
     QSplitter *m_pWidgetSplitter{};
     QTabWidget *m_pDocumentTabs{};
     QPoint m_WebviewScrollPosition;
+    QHash<QString, bool> m_LinkStates;  // Since last preview
 #ifdef USEQTWEBKIT
     QWebView *m_pWebview{};
 #endif
@@ -160,11 +195,34 @@ class InyokaEdit : public QMainWindow {
     const QString m_sPreviewFile;
     QColor m_colorSyntaxError;
     QDir m_tmpPreviewImgDir;
-    QTimer *m_pPreviewTimer;
+    QTimer *m_pPreviewTimer;  // Timed preview after last edit
+    QMetaObject::Connection m_EditedDocConnection;  // Of current document
+    QTimer *m_pScrollSyncTimer;
+    QTimer *m_pSourceMapTimer;  // Source map update after resizing
+    int m_nPreviewGeneration;
+    // Input of the last preview request
+    QPointer<QTextDocument> m_pPreviewedDoc;
+    int m_nPreviewedRevision;
+    uint m_nPreviewedHash;
+    QString m_sPreviewedFile;
+    int m_nPreviewedSettings;
+    int m_nSettingsGeneration;
+    // Last rendered preview of each document, for switching between tabs
+    struct CachedPreview {
+      int nRevision;
+      uint nHash;
+      QString sFile;
+      int nSettings;
+      QString sHtml;
+      QHash<QString, bool> linkStates;
+    };
+    QCache<const QTextDocument *, CachedPreview> m_PreviewCache;
     bool m_bOpenFileAfterStart;
-    bool m_bEditorScrolling;
+    int m_nSyncedWebviewPos;  // Set by syncScrollPosition()
+    bool m_bSyncFromEditor;
     bool m_bWebviewScrolling;
     bool m_bReloadPreviewBlocked;
+    bool m_bLoadingPreview;
 };
 
 #endif  // APPLICATION_INYOKAEDIT_H_
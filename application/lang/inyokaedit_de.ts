@@ -602,6 +602,14 @@ Bitte überprüfe die Installation und starte das Programm erneut.</translation>
         <source>Error while loading preview.</source>
         <translation>Fehler beim Laden der Vorschau.</translation>
     </message>
+    <message>
+        <location filename="../inyokaedit.cpp" line="1171"/>
+        <source>%n more problem(s) found.</source>
+        <translation numerus="yes">
+            <numerusform>%n weiteres Problem gefunden.</numerusform>
+            <numerusform>%n weitere Probleme gefunden.</numerusform>
+        </translation>
+    </message>
     <message>
         <location filename="../inyokaedit.cpp" line="1210"/>
         <source>Do you really want to delete all temporay article images?</source>
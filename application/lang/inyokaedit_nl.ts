@@ -602,6 +602,14 @@ Controleer uw installatie en herstart de applicatie.</translation>
         <source>Error while loading preview.</source>
         <translation>Fout tijdens laden van voorbeeld.</translation>
     </message>
+    <message>
+        <location filename="../inyokaedit.cpp" line="1171"/>
+        <source>%n more problem(s) found.</source>
+        <translation numerus="yes">
+            <numerusform>%n ander probleem gevonden.</numerusform>
+            <numerusform>%n andere problemen gevonden.</numerusform>
+        </translation>
+    </message>
     <message>
         <location filename="../inyokaedit.cpp" line="1210"/>
         <source>Do you really want to delete all temporay article images?</source>
@@ -0,0 +1,221 @@
+/**
+ * \file livesyntaxcheck.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Incremental syntax check while typing.
+ */
+
+#include "./livesyntaxcheck.h"
+
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+const int CHECK_DELAY = 300;  // Milliseconds after last key press
+
+// Lines are stored relative to the block, thus they stay valid if lines
+// are inserted or removed before
+class SyntaxCheckData : public QTextBlockUserData {
+ public:
+    QVector<SyntaxCheck::OpenBracket> vOpenBrackets;  // At end of block
+    QVector<SyntaxDiagnostic> diagnostics;
+};
+
+auto moveLines(QVector<SyntaxCheck::OpenBracket> vOpenBrackets,
+               const int nOffset) -> QVector<SyntaxCheck::OpenBracket> {
+  for (auto &open : vOpenBrackets) {
+    open.nLine += nOffset;
+  }
+  return vOpenBrackets;
+}
+
+auto moveLines(QVector<SyntaxDiagnostic> diagnostics,
+               const int nOffset) -> QVector<SyntaxDiagnostic> {
+  for (auto &diagnostic : diagnostics) {
+    diagnostic.nLine += nOffset;
+    diagnostic.nEndLine += nOffset;
+  }
+  return diagnostics;
+}
+}  // namespace
+
+LiveSyntaxCheck::LiveSyntaxCheck(const SyntaxCheck::Rules &rules,
+                                 QObject *pParent)
+  : QObject(pParent),
+    m_Rules(rules),
+    m_nFirstChanged(-1),
+    m_nLastChangedFromEnd(0),
+    m_nRevision(-1) {
+  m_pDelayTimer = new QTimer(this);
+  m_pDelayTimer->setSingleShot(true);
+  m_pDelayTimer->setInterval(CHECK_DELAY);
+  connect(m_pDelayTimer, &QTimer::timeout,
+          this, &LiveSyntaxCheck::checkChangedBlocks);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void LiveSyntaxCheck::setDocument(QTextDocument *pDoc) {
+  if (!m_pDoc.isNull()) {
+    disconnect(m_pDoc, nullptr, this, nullptr);
+  }
+  m_pDoc = pDoc;
+  m_pDelayTimer->stop();
+  m_nFirstChanged = -1;
+  m_Diagnostics.clear();
+
+  if (m_pDoc.isNull()) {
+    emit this->diagnosticsChanged(m_Diagnostics);
+    return;
+  }
+
+  // Edits while another document was active are unknown, so start over
+  connect(m_pDoc, &QTextDocument::contentsChange,
+          this, &LiveSyntaxCheck::changedContents);
+  m_nFirstChanged = 0;
+  m_nLastChangedFromEnd = 0;
+  this->checkChangedBlocks();
+}
+
+// ----------------------------------------------------------------------------
+
+auto LiveSyntaxCheck::getDiagnostics() -> QVector<SyntaxDiagnostic> {
+  if (m_pDelayTimer->isActive()) {
+    m_pDelayTimer->stop();
+    this->checkChangedBlocks();
+  }
+  return m_Diagnostics;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void LiveSyntaxCheck::changedContents(int nPosition, int nCharsRemoved,
+                                      int nCharsAdded) {
+  Q_UNUSED(nCharsRemoved)
+  // Changes of formats only (e.g. syntax highlighting) keep the revision
+  if (m_pDoc->revision() == m_nRevision) {
+    return;
+  }
+
+  const int nFirst = m_pDoc->findBlock(nPosition).blockNumber();
+  const QTextBlock lastBlock(m_pDoc->findBlock(nPosition + nCharsAdded));
+  const int nLastFromEnd = lastBlock.isValid()
+                           ? m_pDoc->blockCount() - 1 - lastBlock.blockNumber()
+                           : 0;
+
+  if (-1 == m_nFirstChanged) {
+    m_nFirstChanged = nFirst;
+    m_nLastChangedFromEnd = nLastFromEnd;
+  } else {
+    m_nFirstChanged = qMin(m_nFirstChanged, nFirst);
+    m_nLastChangedFromEnd = qMin(m_nLastChangedFromEnd, nLastFromEnd);
+  }
+  m_pDelayTimer->start();
+}
+
+// ----------------------------------------------------------------------------
+
+void LiveSyntaxCheck::checkChangedBlocks() {
+  if (m_pDoc.isNull() || -1 == m_nFirstChanged) {
+    return;
+  }
+
+  const int nLastChanged = m_pDoc->blockCount() - 1 - m_nLastChangedFromEnd;
+  QTextBlock block(m_pDoc->findBlockByNumber(m_nFirstChanged));
+  if (!block.isValid()) {
+    block = m_pDoc->firstBlock();
+  }
+  m_nFirstChanged = -1;
+  m_nRevision = m_pDoc->revision();
+
+  // Continue with the state at the end of the previous block
+  QVector<SyntaxCheck::OpenBracket> vOpenBrackets;
+  const QTextBlock previous(block.previous());
+  if (previous.isValid()) {
+    auto *pData = dynamic_cast<SyntaxCheckData *>(previous.userData());
+    if (nullptr != pData) {
+      vOpenBrackets = moveLines(pData->vOpenBrackets, previous.blockNumber());
+    } else {
+      block = m_pDoc->firstBlock();
+    }
+  }
+
+  for (; block.isValid(); block = block.next()) {
+    const int nBlock = block.blockNumber();
+    const QVector<SyntaxDiagnostic> diagnostics(
+          SyntaxCheck::checkLine(block.text(), nBlock, m_Rules, vOpenBrackets));
+    const QVector<SyntaxCheck::OpenBracket> vState(
+          moveLines(vOpenBrackets, -nBlock));
+
+    auto *pData = dynamic_cast<SyntaxCheckData *>(block.userData());
+    const bool bUnchanged = nullptr != pData && pData->vOpenBrackets == vState;
+    if (nullptr == pData) {
+      pData = new SyntaxCheckData;
+      block.setUserData(pData);  // Block takes ownership
+    }
+    pData->vOpenBrackets = vState;
+    pData->diagnostics = moveLines(diagnostics, -(nBlock + 1));
+
+    // Following blocks would lead to the same results as before
+    if (bUnchanged && nBlock >= nLastChanged) {
+      break;
+    }
+  }
+
+  this->collectDiagnostics();
+}
+
+// ----------------------------------------------------------------------------
+
+void LiveSyntaxCheck::collectDiagnostics() {
+  m_Diagnostics.clear();
+  QVector<SyntaxCheck::OpenBracket> vOpenBrackets;
+
+  for (QTextBlock block = m_pDoc->firstBlock(); block.isValid();
+       block = block.next()) {
+    const auto *pData = dynamic_cast<SyntaxCheckData *>(block.userData());
+    if (nullptr == pData) {
+      continue;
+    }
+    const int nBlock = block.blockNumber();
+    m_Diagnostics << moveLines(pData->diagnostics, nBlock + 1);
+    vOpenBrackets = moveLines(pData->vOpenBrackets, nBlock);
+  }
+  m_Diagnostics << SyntaxCheck::unclosedBrackets(vOpenBrackets);
+
+  for (auto &diagnostic : m_Diagnostics) {
+    diagnostic.nStart = m_pDoc->findBlockByNumber(
+                          diagnostic.nLine - 1).position() +
+                        diagnostic.nColumn - 1;
+  }
+  std::stable_sort(m_Diagnostics.begin(), m_Diagnostics.end(),
+                   [](const SyntaxDiagnostic &a, const SyntaxDiagnostic &b) {
+    return a.nStart < b.nStart;
+  });
+
+  emit this->diagnosticsChanged(m_Diagnostics);
+}
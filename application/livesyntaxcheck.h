@@ -0,0 +1,81 @@
+/**
+ * \file livesyntaxcheck.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for incremental syntax check while typing.
+ */
+
+#ifndef APPLICATION_LIVESYNTAXCHECK_H_
+#define APPLICATION_LIVESYNTAXCHECK_H_
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+#include "./syntaxcheck.h"
+
+class QTextDocument;
+class QTimer;
+
+/**
+ * \class LiveSyntaxCheck
+ * \brief Checks Inyoka syntax of a document while typing.
+ *
+ * Every block stores the brackets still open at its end and its own
+ * diagnostics as user data. After an edit only the changed blocks are
+ * checked again, followed by further blocks until the stored state
+ * matches again.
+ */
+class LiveSyntaxCheck : public QObject {
+  Q_OBJECT
+
+ public:
+    explicit LiveSyntaxCheck(const SyntaxCheck::Rules &rules,
+                             QObject *pParent = nullptr);
+
+    // nullptr disables the check
+    void setDocument(QTextDocument *pDoc);
+    // Runs pending checks first
+    auto getDiagnostics() -> QVector<SyntaxDiagnostic>;
+
+ signals:
+    void diagnosticsChanged(const QVector<SyntaxDiagnostic> &diagnostics);
+
+ private slots:
+    void changedContents(int nPosition, int nCharsRemoved, int nCharsAdded);
+    void checkChangedBlocks();
+
+ private:
+    void collectDiagnostics();
+
+    const SyntaxCheck::Rules m_Rules;
+    QPointer<QTextDocument> m_pDoc;
+    QTimer *m_pDelayTimer;
+    // Changed blocks; the end is counted from the last block, since it is
+    // not affected by lines inserted or removed before
+    int m_nFirstChanged;
+    int m_nLastChangedFromEnd;
+    int m_nRevision;  // Of last check
+    QVector<SyntaxDiagnostic> m_Diagnostics;
+};
+
+#endif  // APPLICATION_LIVESYNTAXCHECK_H_
@@ -40,12 +40,19 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDebug>
+#include <QLoggingCategory>
+#include <QScopedPointer>
 #include <QtGlobal>
+#include <QThread>
 #include <QTime>
 #include <QTextStream>
 #include <QStandardPaths>
 
+#include "./batchrenderer.h"
 #include "./inyokaedit.h"
+#include "./parser/imagesizecache.h"
+#include "./parser/imagesizereader.h"
+#include "./previewcontent.h"
 
 static QFile logfile;
 static QTextStream out(&logfile);
@@ -58,18 +65,41 @@ void LoggingHandler(QtMsgType type,
 // ----------------------------------------------------------------------------
 
 auto main(int argc, char *argv[]) -> int {
-  QApplication app(argc, argv);
-  app.setApplicationName(QStringLiteral(APP_NAME));
-  app.setApplicationVersion(QStringLiteral(APP_VERSION));
-  app.setApplicationDisplayName(QStringLiteral(APP_NAME));
+  // Headless rendering must not create any widget
+  bool bRender = false;
+  for (int i = 1; i < argc; i++) {
+    if (0 == qstrcmp(argv[i], "--render")) {
+      bRender = true;
+      break;
+    }
+  }
+
+  if (!bRender) {
+    PreviewContent::registerScheme();
+  }
+
+  QScopedPointer<QCoreApplication> pApp(
+        bRender ? new QCoreApplication(argc, argv)
+                : new QApplication(argc, argv));
+  // Resources of the static parser library (e.g. macros.conf, which is
+  // used by plugins as well) are registered before anything is loaded
+  Q_INIT_RESOURCE(libinyokaparser);
+  // Formats the parser library cannot read without Qt GUI
+  ImageSizeCache::setFallbackReader(readImageSize);
+  QCoreApplication::setApplicationName(QStringLiteral(APP_NAME));
+  QCoreApplication::setApplicationVersion(QStringLiteral(APP_VERSION));
+  if (!bRender) {
+    QGuiApplication::setApplicationDisplayName(QStringLiteral(APP_NAME));
 #if !defined(Q_OS_WIN) && !defined(Q_OS_MAC)
-  app.setWindowIcon(
-        QIcon::fromTheme(QStringLiteral("inyokaedit"),
-                         QIcon(QStringLiteral(":/inyokaedit.png"))));
+    QGuiApplication::setWindowIcon(
+          QIcon::fromTheme(QStringLiteral("inyokaedit"),
+                           QIcon(QStringLiteral(":/inyokaedit.png"))));
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
-  app.setDesktopFileName(QStringLiteral("org.inyokaproject.inyokaedit"));
+    QGuiApplication::setDesktopFileName(
+          QStringLiteral("org.inyokaproject.inyokaedit"));
 #endif
 #endif
+  }
 
   QCommandLineParser cmdparser;
   cmdparser.setApplicationDescription(QStringLiteral(APP_DESC));
@@ -85,9 +115,34 @@ auto main(int argc, char *argv[]) -> int {
                                 "community files, plugins, etc.)"),
                               QStringLiteral("Path to folder"));
   cmdparser.addOption(cmdShare);
+  QCommandLineOption cmdRender(QStringLiteral("render"),
+                               QString::fromLatin1(
+                                 "Render given files and folders to HTML "
+                                 "without GUI"));
+  cmdparser.addOption(cmdRender);
+  QCommandLineOption cmdOutput(QStringList() << QStringLiteral("o") <<
+                               QStringLiteral("output"),
+                               QString::fromLatin1(
+                                 "Output folder for rendered HTML files and "
+                                 "report.json (default: current folder)"),
+                               QStringLiteral("Path to folder"),
+                               QStringLiteral("."));
+  cmdparser.addOption(cmdOutput);
+  QCommandLineOption cmdJobs(QStringList() << QStringLiteral("j") <<
+                             QStringLiteral("jobs"),
+                             QString::fromLatin1(
+                               "Number of parallel render jobs "
+                               "(default: number of cores)"),
+                             QStringLiteral("N"));
+  cmdparser.addOption(cmdJobs);
+  QCommandLineOption cmdCompare(QStringLiteral("compare-blocks"),
+                                QString::fromLatin1(
+                                  "Check that rendering block by block "
+                                  "matches rendering whole articles"));
+  cmdparser.addOption(cmdCompare);
   cmdparser.addPositionalArgument(QStringLiteral("file"),
                                   QStringLiteral("File to be opened"));
-  cmdparser.process(app);
+  cmdparser.process(*pApp);
 
   // User data directory
   QStringList sListPaths = QStandardPaths::standardLocations(
@@ -99,15 +154,40 @@ auto main(int argc, char *argv[]) -> int {
   const QDir userDataDir(sListPaths[0].toLower());
 
   // Default share data path (Windows and debugging)
-  QString sSharePath = app.applicationDirPath();
+  QString sSharePath = QCoreApplication::applicationDirPath();
   // Standard installation path (Linux)
-  QDir tmpDir(app.applicationDirPath() + "/../share/"
-              + app.applicationName().toLower());
+  QDir tmpDir(QCoreApplication::applicationDirPath() + "/../share/"
+              + QCoreApplication::applicationName().toLower());
   if (cmdparser.isSet(cmdShare)) {  // -s overwrites debug path (app folder)
     sSharePath = cmdparser.value(cmdShare);
   } else if (!cmdparser.isSet(enableDebug) && tmpDir.exists()) {
-    sSharePath = app.applicationDirPath() + "/../share/"
-                 + app.applicationName().toLower();
+    sSharePath = QCoreApplication::applicationDirPath() + "/../share/"
+                 + QCoreApplication::applicationName().toLower();
+  }
+
+  if (bRender) {
+    // Logging to file is not thread-safe; keep stderr for warnings
+    if (!cmdparser.isSet(enableDebug)) {
+      QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+    }
+    if (cmdparser.positionalArguments().isEmpty()) {
+      QTextStream(stderr) << "No files or folders given to be rendered.\n";
+      return 1;
+    }
+    int nJobs = QThread::idealThreadCount();
+    if (cmdparser.isSet(cmdJobs)) {
+      bool bOk = false;
+      nJobs = cmdparser.value(cmdJobs).toInt(&bOk);
+      if (!bOk || nJobs < 1) {
+        QTextStream(stderr) << "Invalid number of jobs: "
+                            << cmdparser.value(cmdJobs) << "\n";
+        return 1;
+      }
+    }
+    BatchRenderer renderer(sSharePath, userDataDir);
+    return renderer.run(cmdparser.positionalArguments(),
+                        cmdparser.value(cmdOutput), qMax(1, nJobs),
+                        cmdparser.isSet(cmdCompare));
   }
 
   const QString sDebugFile(QStringLiteral("debug.log"));
@@ -130,9 +210,9 @@ auto main(int argc, char *argv[]) -> int {
 
   InyokaEdit myInyokaEdit(userDataDir, sSharePath, sArg);
   myInyokaEdit.show();
-  int nRet = app.exec();
+  int nRet = pApp->exec();
 
-  qDebug() << "Closing" << app.applicationName();
+  qDebug() << "Closing" << QCoreApplication::applicationName();
   out.flush();
   logfile.close();
   return nRet;
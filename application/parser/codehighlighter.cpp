@@ -0,0 +1,400 @@
+/**
+ * \file codehighlighter.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Built-in syntax highlighting of code blocks without pygments.
+ * Lexer tables are simplified versions of the pygments lexers.
+ */
+
+#include "./codehighlighter.h"
+
+#include <QPair>
+#include <QStringList>
+
+namespace {
+struct RuleDef {
+  QString sState;
+  QString sPattern;
+  QList<CodeHighlighter::Token> listTokens;
+  QString sNextState;
+};
+
+typedef CodeHighlighter CH;
+
+// ----------------------------------------------------------------------------
+
+const QVector<RuleDef> BASH_RULES = {
+  {"root", R"(\\[\s\S])", {CH::StringEscape}, ""},
+  {"root", R"(\$\{[^}\n]*\}|\$[A-Za-z_]\w*|\$[0-9#?$!@*-])",
+   {CH::NameVariable}, ""},
+  {"root", R"(\$\(\(|\$\()", {CH::Keyword}, ""},
+  {"root", R"("(?:\\[\s\S]|[^"\\])*")", {CH::String}, ""},
+  {"root", R"('[^']*')", {CH::String}, ""},
+  {"root", R"(`[^`]*`)", {CH::String}, ""},
+  {"root", R"(#.*)", {CH::Comment}, ""},
+  {"root", R"((?<![\w./-])(if|fi|else|while|in|do|done|for|then|return|)"
+           R"(function|case|select|break|continue|until|esac|elif))"
+           R"((?![\w./-]))", {CH::Keyword}, ""},
+  {"root", R"((?<![\w./-])(alias|bg|bind|builtin|caller|cd|command|)"
+           R"(compgen|complete|declare|dirs|disown|echo|enable|eval|exec|)"
+           R"(exit|export|false|fc|fg|getopts|hash|help|history|jobs|kill|)"
+           R"(let|local|logout|popd|printf|pushd|pwd|read|readonly|set|)"
+           R"(shift|shopt|source|suspend|test|time|times|trap|true|type|)"
+           R"(typeset|ulimit|umask|unalias|unset|wait)(?=[\s)`;]|$))",
+   {CH::NameBuiltin}, ""},
+  {"root", R"(\b([A-Za-z_]\w*)(\+?=))", {CH::NameVariable, CH::Operator},
+   ""},
+  {"root", R"(&&|\|\||[\[\]{}()=])", {CH::Operator}, ""},
+  {"root", R"(\b\d+\b)", {CH::Number}, ""},
+  {"root", R"([\w./:-]+)", {CH::Text}, ""}
+};
+
+const QVector<RuleDef> PYTHON_RULES = {
+  {"root", R"(^([ \t]*)([rRuU]{0,2}"""[\s\S]*?"""|[rRuU]{0,2}'''[\s\S]*?'''))",
+   {CH::Text, CH::StringDoc}, ""},
+  {"root", R"(#.*)", {CH::Comment}, ""},
+  {"root", R"(@[\w.]+)", {CH::NameDecorator}, ""},
+  {"root", R"(\b(def)(\s+)([A-Za-z_]\w*))",
+   {CH::Keyword, CH::Text, CH::NameFunction}, ""},
+  {"root", R"(\b(class)(\s+)([A-Za-z_]\w*))",
+   {CH::Keyword, CH::Text, CH::NameClass}, ""},
+  {"root", R"(\b(from)(\s+)([\w.]+)(\s+)(import)\b)",
+   {CH::Keyword, CH::Text, CH::NameNamespace, CH::Text, CH::Keyword}, ""},
+  {"root", R"(\b(import)(\s+)([\w.]+))",
+   {CH::Keyword, CH::Text, CH::NameNamespace}, ""},
+  {"root", R"(\b(assert|async|await|break|continue|del|elif|else|except|)"
+           R"(finally|for|global|if|lambda|pass|raise|nonlocal|return|try|)"
+           R"(while|yield|as|with|def|class|from|import|True|False|None)\b)",
+   {CH::Keyword}, ""},
+  {"root", R"(\b(in|is|and|or|not)\b)", {CH::OperatorWord}, ""},
+  {"root", R"((?<!\.)\b(self|cls|abs|all|any|bin|bool|bytes|callable|chr|)"
+           R"(dict|dir|divmod|enumerate|eval|exec|filter|float|format|)"
+           R"(frozenset|getattr|globals|hasattr|hash|hex|id|input|int|)"
+           R"(isinstance|issubclass|iter|len|list|locals|map|max|min|next|)"
+           R"(object|oct|open|ord|pow|print|property|range|repr|reversed|)"
+           R"(round|set|setattr|slice|sorted|staticmethod|str|sum|super|)"
+           R"(tuple|type|vars|zip)\b)", {CH::NameBuiltin}, ""},
+  {"root", R"([rRbBuUfF]{0,2}"""[\s\S]*?"""|[rRbBuUfF]{0,2}'''[\s\S]*?''')",
+   {CH::String}, ""},
+  {"root", R"([rRbBuUfF]{0,2}"(?:\\.|[^"\\\n])*"|)"
+           R"([rRbBuUfF]{0,2}'(?:\\.|[^'\\\n])*')", {CH::String}, ""},
+  {"root", R"(\b0[xXoObB][0-9a-fA-F_]+\b|)"
+           R"((?:\b\d[\d_]*(?:\.\d*)?|\.\d+)(?:[eE][+-]?\d+)?j?\b)",
+   {CH::Number}, ""},
+  {"root", R"(!=|==|<<|>>|:=|[-~+/*%=<>&^|.])", {CH::Operator}, ""},
+  {"root", R"([A-Za-z_]\w*)", {CH::Text}, ""}
+};
+
+const QVector<RuleDef> CPP_RULES = {
+  {"root", R"(^[ \t]*#[ \t]*[A-Za-z]+.*)", {CH::CommentPreproc}, ""},
+  {"root", R"(//.*)", {CH::Comment}, ""},
+  {"root", R"(/\*[\s\S]*?\*/)", {CH::Comment}, ""},
+  {"root", R"((?:u8|u|U|L)?"(?:\\.|[^"\\\n])*")", {CH::String}, ""},
+  {"root", R"((?:u8|u|U|L)?'(?:\\.|[^'\\\n])+')", {CH::String}, ""},
+  {"root", R"(\b(alignas|alignof|and|asm|auto|break|case|catch|class|)"
+           R"(const|constexpr|const_cast|continue|decltype|default|delete|)"
+           R"(do|dynamic_cast|else|enum|explicit|export|extern|final|for|)"
+           R"(friend|goto|if|inline|mutable|namespace|new|noexcept|not|)"
+           R"(nullptr|operator|or|override|private|protected|public|)"
+           R"(register|reinterpret_cast|restrict|return|sizeof|static|)"
+           R"(static_assert|static_cast|struct|switch|template|this|throw|)"
+           R"(try|typedef|typeid|typename|union|using|virtual|volatile|)"
+           R"(while)\b)", {CH::Keyword}, ""},
+  {"root", R"(\b(bool|char|char16_t|char32_t|double|float|int|long|short|)"
+           R"(signed|unsigned|void|wchar_t|size_t|ssize_t|int8_t|int16_t|)"
+           R"(int32_t|int64_t|uint8_t|uint16_t|uint32_t|uint64_t)\b)",
+   {CH::KeywordType}, ""},
+  {"root", R"(\b(true|false|NULL)\b)", {CH::NameBuiltin}, ""},
+  {"root", R"((?:\b0[xX][0-9a-fA-F']+|(?:\b\d[\d']*(?:\.\d*)?|\.\d+)))"
+           R"((?:[eE][+-]?\d+)?[uUlLfF]*\b)", {CH::Number}, ""},
+  {"root", R"([~!%^&*+=|?:<>/-])", {CH::Operator}, ""},
+  {"root", R"([A-Za-z_]\w*)", {CH::Text}, ""}
+};
+
+const QVector<RuleDef> INI_RULES = {
+  {"root", R"(^[ \t]*[;#].*)", {CH::Comment}, ""},
+  {"root", R"(^[ \t]*\[[^\n]*?\](?=[ \t]*$))", {CH::Keyword}, ""},
+  {"root", R"(^([ \t]*[^=:;#\[\s][^=:\n]*?)([ \t]*)([=:])([ \t]*)(.*))",
+   {CH::NameAttribute, CH::Text, CH::Operator, CH::Text, CH::String}, ""}
+};
+
+const QVector<RuleDef> DIFF_RULES = {
+  {"root", R"(^ .*)", {CH::Text}, ""},
+  {"root", R"(^(?:!.*|---$))", {CH::GenericStrong}, ""},
+  {"root", R"(^(?:< |-).*)", {CH::GenericDeleted}, ""},
+  {"root", R"(^(?:> |\+).*)", {CH::GenericInserted}, ""},
+  {"root", R"(^(?:@.*|\d(?:,\d+)*(?:a|d|c)\d+(?:,\d+)*))",
+   {CH::GenericSubheading}, ""},
+  {"root", R"(^(?:[Ii]ndex|diff|=).*)", {CH::GenericHeading}, ""},
+  {"root", R"(.+)", {CH::Text}, ""}
+};
+
+const QVector<RuleDef> XML_RULES = {
+  {"root", R"(<!--[\s\S]*?-->)", {CH::Comment}, ""},
+  {"root", R"(<!\[CDATA\[[\s\S]*?\]\]>)", {CH::CommentPreproc}, ""},
+  {"root", R"(<\?[\s\S]*?\?>|<![^>]*>)", {CH::CommentPreproc}, ""},
+  {"root", R"(<\s*/\s*[\w:.-]+\s*>)", {CH::NameTag}, ""},
+  {"root", R"(<\s*[\w:.-]+)", {CH::NameTag}, "tag"},
+  {"root", R"(&\S*?;)", {CH::NameEntity}, ""},
+  {"root", R"([^<&]+)", {CH::Text}, ""},
+  {"tag", R"(\s+)", {CH::Text}, ""},
+  {"tag", R"([\w.:-]+\s*=)", {CH::NameAttribute}, "attr"},
+  {"tag", R"(/?\s*>)", {CH::NameTag}, "#pop"},
+  {"attr", R"(\s+)", {CH::Text}, ""},
+  {"attr", R"("[^"]*"|'[^']*'|[^\s>]+)", {CH::String}, "#pop"}
+};
+
+const QVector<RuleDef> YAML_RULES = {
+  {"root", R"((?<!\S)#.*)", {CH::Comment}, ""},
+  {"root", R"(^(?:---|\.\.\.)(?=\s|$))", {CH::NameNamespace}, ""},
+  {"root", R"(([^\s#'"\-\[\]{},:][^\n#:]*?|"[^"\n]*"|'[^'\n]*'))"
+           R"(([ \t]*)(:)(?=[ \t]|$))", {CH::NameTag, CH::Text, CH::Text},
+   ""},
+  {"root", R"(&[\w-]+)", {CH::NameLabel}, ""},
+  {"root", R"(\*[\w-]+)", {CH::NameVariable}, ""},
+  {"root", R"(![^\s]*)", {CH::KeywordType}, ""},
+  {"root", R"("(?:\\.|[^"\\])*"|'(?:''|[^'])*')", {CH::String}, ""},
+  {"root", R"([\w.-]+)", {CH::Text}, ""}
+};
+
+const QVector<RuleDef> SOURCESLIST_RULES = {
+  {"root", R"(#.*)", {CH::Comment}, ""},
+  {"root", R"(^(deb(?:-src)?)(\s+)(\[[^\]\n]*\])?(\s*)(\S+)(\s+))",
+   {CH::Keyword, CH::Text, CH::StringOther, CH::Text, CH::String, CH::Text},
+   "components"},
+  {"components", R"(#.*)", {CH::Comment}, "#pop"},
+  {"components", R"(\n)", {CH::Text}, "#pop"},
+  {"components", R"([ \t]+)", {CH::Text}, ""},
+  {"components", R"(\S+)", {CH::KeywordPseudo}, ""}
+};
+
+// Inline styles of the pygments default style
+const QHash<int, QString> STYLES = {
+  {CH::Comment, "color: #3D7B7B; font-style: italic"},
+  {CH::CommentPreproc, "color: #9C6500"},
+  {CH::Keyword, "color: #008000; font-weight: bold"},
+  {CH::KeywordPseudo, "color: #008000"},
+  {CH::KeywordType, "color: #B00040"},
+  {CH::Operator, "color: #666666"},
+  {CH::OperatorWord, "color: #AA22FF; font-weight: bold"},
+  {CH::NameAttribute, "color: #687822"},
+  {CH::NameBuiltin, "color: #008000"},
+  {CH::NameClass, "color: #0000FF; font-weight: bold"},
+  {CH::NameDecorator, "color: #AA22FF"},
+  {CH::NameEntity, "color: #717171; font-weight: bold"},
+  {CH::NameFunction, "color: #0000FF"},
+  {CH::NameLabel, "color: #767600"},
+  {CH::NameNamespace, "color: #0000FF; font-weight: bold"},
+  {CH::NameTag, "color: #008000; font-weight: bold"},
+  {CH::NameVariable, "color: #19177C"},
+  {CH::Number, "color: #666666"},
+  {CH::String, "color: #BA2121"},
+  {CH::StringDoc, "color: #BA2121; font-style: italic"},
+  {CH::StringEscape, "color: #AA5D1F; font-weight: bold"},
+  {CH::StringOther, "color: #008000"},
+  {CH::GenericDeleted, "color: #A00000"},
+  {CH::GenericHeading, "color: #000080; font-weight: bold"},
+  {CH::GenericInserted, "color: #008400"},
+  {CH::GenericStrong, "font-weight: bold"},
+  {CH::GenericSubheading, "color: #800080; font-weight: bold"}
+};
+}  // namespace
+
+CodeHighlighter::CodeHighlighter() = default;
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto CodeHighlighter::highlight(const QString &sLanguage,
+                                const QString &sCode,
+                                QString &sHtml) -> bool {
+  const QString sName(CodeHighlighter::getLanguageName(sLanguage));
+  if (sName.isEmpty()) {
+    return false;
+  }
+  if (!m_Lexers.contains(sName)) {
+    m_Lexers.insert(sName, CodeHighlighter::createLexer(sName));
+  }
+  const Lexer &lexer = m_Lexers[sName];
+
+  // Same as pygments options stripnl and ensurenl
+  QString sInput(sCode);
+  while (sInput.startsWith('\n')) {
+    sInput.remove(0, 1);
+  }
+  while (sInput.endsWith('\n')) {
+    sInput.chop(1);
+  }
+  sInput += '\n';
+
+  QList<QPair<Token, QString>> listTokens;
+  QStringList sListStates(QStringLiteral("root"));
+  int nPos = 0;
+  while (nPos < sInput.size()) {
+    bool bMatched = false;
+    const QVector<Rule> &rules = lexer.constFind(sListStates.last()).value();
+    for (const auto &rule : rules) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+      QRegularExpressionMatch match = rule.regexp.match(
+            sInput, nPos, QRegularExpression::NormalMatch,
+            QRegularExpression::AnchorAtOffsetMatchOption);
+#else
+      QRegularExpressionMatch match = rule.regexp.match(
+            sInput, nPos, QRegularExpression::NormalMatch,
+            QRegularExpression::AnchoredMatchOption);
+#endif
+      if (!match.hasMatch() || 0 == match.capturedLength()) {
+        continue;
+      }
+
+      if (1 == rule.listTokens.size()) {
+        listTokens << qMakePair(rule.listTokens[0], match.captured());
+      } else {
+        for (int i = 0; i < rule.listTokens.size(); i++) {
+          listTokens << qMakePair(rule.listTokens[i], match.captured(i + 1));
+        }
+      }
+      nPos += match.capturedLength();
+
+      if (QLatin1String("#pop") == rule.sNextState) {
+        if (sListStates.size() > 1) {
+          sListStates.removeLast();
+        }
+      } else if (!rule.sNextState.isEmpty()) {
+        sListStates << rule.sNextState;
+      }
+      bMatched = true;
+      break;
+    }
+
+    if (!bMatched) {
+      listTokens << qMakePair(Text, QString(sInput[nPos]));
+      nPos++;
+    }
+  }
+
+  // Like pygments, consecutive tokens of the same type share one span
+  sHtml.clear();
+  Token lastToken = Text;
+  QString sText;
+  for (const auto &token : qAsConst(listTokens)) {
+    if (token.first != lastToken) {
+      CodeHighlighter::appendToken(sHtml, lastToken, sText);
+      sText.clear();
+      lastToken = token.first;
+    }
+    sText += token.second;
+  }
+  CodeHighlighter::appendToken(sHtml, lastToken, sText);
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto CodeHighlighter::isSupported(const QString &sLanguage) -> bool {
+  return !CodeHighlighter::getLanguageName(sLanguage).isEmpty();
+}
+
+// ----------------------------------------------------------------------------
+
+auto CodeHighlighter::getLanguageName(const QString &sLanguage) -> QString {
+  static const QHash<QString, QString> ALIASES = {
+    {"bash", "bash"}, {"sh", "bash"}, {"ksh", "bash"}, {"zsh", "bash"},
+    {"shell", "bash"},
+    {"python", "python"}, {"py", "python"}, {"python3", "python"},
+    {"py3", "python"},
+    {"c", "cpp"}, {"cpp", "cpp"}, {"c++", "cpp"}, {"cxx", "cpp"},
+    {"h", "cpp"}, {"hpp", "cpp"},
+    {"ini", "ini"}, {"cfg", "ini"}, {"dosini", "ini"},
+    {"diff", "diff"}, {"udiff", "diff"}, {"patch", "diff"},
+    {"xml", "xml"},
+    {"yaml", "yaml"}, {"yml", "yaml"},
+    {"sourceslist", "sourceslist"}, {"sources.list", "sourceslist"},
+    {"debsources", "sourceslist"}
+  };
+  return ALIASES.value(sLanguage.trimmed().toLower());
+}
+
+// ----------------------------------------------------------------------------
+
+auto CodeHighlighter::createLexer(const QString &sName) -> Lexer {
+  const QVector<RuleDef> *pRules;
+  if ("bash" == sName) {
+    pRules = &BASH_RULES;
+  } else if ("python" == sName) {
+    pRules = &PYTHON_RULES;
+  } else if ("cpp" == sName) {
+    pRules = &CPP_RULES;
+  } else if ("ini" == sName) {
+    pRules = &INI_RULES;
+  } else if ("diff" == sName) {
+    pRules = &DIFF_RULES;
+  } else if ("xml" == sName) {
+    pRules = &XML_RULES;
+  } else if ("yaml" == sName) {
+    pRules = &YAML_RULES;
+  } else {
+    pRules = &SOURCESLIST_RULES;
+  }
+
+  Lexer lexer;
+  for (const auto &def : *pRules) {
+    Rule rule;
+    rule.regexp.setPattern(def.sPattern);
+    rule.regexp.setPatternOptions(QRegularExpression::MultilineOption);
+    rule.regexp.optimize();
+    rule.listTokens = def.listTokens;
+    rule.sNextState = def.sNextState;
+    lexer[def.sState] << rule;
+  }
+  return lexer;
+}
+
+// ----------------------------------------------------------------------------
+
+// Multi-line tokens get one span per line (same as pygments)
+void CodeHighlighter::appendToken(QString &sHtml, const Token token,
+                                  const QString &sText) {
+  if (sText.isEmpty()) {
+    return;
+  }
+
+  QString sEscaped(sText.toHtmlEscaped());
+  sEscaped.replace('\'', QLatin1String("&#39;"));
+  if (Text == token) {
+    sHtml += sEscaped;
+    return;
+  }
+
+  const QString sStyle(STYLES.value(token));
+  const QStringList sListLines(sEscaped.split('\n'));
+  for (int i = 0; i < sListLines.size(); i++) {
+    if (!sListLines[i].isEmpty()) {
+      sHtml += "<span style=\"" + sStyle + "\">" + sListLines[i] + "</span>";
+    }
+    if (i < sListLines.size() - 1) {
+      sHtml += '\n';
+    }
+  }
+}
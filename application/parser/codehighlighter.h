@@ -0,0 +1,77 @@
+/**
+ * \file codehighlighter.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for built-in code block highlighter.
+ */
+
+#ifndef APPLICATION_PARSER_CODEHIGHLIGHTER_H_
+#define APPLICATION_PARSER_CODEHIGHLIGHTER_H_
+
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+/**
+ * \class CodeHighlighter
+ * \brief Table driven lexer producing pygments compatible HTML.
+ *
+ * Output matches "pygmentize -f html -O nowrap -O noclasses" with the
+ * pygments default style.
+ */
+class CodeHighlighter {
+ public:
+    CodeHighlighter();
+
+    auto highlight(const QString &sLanguage, const QString &sCode,
+                   QString &sHtml) -> bool;
+    static auto isSupported(const QString &sLanguage) -> bool;
+
+    // Subset of pygments token types
+    enum Token {
+      Text, Comment, CommentPreproc, Keyword, KeywordPseudo, KeywordType,
+      Operator, OperatorWord, NameAttribute, NameBuiltin, NameClass,
+      NameDecorator, NameEntity, NameFunction, NameLabel, NameNamespace,
+      NameTag, NameVariable, Number, String, StringDoc, StringEscape,
+      StringOther, GenericDeleted, GenericHeading, GenericInserted,
+      GenericStrong, GenericSubheading
+    };
+
+ private:
+    struct Rule {
+      QRegularExpression regexp;
+      QList<Token> listTokens;  // Whole match or one token per group
+      QString sNextState;       // Empty, "#pop" or state to be pushed
+    };
+    typedef QHash<QString, QVector<Rule>> Lexer;
+
+    static auto getLanguageName(const QString &sLanguage) -> QString;
+    static auto createLexer(const QString &sName) -> Lexer;
+    static void appendToken(QString &sHtml, const Token token,
+                            const QString &sText);
+
+    QHash<QString, Lexer> m_Lexers;
+};
+
+#endif  // APPLICATION_PARSER_CODEHIGHLIGHTER_H_
@@ -0,0 +1,264 @@
+/**
+ * \file imagesizecache.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Image dimensions from the image header without decoding the image.
+ */
+
+#include "./imagesizecache.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QThreadStorage>
+#include <QtEndian>
+
+namespace {
+struct ImageInfo {
+  QDateTime lastModified;
+  qint64 nFileSize;  // -1 if the file does not exist
+  QSize size;
+  quint32 nValidated;  // Parsing run of last check on disk
+};
+
+const int MAX_CACHED_IMAGES = 4096;  // Least recently used are dropped
+
+QMutex g_Mutex;
+QCache<QString, ImageInfo> g_Cache(MAX_CACHED_IMAGES);
+quint32 g_nLastRun = 0;
+// Run of the parser in this thread; runs of parallel parsers (e.g. batch
+// rendering) do not invalidate each other's checks
+QThreadStorage<quint32> g_nRun;
+ImageSizeCache::SizeReader g_FallbackReader = nullptr;
+
+auto bytesAt(const QByteArray &ba, const int nPos) -> const uchar * {
+  return reinterpret_cast<const uchar *>(ba.constData()) + nPos;
+}
+
+auto be16(const QByteArray &ba, const int nPos) -> int {
+  return qFromBigEndian<quint16>(bytesAt(ba, nPos));
+}
+
+auto le16(const QByteArray &ba, const int nPos) -> int {
+  return qFromLittleEndian<quint16>(bytesAt(ba, nPos));
+}
+
+auto le24(const QByteArray &ba, const int nPos) -> int {
+  return le16(ba, nPos) | (static_cast<uchar>(ba.at(nPos + 2)) << 16);
+}
+
+auto jpegSize(QFile &file) -> QSize {
+  file.seek(2);
+  while (!file.atEnd()) {
+    QByteArray ba(file.read(2));
+    if (ba.size() < 2 || '\xFF' != ba.at(0)) {
+      break;
+    }
+    const auto cMarker = static_cast<uchar>(ba.at(1));
+    if (0xFF == cMarker) {  // Fill byte
+      file.seek(file.pos() - 1);
+      continue;
+    }
+    if (0x01 == cMarker || (cMarker >= 0xD0 && cMarker <= 0xD7)) {
+      continue;  // Markers without segment
+    }
+    if (0xD9 == cMarker || 0xDA == cMarker) {  // End of image / start of scan
+      break;
+    }
+    ba = file.read(7);
+    if (ba.size() < 2) {
+      break;
+    }
+    // Start of frame (all types except DHT, JPG and DAC)
+    if (cMarker >= 0xC0 && cMarker <= 0xCF &&
+        0xC4 != cMarker && 0xC8 != cMarker && 0xCC != cMarker) {
+      if (ba.size() < 7) {
+        break;
+      }
+      return QSize(be16(ba, 5), be16(ba, 3));
+    }
+    file.seek(file.pos() - ba.size() + be16(ba, 0));
+  }
+  return QSize();
+}
+
+auto svgLength(const QString &sValue) -> int {
+  static const QRegularExpression regexp(
+        QStringLiteral("^\\s*([0-9]*\\.?[0-9]+)\\s*(px)?\\s*$"));
+  const QRegularExpressionMatch match(regexp.match(sValue));
+  return match.hasMatch() ? qRound(match.captured(1).toDouble()) : -1;
+}
+
+auto svgSize(const QByteArray &baHeader) -> QSize {
+  static const QRegularExpression regexpSvg(
+        QStringLiteral("<svg\\b[^>]*>"));
+  static const QRegularExpression regexpAttr(
+        QStringLiteral("\\b(width|height|viewBox)\\s*=\\s*"
+                       "[\"']([^\"']*)[\"']"));
+  const QRegularExpressionMatch match(
+        regexpSvg.match(QString::fromUtf8(baHeader)));
+  if (!match.hasMatch()) {
+    return QSize();
+  }
+
+  int nWidth = -1;
+  int nHeight = -1;
+  QStringList sListViewBox;
+  auto it = regexpAttr.globalMatch(match.captured(0));
+  while (it.hasNext()) {
+    const QRegularExpressionMatch attr(it.next());
+    if (QLatin1String("width") == attr.captured(1)) {
+      nWidth = svgLength(attr.captured(2));
+    } else if (QLatin1String("height") == attr.captured(1)) {
+      nHeight = svgLength(attr.captured(2));
+    } else {
+      sListViewBox = attr.captured(2).simplified().split(
+                       QRegularExpression(QStringLiteral("[ ,]+")));
+    }
+  }
+  // Relative sizes (e.g. 100%) fall back to the view box
+  if ((nWidth < 0 || nHeight < 0) && 4 == sListViewBox.size()) {
+    nWidth = qRound(sListViewBox[2].toDouble());
+    nHeight = qRound(sListViewBox[3].toDouble());
+  }
+  return QSize(nWidth, nHeight);
+}
+
+// Only the image header is read; supported are PNG, JPEG, GIF, BMP, WebP
+// and SVG (if width/height or viewBox is given)
+auto readHeaderSize(const QString &sPath) -> QSize {
+  QFile file(sPath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QSize();
+  }
+  const QByteArray baHeader(file.peek(4096));
+
+  if (baHeader.startsWith("\x89PNG\r\n\x1A\n") && baHeader.size() >= 24) {
+    return QSize(qFromBigEndian<qint32>(bytesAt(baHeader, 16)),
+                 qFromBigEndian<qint32>(bytesAt(baHeader, 20)));
+  }
+  if (baHeader.startsWith("\xFF\xD8")) {
+    return jpegSize(file);
+  }
+  if ((baHeader.startsWith("GIF87a") || baHeader.startsWith("GIF89a")) &&
+      baHeader.size() >= 10) {
+    return QSize(le16(baHeader, 6), le16(baHeader, 8));
+  }
+  if (baHeader.startsWith("BM") && baHeader.size() >= 26) {
+    // Negative height for top-down bitmaps
+    return QSize(qFromLittleEndian<qint32>(bytesAt(baHeader, 18)),
+                 qAbs(qFromLittleEndian<qint32>(bytesAt(baHeader, 22))));
+  }
+  if (baHeader.startsWith("RIFF") && baHeader.mid(8, 4) == "WEBP" &&
+      baHeader.size() >= 30) {
+    const QByteArray baChunk(baHeader.mid(12, 4));
+    if ("VP8 " == baChunk) {  // Lossy
+      return QSize(le16(baHeader, 26) & 0x3FFF, le16(baHeader, 28) & 0x3FFF);
+    }
+    if ("VP8L" == baChunk) {  // Lossless
+      const quint32 nBits = qFromLittleEndian<quint32>(bytesAt(baHeader, 21));
+      return QSize(static_cast<int>(nBits & 0x3FFF) + 1,
+                   static_cast<int>((nBits >> 14) & 0x3FFF) + 1);
+    }
+    if ("VP8X" == baChunk) {  // Extended
+      return QSize(le24(baHeader, 24) + 1, le24(baHeader, 27) + 1);
+    }
+    return QSize();
+  }
+  return svgSize(baHeader);
+}
+
+auto readImageSize(const QString &sPath,
+                   ImageSizeCache::SizeReader fallbackReader) -> QSize {
+  const QSize size(readHeaderSize(sPath));
+  if (!size.isValid() && nullptr != fallbackReader) {
+    return fallbackReader(sPath);
+  }
+  return size;
+}
+}  // namespace
+
+auto ImageSizeCache::size(const QString &sPath) -> QSize {
+  const quint32 nRun = g_nRun.localData();
+  ImageInfo cached;
+  bool bCached = false;
+  SizeReader fallbackReader;
+  {
+    QMutexLocker locker(&g_Mutex);
+    const ImageInfo *pInfo = g_Cache.object(sPath);
+    // Already checked on disk in this run, no stat needed
+    if (nullptr != pInfo && 0 != nRun && nRun == pInfo->nValidated) {
+      return pInfo->size;
+    }
+    if (nullptr != pInfo) {
+      cached = *pInfo;
+      bCached = true;
+    }
+    fallbackReader = g_FallbackReader;
+  }
+
+  // Files are accessed without lock, parallel parsers (e.g. batch
+  // rendering) do not wait for each other's image I/O
+  auto *pInfo = new ImageInfo;
+  const QFileInfo fi(sPath);
+  if (!fi.exists()) {
+    // Cached as well, missing images are checked once per run, too
+    pInfo->nFileSize = -1;
+    pInfo->size = QSize(0, 0);
+  } else {
+    pInfo->lastModified = fi.lastModified();
+    pInfo->nFileSize = fi.size();
+    if (bCached && cached.lastModified == pInfo->lastModified &&
+        cached.nFileSize == pInfo->nFileSize) {
+      pInfo->size = cached.size;
+    } else {
+      pInfo->size = readImageSize(sPath, fallbackReader);
+      if (!pInfo->size.isValid()) {
+        pInfo->size = QSize(0, 0);
+      }
+    }
+  }
+  pInfo->nValidated = nRun;
+  const QSize size(pInfo->size);
+
+  QMutexLocker locker(&g_Mutex);
+  g_Cache.insert(sPath, pInfo);  // Takes ownership
+  return size;
+}
+
+// ----------------------------------------------------------------------------
+
+void ImageSizeCache::setFallbackReader(SizeReader reader) {
+  QMutexLocker locker(&g_Mutex);
+  g_FallbackReader = reader;
+}
+
+// ----------------------------------------------------------------------------
+
+void ImageSizeCache::startValidation() {
+  QMutexLocker locker(&g_Mutex);
+  g_nRun.setLocalData(++g_nLastRun);
+}
@@ -0,0 +1,57 @@
+/**
+ * \file imagesizecache.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for image size cache.
+ */
+
+#ifndef APPLICATION_PARSER_IMAGESIZECACHE_H_
+#define APPLICATION_PARSER_IMAGESIZECACHE_H_
+
+#include <QSize>
+#include <QString>
+
+/**
+ * \class ImageSizeCache
+ * \brief Thread-safe cache of image dimensions.
+ *
+ * Sizes are read from the image header and keyed by path, modification
+ * time and file size. Each image is checked on disk at most once per
+ * parsing run of a thread (see startValidation()); further lookups in
+ * the same run are served without a stat. The number of cached images
+ * is bounded, least recently used entries are dropped first. Files are
+ * read without holding the cache lock.
+ */
+class ImageSizeCache {
+ public:
+    // Reads the size of formats not supported by the cache itself (e.g.
+    // with QImageReader, which is not available in the parser library)
+    using SizeReader = QSize (*)(const QString &sPath);
+
+    static auto size(const QString &sPath) -> QSize;
+    // Has to be set before parsing, if at all (see imagesizereader.h)
+    static void setFallbackReader(SizeReader reader);
+    // Has to be called before each parsing run in the parsing thread
+    static void startValidation();
+};
+
+#endif  // APPLICATION_PARSER_IMAGESIZECACHE_H_
@@ -0,0 +1,41 @@
+/**
+ * \file imagesizereader.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Image size fallback reader for binaries linking Qt GUI.
+ */
+
+#ifndef APPLICATION_PARSER_IMAGESIZEREADER_H_
+#define APPLICATION_PARSER_IMAGESIZEREADER_H_
+
+#include <QImageReader>
+#include <QSize>
+#include <QString>
+
+// Header only, since the parser library does not link Qt GUI. The parser
+// library is static, thus every binary creating a parser (application,
+// plugins) has its own ImageSizeCache and has to set this reader itself.
+inline auto readImageSize(const QString &sPath) -> QSize {
+  return QImageReader(sPath).size();
+}
+
+#endif  // APPLICATION_PARSER_IMAGESIZEREADER_H_
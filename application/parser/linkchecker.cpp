@@ -0,0 +1,125 @@
+/**
+ * \file linkchecker.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Check existence of linked wiki pages in the background.
+ */
+
+#include "./linkchecker.h"
+
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+
+namespace {
+const int MAX_PARALLEL_REQUESTS = 6;
+const qint64 CACHE_TTL = 10 * 60 * 1000;  // Milliseconds
+const char PROPERTY_URL[] = "pageUrl";
+}  // namespace
+
+LinkChecker::LinkChecker(QObject *pParent)
+  : QObject(pParent),
+    m_nRunning(0) {
+  m_pNwManager = new QNetworkAccessManager(this);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto LinkChecker::getState(const QString &sPageUrl) -> LinkState {
+  auto it = m_Cache.constFind(sPageUrl);
+  if (m_Cache.constEnd() != it &&
+      QDateTime::currentMSecsSinceEpoch() - it->nCheckedAt < CACHE_TTL) {
+    return it->state;
+  }
+
+  if (!m_setPending.contains(sPageUrl)) {
+    m_setPending << sPageUrl;
+    m_sListQueue << sPageUrl;
+    // Requests are sent as soon as the event loop is running again
+    this->startRequests();
+  }
+
+  // Expired result is still better than nothing until refreshed
+  if (m_Cache.constEnd() != it) {
+    return it->state;
+  }
+  return Unknown;
+}
+
+// ----------------------------------------------------------------------------
+
+void LinkChecker::clear() {
+  m_Cache.clear();
+  m_sListQueue.clear();
+  m_setPending.clear();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void LinkChecker::startRequests() {
+  while (m_nRunning < MAX_PARALLEL_REQUESTS && !m_sListQueue.isEmpty()) {
+    const QString sPageUrl(m_sListQueue.takeFirst());
+    QNetworkReply *pReply = m_pNwManager->get(
+                              QNetworkRequest(
+                                QUrl(sPageUrl + "/a/export/meta/")));
+    pReply->setProperty(PROPERTY_URL, sPageUrl);
+    connect(pReply, &QNetworkReply::finished,
+            this, &LinkChecker::replyFinished);
+    m_nRunning++;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void LinkChecker::replyFinished() {
+  auto *pReply = qobject_cast<QNetworkReply *>(this->sender());
+  if (nullptr == pReply) {
+    return;
+  }
+  m_nRunning--;
+  const QString sPageUrl(pReply->property(PROPERTY_URL).toString());
+
+  // Without HTTP status the server could not be reached at all, thus
+  // the page state stays unknown and will be checked again next time
+  if (m_setPending.remove(sPageUrl) &&
+      pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid()) {
+    const LinkState state = (QNetworkReply::NoError == pReply->error()) ?
+                              Exists : Missing;
+    const bool bWasMissing = (m_Cache.contains(sPageUrl) &&
+                              Missing == m_Cache[sPageUrl].state);
+    CheckedLink link;
+    link.state = state;
+    link.nCheckedAt = QDateTime::currentMSecsSinceEpoch();
+    m_Cache.insert(sPageUrl, link);
+
+    if (bWasMissing != (Missing == state)) {
+      emit this->linkStateChanged(sPageUrl, Missing == state);
+    }
+  }
+
+  pReply->deleteLater();
+  this->startRequests();
+}
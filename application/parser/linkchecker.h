@@ -0,0 +1,82 @@
+/**
+ * \file linkchecker.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for wiki link checker.
+ */
+
+#ifndef APPLICATION_PARSER_LINKCHECKER_H_
+#define APPLICATION_PARSER_LINKCHECKER_H_
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QNetworkAccessManager;
+
+/**
+ * \class LinkChecker
+ * \brief Asynchronous existence check of Inyoka wiki pages.
+ *
+ * Results are cached for a limited time. Unknown pages are queued and
+ * checked in the background with a limited number of parallel requests.
+ */
+class LinkChecker : public QObject {
+  Q_OBJECT
+
+ public:
+    explicit LinkChecker(QObject *pParent = nullptr);
+
+    enum LinkState {
+      Unknown,
+      Exists,
+      Missing
+    };
+
+    // Returns cached state; queues a check if not cached or expired
+    auto getState(const QString &sPageUrl) -> LinkState;
+    void clear();
+
+ signals:
+    // Only emitted if the page has to be rendered differently now
+    void linkStateChanged(const QString &sPageUrl, const bool bMissing);
+
+ private slots:
+    void replyFinished();
+
+ private:
+    void startRequests();
+
+    struct CheckedLink {
+      LinkState state;
+      qint64 nCheckedAt;
+    };
+
+    QNetworkAccessManager *m_pNwManager;
+    QHash<QString, CheckedLink> m_Cache;
+    QStringList m_sListQueue;
+    QSet<QString> m_setPending;  // Queued or running
+    int m_nRunning;
+};
+
+#endif  // APPLICATION_PARSER_LINKCHECKER_H_
@@ -30,18 +30,22 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
-#include <QMessageBox>
-#include <QTextDocument>
+#include <QLocale>
+#include <QSize>
+#include <QTextStream>
+
+#include "./imagesizecache.h"
+#include "./regexpregistry.h"
 
 Macros::Macros(const QString &sSharePath,
                const QDir &tmpImgDir)
   : m_sSharePath(sSharePath),
     m_tmpImgDir(tmpImgDir) {
+  // Resources of the static parser library have to be registered manually
+  Q_INIT_RESOURCE(libinyokaparser);
   QFile fiMacros(QStringLiteral(":/macros.conf"));
   if (!fiMacros.open(QIODevice::ReadOnly)) {
     qWarning() << "Could not open macros.conf";
-    QMessageBox::warning(nullptr, QStringLiteral("Error"),
-                         QStringLiteral("Could not open macros.conf"));
   } else {
     QTextStream in(&fiMacros);
     in.setCodec("UTF-8");
@@ -59,8 +63,11 @@ Macros::Macros(const QString &sSharePath,
           tmpMacro.translations.clear();
           const QStringList tmpList2(tmpList[1].split(QStringLiteral(",")));
           if ("Template" != tmpMacro.name) {
+            tmpMacro.regexps.clear();
             for (const auto &s : tmpList2) {
               tmpMacro.translations << s.trimmed();
+              tmpMacro.regexps << Macros::createRegExp(tmpMacro.name,
+                                                       s.trimmed());
             }
             m_listMacros << tmpMacro;
           } else {
@@ -75,29 +82,57 @@ Macros::Macros(const QString &sSharePath,
   }
 }
 
+// ----------------------------------------------------------------------------
+
+// Compiled once per translation of a macro
+auto Macros::createRegExp(const QString &sName,
+                          const QString &sTrans) -> QRegularExpression {
+  if ("Anchor" == sName) {
+    return RegExpRegistry::get(
+          "\\[{2,2}\\b(" + sTrans + ")\\([A-Za-z_\\s0-9-]+\\)\\]{2,2}");
+  }
+  if ("Picture" == sName) {
+    return RegExpRegistry::get(
+          "\\[\\[" + sTrans + "\\(.+\\)\\]\\]",
+          QRegularExpression::InvertedGreedinessOption |
+          QRegularExpression::DotMatchesEverythingOption);
+  }
+  if ("Newline" == sName) {
+    return QRegularExpression();  // Replaced without regular expression
+  }
+  return RegExpRegistry::get(
+        "\\[\\[" + sTrans + "\\(.*\\)\\]\\]",
+        QRegularExpression::CaseInsensitiveOption |
+        QRegularExpression::InvertedGreedinessOption |
+        QRegularExpression::DotMatchesEverythingOption);
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::startParsing(QTextDocument *pRawDoc,
+void Macros::startParsing(QString &sDoc,
                           const QString &sCurrentFile,
                           const QString &sCommunity,
                           QStringList &sListHeadlines) {
+  m_UsedImageSizes.clear();
   for (const auto &macro : qAsConst(m_listMacros)) {
-    for (const auto &s : macro.translations) {
+    for (int i = 0; i < macro.translations.size(); i++) {
+      const QString &s(macro.translations.at(i));
+      const QRegularExpression &regexp(macro.regexps.at(i));
       if ("Anchor" == macro.name) {
-        Macros::replaceAnchors(pRawDoc, s);
+        Macros::replaceAnchors(sDoc, s, regexp);
       } else if ("Attachment" == macro.name) {
-        Macros::replaceAttachments(pRawDoc, s);
+        Macros::replaceAttachments(sDoc, s, regexp);
       } else if ("Date" == macro.name) {
-        Macros::replaceDates(pRawDoc, s);
+        Macros::replaceDates(sDoc, s, regexp);
       } else if ("Newline" == macro.name) {
-        Macros::replaceNewline(pRawDoc, s);
+        Macros::replaceNewline(sDoc, s);
       } else if ("Picture" == macro.name) {
-        this->replacePictures(pRawDoc, s, sCurrentFile, sCommunity);
+        this->replacePictures(sDoc, s, regexp, sCurrentFile, sCommunity);
       } else if ("TableOfContents" == macro.name) {
-        Macros::replaceTableOfContents(pRawDoc, s, sListHeadlines);
+        Macros::replaceTableOfContents(sDoc, s, regexp, sListHeadlines);
       } else if ("Span" == macro.name) {
-        Macros::replaceSpan(pRawDoc, s);
+        Macros::replaceSpan(sDoc, s, regexp);
       } else {
         qWarning() << "Unknown macro:" << macro.name;
       }
@@ -112,18 +147,37 @@ auto Macros::getTplTranslations() const -> QStringList {
   return m_sListTplTranslations;
 }
 
+auto Macros::getUsedImageSizes() const -> QHash<QString, QSize> {
+  return m_UsedImageSizes;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto Macros::hasTableOfContents(const QString &sDoc) const -> bool {
+  for (const auto &macro : qAsConst(m_listMacros)) {
+    if ("TableOfContents" == macro.name) {
+      for (const auto &s : macro.translations) {
+        if (sDoc.contains("[[" + s + "(", Qt::CaseInsensitive)) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceAnchors(QTextDocument *pRawDoc, const QString &sTrans) {
-  QRegExp regex("\\[{2,2}\\b(" + sTrans + ")\\([A-Za-z_\\s-0-9]+\\)\\]{2,2}");
-  QString sDoc(pRawDoc->toPlainText());
+void Macros::replaceAnchors(QString &sDoc, const QString &sTrans,
+                            const QRegularExpression &regex) {
+  QRegularExpressionMatch match(RegExpRegistry::match(regex, sDoc));
   int nIndex;
 
-  nIndex = regex.indexIn(sDoc);
-  while (nIndex >= 0) {
-    int nLength = regex.matchedLength();
-    QString sAnchor = regex.cap();
+  while ((nIndex = match.capturedStart()) >= 0) {
+    int nLength = match.capturedLength();
+    QString sAnchor = match.captured();
     // qDebug() << sAnchor;
 
     sAnchor.remove("[[" + sTrans + "(");
@@ -143,25 +197,22 @@ void Macros::replaceAnchors(QTextDocument *pRawDoc, const QString &sTrans) {
                  "<a id=\"" + sAnchor + "\" href=\"#" + sAnchor
                  + "\" class=\"crosslink anchor\"> </a>");
     // Go on with RegExp-Search
-    nIndex = regex.indexIn(sDoc, nIndex + nLength);
+    match = RegExpRegistry::match(regex, sDoc, nIndex + nLength);
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceAttachments(QTextDocument *pRawDoc, const QString &sTrans) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sRegExp("\\[\\[" + sTrans + "\\(.*\\)\\]\\]");
-  QRegExp findMacro(sRegExp, Qt::CaseInsensitive);
-  findMacro.setMinimal(true);
+void Macros::replaceAttachments(QString &sDoc, const QString &sTrans,
+                                const QRegularExpression &findMacro) {
   QString sMacro;
   int nPos = 0;
+  QRegularExpressionMatch match;
 
-  while ((nPos = findMacro.indexIn(sDoc, nPos)) != -1) {
-    sMacro = findMacro.cap(0);
+  while ((nPos = (match = RegExpRegistry::match(findMacro, sDoc,
+                                                nPos)).capturedStart()) != -1) {
+    sMacro = match.captured(0);
     sMacro.remove("[[" + sTrans + "(");
     sMacro.remove(QStringLiteral(")]]"));
     sMacro.remove('"');
@@ -169,29 +220,26 @@ void Macros::replaceAttachments(QTextDocument *pRawDoc, const QString &sTrans) {
     sMacro = "<a href=\"" + sMacro +
              "\" class=\"crosslink\">" + sMacro + "</a>";
 
-    sDoc.replace(nPos, findMacro.matchedLength(), sMacro);
+    sDoc.replace(nPos, match.capturedLength(), sMacro);
     // Go on with new start position
     nPos += sMacro.length();
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceDates(QTextDocument *pRawDoc, const QString &sTrans) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sRegExp("\\[\\[" + sTrans + "\\(.*\\)\\]\\]");
-  QRegExp findMacro(sRegExp, Qt::CaseInsensitive);
-  findMacro.setMinimal(true);
+void Macros::replaceDates(QString &sDoc, const QString &sTrans,
+                          const QRegularExpression &findMacro) {
   QString sMacro;
   QDateTime datetime;
   bool bConversionOk;
   int nPos = 0;
+  QRegularExpressionMatch match;
 
-  while ((nPos = findMacro.indexIn(sDoc, nPos)) != -1) {
-    sMacro = findMacro.cap(0);
+  while ((nPos = (match = RegExpRegistry::match(findMacro, sDoc,
+                                                nPos)).capturedStart()) != -1) {
+    sMacro = match.captured(0);
     sMacro.remove("[[" + sTrans + "(");
     sMacro.remove(QStringLiteral(")]]"));
 
@@ -209,29 +257,26 @@ void Macros::replaceDates(QTextDocument *pRawDoc, const QString &sTrans) {
       sMacro = QStringLiteral("Invalid date");
     }
 
-    sDoc.replace(nPos, findMacro.matchedLength(), sMacro);
+    sDoc.replace(nPos, match.capturedLength(), sMacro);
     // Go on with new start position
     nPos += sMacro.length();
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceNewline(QTextDocument *pRawDoc, const QString &sTrans) {
-  QString sDoc(pRawDoc->toPlainText());
+void Macros::replaceNewline(QString &sDoc, const QString &sTrans) {
   sDoc.replace("[[" + sTrans + "]]", QLatin1String("<br />"));
   sDoc.replace(QLatin1String("\\\\"), QLatin1String("<br />"));
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replacePictures(QTextDocument *pRawDoc,
+void Macros::replacePictures(QString &sDoc,
                              const QString &sTrans,
+                             const QRegularExpression &findImages,
                              const QString &sCurrentFile,
                              const QString &sCommunity) {
 #if defined _WIN32
@@ -239,8 +284,6 @@ void Macros::replacePictures(QTextDocument *pRawDoc,
 #else
   QString sExt(QLatin1String(""));
 #endif
-  QString sDoc(pRawDoc->toPlainText());
-  QRegExp findImages("\\[\\[" + sTrans + "\\(.+\\)\\]\\]");
   QStringList sListTmpImageInfo;
 
   QString sImagePath(QLatin1String(""));
@@ -249,17 +292,15 @@ void Macros::replacePictures(QTextDocument *pRawDoc,
     sImagePath = fiArticleFile.absolutePath();
   }
 
-  findImages.setMinimal(true);
-  int nIndex = findImages.indexIn(sDoc);
-  while (nIndex >= 0) {
-    int nLength = findImages.matchedLength();
-    QString sTmpImage = findImages.cap();
+  QRegularExpressionMatch match(RegExpRegistry::match(findImages, sDoc));
+  int nIndex;
+  while ((nIndex = match.capturedStart()) >= 0) {
+    int nLength = match.capturedLength();
+    QString sTmpImage = match.captured();
     sTmpImage.remove("[[" + sTrans + "(");
     sTmpImage.remove(QStringLiteral(")]]"));
 
     QString sImageAlign = QStringLiteral("default");
-    double iImgHeight = 0;
-    double iImgWidth = 0;
     double tmpH = 0;
     double tmpW = 0;
 
@@ -308,22 +349,21 @@ void Macros::replacePictures(QTextDocument *pRawDoc,
       }
     }
 
+    const QSize imgSize(ImageSizeCache::size(sImageUrl));
+    m_UsedImageSizes.insert(sImageUrl, imgSize);
+    const double iImgHeight = imgSize.height();
+    const double iImgWidth = imgSize.width();
+
     // No size given
     if (0.0 == tmpH && 0.0 == tmpW) {
-      iImgHeight = QImage(sImageUrl).height();
       tmpH = iImgHeight;
-      iImgWidth = QImage(sImageUrl).width();
       tmpW = iImgWidth;
     }
 
     if (tmpH > tmpW) {
-      iImgHeight = QImage(sImageUrl).height();
-      tmpW = static_cast<double>(QImage(sImageUrl).width()) /
-             (iImgHeight / static_cast<double>(tmpH));
+      tmpW = iImgWidth / (iImgHeight / tmpH);
     } else if (tmpW > tmpH) {
-      iImgWidth = QImage(sImageUrl).width();
-      tmpH = static_cast<double>(QImage(sImageUrl).height()) /
-             (iImgWidth / static_cast<double>(tmpW));
+      tmpH = iImgHeight / (iImgWidth / tmpW);
     }
 
     // HTML code
@@ -335,26 +375,24 @@ void Macros::replacePictures(QTextDocument *pRawDoc,
 
     sDoc.replace(nIndex, nLength, sTmpImage);
     // Go on with RegExp-Search
-    nIndex = findImages.indexIn(sDoc, nIndex + nLength);
+    match = RegExpRegistry::match(findImages, sDoc, nIndex + nLength);
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceTableOfContents(QTextDocument *pRawDoc,
+void Macros::replaceTableOfContents(QString &sDoc,
                                     const QString &sTrans,
+                                    const QRegularExpression &findMacro,
                                     QStringList &sListHeadlines) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sRegExp("\\[\\[" + sTrans + "\\(.*\\)\\]\\]");
-  QRegExp findMacro(sRegExp, Qt::CaseInsensitive);
-  findMacro.setMinimal(true);
+  static const QRegularExpression findLevel(
+        RegExpRegistry::get(QStringLiteral("#{1,5}\\d#{1,5}")));
   QString sMacro;
   QString sSpaces;
   QString sTmp;
   int nPos = 0;
+  QRegularExpressionMatch match;
   quint16 nTOCLevel;
   quint16 nCurrentLevel;
 
@@ -369,12 +407,12 @@ void Macros::replaceTableOfContents(QTextDocument *pRawDoc,
     sMacro.replace(QStringLiteral("ä"), QLatin1String("ae"));
     sMacro.replace(QStringLiteral("ü"), QLatin1String("ue"));
     sMacro.replace(QStringLiteral("ö"), QLatin1String("oe"));
-    sListHeadlines_Links << sMacro.remove(
-                              QRegExp(QLatin1String("#{1,5}\\d#{1,5}")));
+    sListHeadlines_Links << sMacro.remove(findLevel);
   }
 
-  while ((nPos = findMacro.indexIn(sDoc, nPos)) != -1) {
-    sMacro = findMacro.cap(0);
+  while ((nPos = (match = RegExpRegistry::match(findMacro, sDoc,
+                                                nPos)).capturedStart()) != -1) {
+    sMacro = match.captured(0);
     sMacro.remove("[[" + sTrans + "(");
     sMacro.remove(QStringLiteral(")]]"));
 
@@ -389,7 +427,7 @@ void Macros::replaceTableOfContents(QTextDocument *pRawDoc,
              sTrans + "</div>\n";
     for (int i = 0; i < sListHeadlines.size(); i++) {
       sTmp = sListHeadlines[i];
-      sTmp.remove(QRegExp(QLatin1String("#{1,5}\\d#{1,5}")));
+      sTmp.remove(findLevel);
       sListHeadlines[i].remove(
             sListHeadlines[i].length() - sTmp.length(),
             sTmp.length()).remove(QStringLiteral("#"));
@@ -406,30 +444,27 @@ void Macros::replaceTableOfContents(QTextDocument *pRawDoc,
     }
     sMacro += QLatin1String("\n</div>\n");
 
-    sDoc.replace(nPos, findMacro.matchedLength(), sMacro);
+    sDoc.replace(nPos, match.capturedLength(), sMacro);
     // Go on with new start position
     nPos += sMacro.length();
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Macros::replaceSpan(QTextDocument *pRawDoc, const QString &sTrans) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sRegExp("\\[\\[" + sTrans + "\\(.*\\)\\]\\]");
-  QRegExp findMacro(sRegExp, Qt::CaseInsensitive);
-  findMacro.setMinimal(true);
+void Macros::replaceSpan(QString &sDoc, const QString &sTrans,
+                         const QRegularExpression &findMacro) {
   QString sMacro;
   QStringList sArgs;
   QString sClass;
   QString sStyle;
   int nPos = 0;
+  QRegularExpressionMatch match;
 
-  while ((nPos = findMacro.indexIn(sDoc, nPos)) != -1) {
-    sMacro = findMacro.cap(0);
+  while ((nPos = (match = RegExpRegistry::match(findMacro, sDoc,
+                                                nPos)).capturedStart()) != -1) {
+    sMacro = match.captured(0);
     sMacro.remove("[[" + sTrans + "(");
     sMacro.remove(QStringLiteral(")]]"));
     sArgs.clear();
@@ -438,7 +473,7 @@ void Macros::replaceSpan(QTextDocument *pRawDoc, const QString &sTrans) {
 
     // Extract arguments
     // Split by ',' but don't split quoted strings with comma
-    const QStringList tmpList = sMacro.split(QRegExp(QLatin1String("\"")));
+    const QStringList tmpList = sMacro.split('"');
     bool bInside = false;
     for (const auto &s : tmpList) {
       if (bInside) {
@@ -447,9 +482,9 @@ void Macros::replaceSpan(QTextDocument *pRawDoc, const QString &sTrans) {
       } else {
         // If 's' is outside quotes, get the splitted string
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-        sArgs.append(s.split(QRegExp(",+"), QString::SkipEmptyParts));
+        sArgs.append(s.split(',', QString::SkipEmptyParts));
 #else
-        sArgs.append(s.split(QRegExp(QLatin1String(",+")), Qt::SkipEmptyParts));
+        sArgs.append(s.split(',', Qt::SkipEmptyParts));
 #endif
       }
       bInside = !bInside;
@@ -468,10 +503,8 @@ void Macros::replaceSpan(QTextDocument *pRawDoc, const QString &sTrans) {
     }
     sMacro = "<span" + sStyle + sClass + ">" + sMacro + "</span>";
 
-    sDoc.replace(nPos, findMacro.matchedLength(), sMacro);
+    sDoc.replace(nPos, match.capturedLength(), sMacro);
     // Go on with new start position
     nPos += sMacro.length();
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
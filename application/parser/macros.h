@@ -28,44 +28,59 @@
 #define APPLICATION_PARSER_MACROS_H_
 
 #include <QDir>
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QSize>
 #include <QString>
 #include <QStringList>
 
-class QTextDocument;
-
 struct MACRO {
   QString name;
   QStringList translations;
+  QList<QRegularExpression> regexps;  // One per translation
 };
 
 class Macros {
  public:
     Macros(const QString &sSharePath, const QDir &tmpImgDir);
-    void startParsing(QTextDocument *pRawDoc,
+    void startParsing(QString &sDoc,
                       const QString &sCurrentFile,
                       const QString &sCommunity,
                       QStringList &sListHeadlines);
     auto getTplTranslations() const -> QStringList;
+    // Images (and their sizes) used by the last startParsing() call
+    auto getUsedImageSizes() const -> QHash<QString, QSize>;
+    auto hasTableOfContents(const QString &sDoc) const -> bool;
 
  private:
-    static void replaceAnchors(QTextDocument *pRawDoc, const QString &sTrans);
-    static void replaceAttachments(QTextDocument *pRawDoc,
-                                   const QString &sTrans);
-    static void replaceDates(QTextDocument *pRawDoc, const QString &sTrans);
-    static void replaceNewline(QTextDocument *pRawDoc, const QString &sTrans);
-    void replacePictures(QTextDocument *pRawDoc,
+    static auto createRegExp(const QString &sName,
+                             const QString &sTrans) -> QRegularExpression;
+    static void replaceAnchors(QString &sDoc, const QString &sTrans,
+                               const QRegularExpression &regex);
+    static void replaceAttachments(QString &sDoc,
+                                   const QString &sTrans,
+                                   const QRegularExpression &findMacro);
+    static void replaceDates(QString &sDoc, const QString &sTrans,
+                             const QRegularExpression &findMacro);
+    static void replaceNewline(QString &sDoc, const QString &sTrans);
+    void replacePictures(QString &sDoc,
                          const QString &sTrans,
+                         const QRegularExpression &findImages,
                          const QString &sCurrentFile,
                          const QString &sCommunity);
-    static void replaceTableOfContents(QTextDocument *pRawDoc,
+    static void replaceTableOfContents(QString &sDoc,
                                        const QString &sTrans,
+                                       const QRegularExpression &findMacro,
                                        QStringList &sListHeadlines);
-    static void replaceSpan(QTextDocument *pRawDoc, const QString &sTrans);
+    static void replaceSpan(QString &sDoc, const QString &sTrans,
+                            const QRegularExpression &findMacro);
 
     const QString m_sSharePath;
     const QDir m_tmpImgDir;
     QList<MACRO> m_listMacros;
     QStringList m_sListTplTranslations;
+    QHash<QString, QSize> m_UsedImageSizes;
 };
 
 #endif  // APPLICATION_PARSER_MACROS_H_
@@ -26,29 +26,19 @@
 
 #include "./parseimgmap.h"
 
-#include <QDebug>
 #include <QString>
-#include <QTextDocument>
+
+#include "../templates/multireplacer.h"
 
 ParseImgMap::ParseImgMap() = default;
 
-void ParseImgMap::startParsing(QTextDocument *pRawDoc,
-                               QStringList sListElements,
-                               QStringList sListImages,
+void ParseImgMap::startParsing(QString &sDoc,
+                               const MultiReplacer &replacer,
+                               const QStringList &sListImages,
                                const QString &sSharePath,
                                const QString &sCommunity) {
-  QString sDoc(pRawDoc->toPlainText());
-
-  for (int i = 0; i < sListElements.size(); i++) {
-    if (0 == i && "error" == sListElements[0].toLower()) {
-      qCritical() << "Error while parsing image map.";
-      break;
-    }
-    sDoc.replace(sListElements[i],
-                 "<img src=\"" + sSharePath + "/community/" + sCommunity +
-                 "/" + sListImages[i] + "\" />");
-  }
-
-  // Replace raw document with new replaced doc
-  pRawDoc->setPlainText(sDoc);
+  replacer.replaceAll(sDoc, [&](const int nIndex) -> QString {
+    return "<img src=\"" + sSharePath + "/community/" + sCommunity +
+        "/" + sListImages.at(nIndex) + "\" />";
+  });
 }
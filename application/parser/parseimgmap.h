@@ -29,15 +29,16 @@
 
 #include <QStringList>
 
+class MultiReplacer;
 class QString;
-class QTextDocument;
 
 class ParseImgMap {
  public:
     ParseImgMap();
-    static void startParsing(QTextDocument *pRawDoc,
-                             QStringList sListElements,
-                             QStringList sListImages,
+    // Elements are found by replacer, sListImages contains their images
+    static void startParsing(QString &sDoc,
+                             const MultiReplacer &replacer,
+                             const QStringList &sListImages,
                              const QString &sSharePath,
                              const QString &sCommunity);
 };
@@ -25,23 +25,34 @@
  */
 
 // #include <QDebug>
-#include <QEventLoop>
-#include <QTextDocument>
 
 #include "./parselinks.h"
-#include "../utils.h"
+#include "./linkchecker.h"
+#include "./regexpregistry.h"
 
 ParseLinks::ParseLinks(const QString &sUrlToWiki,
                        const QStringList &sListIWiki,
                        const QStringList &sListIWikiUrl,
                        const bool bCheckLinks, QObject *pParent)
-  : m_sWikiUrl(sUrlToWiki),
+  : QObject(pParent),
+    m_sWikiUrl(sUrlToWiki),
     m_sListInterwikiKey(sListIWiki),
     m_sListInterwikiLink(sListIWikiUrl),
-    m_bCheckLinks(bCheckLinks),
-    m_NWreply(nullptr) {
-  Q_UNUSED(pParent)
-  m_NWAManager = new QNetworkAccessManager(this);
+    m_bCheckLinks(bCheckLinks) {
+  m_pLinkChecker = new LinkChecker(this);
+  connect(m_pLinkChecker, &LinkChecker::linkStateChanged,
+          this, &ParseLinks::linkStateChanged);
+
+  // Generate pattern
+  QString sPattern = QStringLiteral("\\[{1,1}\\b(");
+  for (int i = 0; i < m_sListInterwikiKey.size(); i++) {
+    sPattern += m_sListInterwikiKey[i];
+    if (i != m_sListInterwikiKey.size() -1) {
+      sPattern += QLatin1String("|");
+    }
+  }
+  sPattern += QLatin1String(")\\b:");
+  m_FindInterwikiLink = RegExpRegistry::get(sPattern);
 }
 
 // ----------------------------------------------------------------------------
@@ -49,6 +60,9 @@ ParseLinks::ParseLinks(const QString &sUrlToWiki,
 
 void ParseLinks::updateSettings(const QString &sUrlToWiki,
                                 const bool bCheckLinks) {
+  if (m_sWikiUrl != sUrlToWiki) {
+    m_pLinkChecker->clear();
+  }
   m_sWikiUrl = sUrlToWiki;
   m_bCheckLinks = bCheckLinks;
 }
@@ -56,29 +70,28 @@ void ParseLinks::updateSettings(const QString &sUrlToWiki,
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void ParseLinks::startParsing(QTextDocument *pRawDoc) {
-  ParseLinks::replaceHyperlinks(pRawDoc);
-  this->replaceInyokaWikiLinks(pRawDoc);
-  this->replaceInterwikiLinks(pRawDoc);
-  ParseLinks::replaceAnchorLinks(pRawDoc);
-  ParseLinks::replaceKnowledgeBoxLinks(pRawDoc);
+void ParseLinks::startParsing(QString &sDoc) {
+  ParseLinks::replaceHyperlinks(sDoc);
+  this->replaceInyokaWikiLinks(sDoc);
+  this->replaceInterwikiLinks(sDoc);
+  ParseLinks::replaceAnchorLinks(sDoc);
+  ParseLinks::replaceKnowledgeBoxLinks(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 // External links [https://www.ubuntu.com]
-void ParseLinks::replaceHyperlinks(QTextDocument *pRawDoc) {
-  QRegExp findHyperlink(
-        QString::fromLatin1("\\[{1,1}\\b(http|https|ftp|ftps|file|ssh|mms|svn"
-                            "|git|dict|nntp|irc|rsync|smb|apt)\\b://"));
-  QString sDoc(pRawDoc->toPlainText());
+void ParseLinks::replaceHyperlinks(QString &sDoc) {
+  static const QRegularExpression findHyperlink(RegExpRegistry::get(
+      QString::fromLatin1("\\[{1,1}\\b(http|https|ftp|ftps|file|ssh|mms|svn"
+                          "|git|dict|nntp|irc|rsync|smb|apt)\\b://")));
   int nIndex;
   int nLength;
   QString sLink;
   int nSpace;
 
-  nIndex = findHyperlink.indexIn(sDoc);
+  nIndex = RegExpRegistry::match(findHyperlink, sDoc).capturedStart();
   while (nIndex >= 0) {
     // Found end of link
     if (sDoc.indexOf(QLatin1String("]"), nIndex) != -1) {
@@ -106,30 +119,29 @@ void ParseLinks::replaceHyperlinks(QTextDocument *pRawDoc) {
       }
 
       // Go on with next
-      nIndex = findHyperlink.indexIn(sDoc, nIndex + nLength);
+      nIndex = RegExpRegistry::match(findHyperlink, sDoc,
+                                     nIndex + nLength).capturedStart();
     } else {
       // Skip not closed link and go on with next
-      nIndex = findHyperlink.indexIn(sDoc, nIndex + 1);
+      nIndex = RegExpRegistry::match(findHyperlink, sDoc,
+                                     nIndex + 1).capturedStart();
     }
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 // Inyoka wiki links [:Wikipage:]
-void ParseLinks::replaceInyokaWikiLinks(QTextDocument *pRawDoc) {
-  QRegExp findInyokaWikiLink(QLatin1String("\\[{1,1}\\:[0-9A-Za-z:.]"));
-  QString sDoc(pRawDoc->toPlainText());
+void ParseLinks::replaceInyokaWikiLinks(QString &sDoc) {
+  static const QRegularExpression findInyokaWikiLink(RegExpRegistry::get(
+      QStringLiteral("\\[{1,1}\\:[0-9A-Za-z:.]")));
   int nIndex;
   int nLength;
   QString sLink;
   QString sLinkURL;
-  bool bIsOnline(Utils::getOnlineState());
 
-  nIndex = findInyokaWikiLink.indexIn(sDoc);
+  nIndex = RegExpRegistry::match(findInyokaWikiLink, sDoc).capturedStart();
   while (nIndex >= 0) {
     // Found end of link
     if (sDoc.indexOf(QLatin1String("]"), nIndex) != -1) {
@@ -155,26 +167,10 @@ void ParseLinks::replaceInyokaWikiLinks(QTextDocument *pRawDoc) {
             sAnchor = " (" + tr("Section") + " \"" + sAnchor + "\")";
           }
 
-          m_sLinkClassAddition = QLatin1String("");
-          if (bIsOnline && m_bCheckLinks) {
-            m_NWreply = m_NWAManager->get(
-                          QNetworkRequest(
-                            QUrl(sLinkURL + "/a/export/meta/")));
-            QEventLoop loop;  // Workaround getting synchron reply
-            connect(m_NWreply, &QNetworkReply::finished,
-                    &loop, &QEventLoop::quit);
-            loop.exec();
-
-            if (QNetworkReply::NoError == m_NWreply->error()) {
-              m_sLinkClassAddition = QLatin1String("");
-            } else {
-              m_sLinkClassAddition = QStringLiteral(" missing");
-            }
-          }
           sDoc.replace(nIndex, nLength,
                        "<a href=\"" + sLinkURL
                        + "\" class=\"internal"
-                       + m_sLinkClassAddition + "\">"
+                       + this->getLinkClass(sLinkURL) + "\">"
                        + sLink2 + sAnchor + "</a>");
         } else {
           sLink.remove(QStringLiteral("]"));
@@ -183,66 +179,53 @@ void ParseLinks::replaceInyokaWikiLinks(QTextDocument *pRawDoc) {
           //          << sLink.mid(sLink.indexOf(":") + 1, nLength);
           sLinkURL = m_sWikiUrl + "/"
                      + sLink.mid(0, sLink.indexOf(QLatin1String(":")));
-          if (bIsOnline && m_bCheckLinks) {
-            m_NWreply = m_NWAManager->get(
-                          QNetworkRequest(
-                            QUrl(sLinkURL + "/a/export/meta/")));
-            QEventLoop loop;
-            connect(m_NWreply, &QNetworkReply::finished,
-                    &loop, &QEventLoop::quit);
-            loop.exec();
-
-            if (QNetworkReply::NoError == m_NWreply->error()) {
-              m_sLinkClassAddition = QLatin1String("");
-            } else {
-              m_sLinkClassAddition = QStringLiteral(" missing");
-            }
-          }
           sDoc.replace(nIndex, nLength,
                        "<a href=\"" + sLinkURL
                        + "\" class=\"internal"
-                       + m_sLinkClassAddition + "\">"
+                       + this->getLinkClass(sLinkURL) + "\">"
                        + sLink.mid(sLink.indexOf(QLatin1String(":"))
                                    + 1, nLength).trimmed() + "</a>");
         }
       }
 
       // Go on with next
-      nIndex = findInyokaWikiLink.indexIn(sDoc, nIndex + nLength);
+      nIndex = RegExpRegistry::match(findInyokaWikiLink, sDoc,
+                                     nIndex + nLength).capturedStart();
     } else {
       // Skip not closed link and go on with next
-      nIndex = findInyokaWikiLink.indexIn(sDoc, nIndex + 1);
+      nIndex = RegExpRegistry::match(findInyokaWikiLink, sDoc,
+                                     nIndex + 1).capturedStart();
     }
   }
+}
 
-  pRawDoc->setPlainText(sDoc);
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Links are rendered as existing until the check in background is done
+auto ParseLinks::getLinkClass(const QString &sLinkUrl) -> QString {
+  if (m_bCheckLinks) {
+    // Anchor is not part of the page
+    const QString sPageUrl(sLinkUrl.section('#', 0, 0));
+    if (LinkChecker::Missing == m_pLinkChecker->getState(sPageUrl)) {
+      return QStringLiteral(" missing");
+    }
+  }
+  return QLatin1String("");
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 // Interwiki links [wikipedia:Site:Text]
-void ParseLinks::replaceInterwikiLinks(QTextDocument *pRawDoc) {
-  QString sDoc(pRawDoc->toPlainText());
+void ParseLinks::replaceInterwikiLinks(QString &sDoc) {
   int nIndex;
   int nLength;
   QString sLink;
   QStringList sListLink;
   QString sClass;
 
-  // Generate pattern
-  QString sPattern = QStringLiteral("\\[{1,1}\\b(");
-  for (int i = 0; i < m_sListInterwikiKey.size(); i++) {
-    sPattern += m_sListInterwikiKey[i];
-    if (i != m_sListInterwikiKey.size() -1) {
-      sPattern += QLatin1String("|");
-    }
-  }
-  sPattern += QLatin1String(")\\b:");
-
-  QRegExp findInterwikiLink(sPattern);
-  // qDebug() << sPattern;
-  nIndex = findInterwikiLink.indexIn(sDoc);
+  nIndex = RegExpRegistry::match(m_FindInterwikiLink, sDoc).capturedStart();
   while (nIndex >= 0) {
     // Found end of link
     if (sDoc.indexOf(QLatin1String("]"), nIndex) != -1) {
@@ -298,29 +281,29 @@ void ParseLinks::replaceInterwikiLinks(QTextDocument *pRawDoc) {
       }
 
       // Go on with next
-      nIndex = findInterwikiLink.indexIn(sDoc, nIndex + nLength);
+      nIndex = RegExpRegistry::match(m_FindInterwikiLink, sDoc,
+                                     nIndex + nLength).capturedStart();
     } else {
       // Skip not closed link and go on with next
-      nIndex = findInterwikiLink.indexIn(sDoc, nIndex + 1);
+      nIndex = RegExpRegistry::match(m_FindInterwikiLink, sDoc,
+                                     nIndex + 1).capturedStart();
     }
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 // Anchor [#Headline Text]
-void ParseLinks::replaceAnchorLinks(QTextDocument *pRawDoc) {
-  QRegExp findAnchorLink(QLatin1String("\\[{1,1}\\#"));
-  QString sDoc(pRawDoc->toPlainText());
+void ParseLinks::replaceAnchorLinks(QString &sDoc) {
+  static const QRegularExpression findAnchorLink(RegExpRegistry::get(
+      QStringLiteral("\\[{1,1}\\#")));
   int nIndex;
   int nLength;
   QString sLink;
   int nSplit;
 
-  nIndex = findAnchorLink.indexIn(sDoc);
+  nIndex = RegExpRegistry::match(findAnchorLink, sDoc).capturedStart();
   while (nIndex >= 0) {
     // Found end of link
     if (sDoc.indexOf(QLatin1String("]"), nIndex) != -1) {
@@ -348,29 +331,30 @@ void ParseLinks::replaceAnchorLinks(QTextDocument *pRawDoc) {
       }
 
       // Go on with next
-      nIndex = findAnchorLink.indexIn(sDoc, nIndex + nLength);
+      nIndex = RegExpRegistry::match(findAnchorLink, sDoc,
+                                     nIndex + nLength).capturedStart();
     } else {
       // Skip not closed link and go on with next
-      nIndex = findAnchorLink.indexIn(sDoc, nIndex + 1);
+      nIndex = RegExpRegistry::match(findAnchorLink, sDoc,
+                                     nIndex + 1).capturedStart();
     }
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
 // Link to knowledge box entry
-void ParseLinks::replaceKnowledgeBoxLinks(QTextDocument *pRawDoc) {
-  QRegExp findKnowledgeBoxLink(QLatin1String("\\[{1,1}[0-9]{1,}\\]{1,1}"));
-  QString sDoc(pRawDoc->toPlainText());
+void ParseLinks::replaceKnowledgeBoxLinks(QString &sDoc) {
+  static const QRegularExpression findKnowledgeBoxLink(RegExpRegistry::get(
+      QStringLiteral("\\[{1,1}[0-9]{1,}\\]{1,1}")));
+  QRegularExpressionMatch match(
+        RegExpRegistry::match(findKnowledgeBoxLink, sDoc));
   int nIndex;
 
-  nIndex = findKnowledgeBoxLink.indexIn(sDoc);
-  while (nIndex >= 0) {
-    int nLength = findKnowledgeBoxLink.matchedLength();
-    QString sLink = findKnowledgeBoxLink.cap();
+  while ((nIndex = match.capturedStart()) >= 0) {
+    int nLength = match.capturedLength();
+    QString sLink = match.captured();
     // qDebug() << sLink;
 
     sLink.remove(QStringLiteral("["));
@@ -383,8 +367,7 @@ void ParseLinks::replaceKnowledgeBoxLinks(QTextDocument *pRawDoc) {
     }
 
     // Go on with next
-    nIndex = findKnowledgeBoxLink.indexIn(sDoc, nIndex + nLength);
+    match = RegExpRegistry::match(findKnowledgeBoxLink, sDoc,
+                                  nIndex + nLength);
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
@@ -27,11 +27,11 @@
 #ifndef APPLICATION_PARSER_PARSELINKS_H_
 #define APPLICATION_PARSER_PARSELINKS_H_
 
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
+#include <QObject>
+#include <QRegularExpression>
 #include <QStringList>
 
-class QTextDocument;
+class LinkChecker;
 
 /**
  * \class ParseLinks
@@ -47,26 +47,29 @@ class ParseLinks : public QObject {
                const bool bCheckLinks,
                QObject *pParent = nullptr);
 
-    void startParsing(QTextDocument *pRawDoc);
+    void startParsing(QString &sDoc);
 
  public slots:
     void updateSettings(const QString &sUrlToWiki, const bool bCheckLinks);
 
+ signals:
+    void linkStateChanged(const QString &sPageUrl, const bool bMissing);
+
  private:
-    static void replaceHyperlinks(QTextDocument *pRawDoc);
-    void replaceInyokaWikiLinks(QTextDocument *pRawDoc);
-    void replaceInterwikiLinks(QTextDocument *pRawDoc);
-    static void replaceAnchorLinks(QTextDocument *pRawDoc);
-    static void replaceKnowledgeBoxLinks(QTextDocument *pRawDoc);
+    static void replaceHyperlinks(QString &sDoc);
+    void replaceInyokaWikiLinks(QString &sDoc);
+    auto getLinkClass(const QString &sLinkUrl) -> QString;
+    void replaceInterwikiLinks(QString &sDoc);
+    static void replaceAnchorLinks(QString &sDoc);
+    static void replaceKnowledgeBoxLinks(QString &sDoc);
 
     QString m_sWikiUrl;   // Inyoka wiki url
     QStringList m_sListInterwikiKey;   // Interwiki link keywords
     QStringList m_sListInterwikiLink;  // Interwiki link urls
+    QRegularExpression m_FindInterwikiLink;
 
     bool m_bCheckLinks;
-    QString m_sLinkClassAddition;
-    QNetworkAccessManager *m_NWAManager;
-    QNetworkReply *m_NWreply;
+    LinkChecker *m_pLinkChecker;
 };
 
 #endif  // APPLICATION_PARSER_PARSELINKS_H_
@@ -26,30 +26,28 @@
 
 #include "./parselist.h"
 
-#include <QTextBlock>
-#include <QTextDocument>
+#include <QStringList>
 
 ParseList::ParseList() = default;
 
-void ParseList::startParsing(QTextDocument *pRawDoc) {
-  QString sDoc(QLatin1String(""));
+void ParseList::startParsing(QString &sDoc) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
   QString sLine;
   QString sClass(QStringLiteral("arabic"));
   int nPreviousIndex;
   int nCurrentIndex = -1;
   QList<bool> bArrayListType;  // Unsorted = false, sorted = true
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if (block.text().trimmed().startsWith(QLatin1String("*")) ||
-        block.text().trimmed().startsWith(QLatin1String("1.")) ||
-        block.text().trimmed().startsWith(QLatin1String("a.")) ||
-        block.text().trimmed().startsWith(QLatin1String("A.")) ||
-        block.text().trimmed().startsWith(QLatin1String("i.")) ||
-        block.text().trimmed().startsWith(QLatin1String("I."))) {
-      sLine = block.text();
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
+    if (sRawLine.trimmed().startsWith(QLatin1String("*")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("1.")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("a.")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("A.")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("i.")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("I."))) {
+      sLine = sRawLine;
 
       if (sLine.indexOf(QLatin1String(" * ")) >= 0) {  // Unsorted list
         nPreviousIndex = nCurrentIndex;
@@ -59,28 +57,28 @@ void ParseList::startParsing(QTextDocument *pRawDoc) {
 
         if (nCurrentIndex != nPreviousIndex) {
           if (nCurrentIndex > nPreviousIndex) {  // New tag
-            sDoc += QLatin1String("<ul>\n");
+            sOutput += QLatin1String("<ul>\n");
             bArrayListType << false;
           } else {  // Close previous tag and maybe create new
             if (!bArrayListType.isEmpty()) {
               if (!bArrayListType.last()) {
-                sDoc += QLatin1String("</ul>\n");
+                sOutput += QLatin1String("</ul>\n");
               } else {
-                sDoc += QLatin1String("</ol>\n");
+                sOutput += QLatin1String("</ol>\n");
               }
               bArrayListType.removeLast();
             }
 
             if (!bArrayListType.isEmpty()) {
               if (bArrayListType.last()) {
-                sDoc += QLatin1String("</ol>\n<ul>\n");
+                sOutput += QLatin1String("</ol>\n<ul>\n");
                 bArrayListType.removeLast();
                 bArrayListType << false;
               }
             }
           }
         }
-        sDoc += "<li>" + sLine + "</li>\n";
+        sOutput += "<li>" + sLine + "</li>\n";
 
       } else if (sLine.indexOf(QLatin1String(" 1. ")) >= 0 ||
                  sLine.indexOf(QLatin1String(" a. ")) >= 0 ||
@@ -119,41 +117,41 @@ void ParseList::startParsing(QTextDocument *pRawDoc) {
 
         if (nCurrentIndex != nPreviousIndex) {
           if (nCurrentIndex > nPreviousIndex) {  // New tag
-            sDoc += "<ol class=\"" + sClass + "\">\n";
+            sOutput += "<ol class=\"" + sClass + "\">\n";
             bArrayListType << true;
           } else {  // Close previous tag and maybe create new
             if (!bArrayListType.isEmpty()) {
               if (!bArrayListType.last()) {
-                sDoc += QLatin1String("</ul>\n");
+                sOutput += QLatin1String("</ul>\n");
               } else {
-                sDoc += QLatin1String("</ol>\n");
+                sOutput += QLatin1String("</ol>\n");
               }
               bArrayListType.removeLast();
             }
 
             if (!bArrayListType.isEmpty()) {
               if (!bArrayListType.last()) {
-                sDoc += "</ul>\n<ol class=\"" + sClass + "\">\n";
+                sOutput += "</ul>\n<ol class=\"" + sClass + "\">\n";
                 bArrayListType.removeLast();
                 bArrayListType << true;
               }
             }
           }
         }
-        sDoc += "<li>" + sLine + "</li>\n";
+        sOutput += "<li>" + sLine + "</li>\n";
 
       } else {  // Not a list element
         // Close all open tags
         while (!bArrayListType.isEmpty()) {
           if (!bArrayListType.last()) {
-            sDoc += QLatin1String("</ul>\n");
+            sOutput += QLatin1String("</ul>\n");
           } else {
-            sDoc += QLatin1String("</ol>\n");
+            sOutput += QLatin1String("</ol>\n");
           }
           bArrayListType.removeLast();
         }
         nCurrentIndex = -1;
-        sDoc += block.text() + "\n";
+        sOutput += sRawLine + "\n";
         // qDebug() << "LIST END";
       }
 
@@ -161,17 +159,17 @@ void ParseList::startParsing(QTextDocument *pRawDoc) {
       // Close all open tags
       while (!bArrayListType.isEmpty()) {
         if (!bArrayListType.last()) {
-          sDoc += QLatin1String("</ul>\n");
+          sOutput += QLatin1String("</ul>\n");
         } else {
-          sDoc += QLatin1String("</ol>\n");
+          sOutput += QLatin1String("</ol>\n");
         }
         bArrayListType.removeLast();
       }
       nCurrentIndex = -1;
-      sDoc += block.text() + "\n";
+      sOutput += sRawLine + "\n";
       // qDebug() << "LIST END";
     }
   }
 
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
 }
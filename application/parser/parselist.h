@@ -27,12 +27,12 @@
 #ifndef APPLICATION_PARSER_PARSELIST_H_
 #define APPLICATION_PARSER_PARSELIST_H_
 
-class QTextDocument;
+class QString;
 
 class ParseList {
  public:
     ParseList();
-    static void startParsing(QTextDocument *pRawDoc);
+    static void startParsing(QString &sDoc);
 };
 
 #endif  // APPLICATION_PARSER_PARSELIST_H_
@@ -24,11 +24,14 @@
  * Parse plain text with inyoka syntax into html code.
  */
 
-#include <QMessageBox>
-#include <QProcess>
-#include <QTextBlock>
-#include <QTextDocument>
-
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+
+#include "./imagesizecache.h"
 #include "./macros.h"
 #include "./parser.h"
 #ifndef USEQTWEBENGINE
@@ -40,9 +43,32 @@
 #include "./parsetemplates.h"
 #include "./parsetextformats.h"
 #include "./parsetxtmap.h"
-#include "../syntaxcheck.h"
+#include "./provisionaltplparser.h"
+#include "./pygmentsworker.h"
+#include "./regexpregistry.h"
 #include "../templates/templates.h"
 
+namespace {
+// The library is linked statically into the application and the plugins,
+// thus each binary has its own statistics settings; they are set once,
+// before the first parser of the binary is used
+void initStatistics() {
+  static const bool bDebug = []() {
+    const bool bEnabled = QCoreApplication::arguments().contains(
+                            QStringLiteral("--debug"));
+    RegExpRegistry::setStatisticsEnabled(bEnabled);
+    ProvisionalTplParser::setStatisticsEnabled(bEnabled);
+    return bEnabled;
+  }();
+  Q_UNUSED(bDebug)
+}
+}  // namespace
+
+// Own line, since tags are searched at the beginning of lines
+const char Parser::BLOCK_MARKER[] = "<!--inyoka-block-->\n";
+const char Parser::BLOCK_END_MARKER[] = "<!--/inyoka-block-->";
+const char Parser::SOURCE_LINES_MARKER[] = "<!--inyoka-lines:";
+
 Parser::Parser(const QString &sSharePath,
                const QDir &tmpImgDir,
                const QString &sInyokaUrl,
@@ -50,16 +76,33 @@ Parser::Parser(const QString &sSharePath,
                Templates *pTemplates,
                const QString &sCommunity,
                const QString &sPygmentize,
+               const bool bPreferPygments,
                QObject *pParent)
-  : m_pRawText(nullptr),
-    m_sSharePath(sSharePath),
+  : m_sSharePath(sSharePath),
     m_tmpImgDir(tmpImgDir),
     m_sInyokaUrl(sInyokaUrl),
     m_pTemplates(pTemplates),
     m_sCommunity(sCommunity),
     m_sPygmentize(sPygmentize),
-    m_nTimedPreview(0) {
+    m_bPygmentize(QFile::exists(sPygmentize)),
+    m_pPygments(nullptr),
+    m_bPreferPygments(bPreferPygments),
+    m_nTimedPreview(0),
+    m_bBlockwise(true),
+    m_nGeneration(-1),
+    m_nLatestGeneration(-1) {
   Q_UNUSED(pParent)
+  initStatistics();
+  // Diagnostics are sent across threads
+  qRegisterMetaType<QVector<SyntaxDiagnostic> >("QVector<SyntaxDiagnostic>");
+
+  if (m_bPygmentize) {
+    qDebug() << "Pygmentize found:" << m_sPygmentize;
+    m_pPygments = new PygmentsWorker(m_sPygmentize);
+  } else {
+    qDebug() << "Pygmentize NOT found:" << m_sPygmentize;
+  }
+
   m_pMacros = new Macros(m_sSharePath, m_tmpImgDir);
 
   m_pTemplateParser = new ParseTemplates(
@@ -73,13 +116,59 @@ Parser::Parser(const QString &sSharePath,
                         m_pTemplates->getListTestedWithTouchStrings(),
                         m_sCommunity);
 
+  m_pTextformatParser = new ParseTextformats(
+                           m_pTemplates->getListFormatStart(),
+                           m_pTemplates->getListFormatEnd(),
+                           m_pTemplates->getListFormatHtmlStart(),
+                           m_pTemplates->getListFormatHtmlEnd());
+  QStringList sListFormatStart;
+  QStringList sListFormatEnd;
+  QStringList sListHtmlStart;
+  QStringList sListHtmlEnd;
+  this->getNoTranslateFormats(sListFormatStart, sListFormatEnd,
+                              sListHtmlStart, sListHtmlEnd);
+  // Text formats and footnotes may span empty lines (not the regexp ones)
+  for (int i = 0; i < m_pTemplates->getListFormatStart().size(); i++) {
+    const QString &sStart(m_pTemplates->getListFormatStart().at(i));
+    const QString &sEnd(m_pTemplates->getListFormatEnd().at(i));
+    if (!sStart.isEmpty() && !sEnd.isEmpty() &&
+        !sStart.startsWith(QLatin1String("RegExp=")) &&
+        !sEnd.startsWith(QLatin1String("RegExp="))) {
+      m_sListSpanStart << sStart;
+      m_sListSpanEnd << sEnd;
+    }
+  }
+  m_sListSpanStart << QStringLiteral("((");
+  m_sListSpanEnd << QStringLiteral("))");
+
+  m_pNoTranslateParser = new ParseTextformats(sListFormatStart,
+                                              sListFormatEnd,
+                                              sListHtmlStart,
+                                              sListHtmlEnd);
+  for (int i = 0; i < sListHtmlStart.size(); i++) {
+    m_NoTranslateRegExps << RegExpRegistry::get(
+                              sListHtmlStart[i] + ".+" + sListHtmlEnd[i],
+                              QRegularExpression::CaseInsensitiveOption |
+                              QRegularExpression::InvertedGreedinessOption |
+                              QRegularExpression::DotMatchesEverythingOption);
+  }
+
   m_pLinkParser = new ParseLinks(m_sInyokaUrl,
                                  m_pTemplates->getListIWLs(),
                                  m_pTemplates->getListIWLUrls(),
-                                 bCheckLinks);
+                                 bCheckLinks, this);
+  connect(m_pLinkParser, &ParseLinks::linkStateChanged,
+          this, &Parser::updateLinkState);
 }
 
 Parser::~Parser() {
+  RegExpRegistry::logStatistics();  // Of the whole session
+  delete m_pTextformatParser;
+  m_pTextformatParser = nullptr;
+  delete m_pNoTranslateParser;
+  m_pNoTranslateParser = nullptr;
+  delete m_pPygments;
+  m_pPygments = nullptr;
   if (nullptr != m_pLinkParser) {
     delete m_pLinkParser;
     m_pLinkParser = nullptr;
@@ -93,6 +182,7 @@ void Parser::updateSettings(const QString &sInyokaUrl, const bool bCheckLinks,
                             const quint32 nTimedPreview) {
   m_sInyokaUrl = sInyokaUrl;
   m_pLinkParser->updateSettings(sInyokaUrl, bCheckLinks);
+  m_BlockCache.clear();  // Links have to be generated again
 #ifdef NOPREVIEW
   m_nTimedPreview = nTimedPreview;
 #else
@@ -103,67 +193,194 @@ void Parser::updateSettings(const QString &sInyokaUrl, const bool bCheckLinks,
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
+void Parser::updateLinkState(const QString &sPageUrl, const bool bMissing) {
+  // Drop cached blocks containing the link (with or without anchor)
+  const QString sHref("href=\"" + sPageUrl);
+  for (auto it = m_BlockCache.begin(); it != m_BlockCache.end();) {
+    if (it->sHtml.contains(sHref + "\"") || it->sHtml.contains(sHref + "#")) {
+      it = m_BlockCache.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  emit this->linkStateChanged(sPageUrl, bMissing);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void Parser::cancelOutdatedParsing(const int nLatestGeneration) {
+  m_nLatestGeneration.storeRelease(nLatestGeneration);
+}
+
+void Parser::setBlockwise(const bool bBlockwise) {
+  m_bBlockwise = bBlockwise;
+  m_BlockCache.clear();
+}
+
+auto Parser::getTplTranslations() const -> QStringList {
+  return m_pMacros->getTplTranslations();
+}
+
+auto Parser::isCanceled() const -> bool {
+  return -1 != m_nGeneration &&
+      m_nGeneration != m_nLatestGeneration.loadAcquire();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void Parser::parseRequested(const int nGeneration, const QString &sActFile,
+                            const QString &sRawDoc, const bool bSyntaxCheck) {
+  // Skip requests which got outdated while waiting in the queue
+  if (nGeneration != m_nLatestGeneration.loadAcquire()) {
+    return;
+  }
+
+  m_nGeneration = nGeneration;
+  QString sHtml(this->genOutput(sActFile, sRawDoc, bSyntaxCheck));
+  const bool bCanceled(this->isCanceled());
+  m_nGeneration = -1;
+
+  if (bCanceled) {
+    qDebug() << "Parsing canceled:" << nGeneration;
+  } else {
+    emit this->parsingFinished(nGeneration, sHtml);
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Not cancelable, since it is not superseded by preview requests
+void Parser::parseSyntaxOverview(const QString &sRawDoc) {
+  emit this->syntaxOverviewFinished(this->genOutput(QString(), sRawDoc));
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
 auto Parser::genOutput(const QString &sActFile,
-                       QTextDocument *pRawDocument,
+                       const QString &sRawDoc,
                        const bool bSyntaxCheck) -> QString {
   qDebug() << "Parsing...";
-  // Need a copy otherwise text in editor will be changed
-  m_pRawText = pRawDocument->clone();
-  m_sCurrentFile = sActFile;
-  Parser::removeComments(m_pRawText);
+  m_pTemplateParser->resetStatistics();
+  // Work on a copy; all parsing steps modify this one buffer in place
+  QString sDoc(sRawDoc);
+  Parser::normalizeText(sDoc);
 
+  // Checked before removing comments, thus positions match the editor
   if (bSyntaxCheck) {
-    QPair<int, QString> ret = SyntaxCheck::checkInyokaSyntax(
-          m_pRawText,
-          m_pTemplates->getListTplNamesINY(),
-          m_pTemplates->getListSmilies(),
-          m_pMacros->getTplTranslations());
-    emit this->hightlightSyntaxError(ret);
+    const QVector<SyntaxDiagnostic> diagnostics(
+          SyntaxCheck::checkInyokaSyntax(
+            sDoc,
+            m_pTemplates->getListTplNamesINY(),
+            m_pTemplates->getListSmilies(),
+            m_pMacros->getTplTranslations()));
+    if (this->isCanceled()) {
+      return QString();
+    }
+    emit this->hightlightSyntaxError(diagnostics);
   }
 
-  m_sListNoTranslate.clear();
-  this->filterEscapedChars(m_pRawText);  // Before everything
-  this->filterNoTranslate(m_pRawText);   // Before replaceCodeblocks()
-  this->replaceCodeblocks(m_pRawText);
+  QVector<int> vSourceLines;  // Of the remaining lines
+  Parser::removeComments(sDoc, vSourceLines);
 
-  m_pTemplateParser->startParsing(m_pRawText, m_sCurrentFile);
+  ImageSizeCache::startValidation();
 
-  QStringList sListHeadlines;
-  sListHeadlines = Parser::replaceHeadlines(m_pRawText);  // Returns TOC list
-  ParseTable::startParsing(m_pRawText);
-  m_pMacros->startParsing(m_pRawText, m_sCurrentFile,
-                          m_sCommunity, sListHeadlines);
-  ParseList::startParsing(m_pRawText);
-  m_pLinkParser->startParsing(m_pRawText);
-
-  // Replace flags (only Qt WebEngine is able to render unicode flags)
-#ifdef USEQTWEBENGINE
-  this->replaceFlags(m_pRawText);
-#else
-  ParseImgMap::startParsing(m_pRawText,
-                            m_pTemplates->getListFlags(),
-                            m_pTemplates->getListFlagsImg(),
-                            m_sSharePath,
-                            m_sCommunity);
-#endif
-
-  Parser::replaceHorLines(m_pRawText);  // Before smilies, because of -- smiley
-  // Replace smilies
-  ParseTxtMap::startParsing(m_pRawText,
-                            m_pTemplates->getListSmilies(),
-                            m_pTemplates->getListSmiliesImg());
+  // Cached blocks may contain image sizes or paths of the previous article
+  const QString sResourceStamp(this->getResourceStamp());
+  if (m_sResourceStamp != sResourceStamp) {
+    m_pTemplateParser->clearCache();  // Keyed by file, thus kept otherwise
+  }
+  if (m_sCurrentFile != sActFile || m_sResourceStamp != sResourceStamp) {
+    m_BlockCache.clear();
+    m_sResourceStamp = sResourceStamp;
+  }
+  m_sCurrentFile = sActFile;
+  // Images may have been replaced without changing their folder
+  for (auto it = m_BlockCache.begin(); it != m_BlockCache.end();) {
+    if (Parser::isUpToDate(*it)) {
+      ++it;
+    } else {
+      it = m_BlockCache.erase(it);
+    }
+  }
 
-  ParseTextformats::startParsing(m_pRawText,
-                                 m_pTemplates->getListFormatStart(),
-                                 m_pTemplates->getListFormatEnd(),
-                                 m_pTemplates->getListFormatHtmlStart(),
-                                 m_pTemplates->getListFormatHtmlEnd());
+  // Only blocks which are not cached yet are parsed; blocks containing a
+  // table of contents are parsed last, since they need all headlines
+  QVector<int> vBlockStarts;
+  QStringList sListBlocks;
+  if (m_bBlockwise) {
+    sListBlocks = this->splitIntoBlocks(sDoc, vBlockStarts);
+  } else {
+    sListBlocks << sDoc;
+    vBlockStarts << 0;
+  }
+  QVector<ParsedBlock> vParsedBlocks(sListBlocks.size());
+  QList<int> listTocBlocks;
+  QStringList sListHeadlines;
+  QSet<QString> setUsedKeys;
+  for (int i = 0; i < sListBlocks.size(); i++) {
+    if (m_pMacros->hasTableOfContents(sListBlocks[i])) {
+      QString sTmp(sListBlocks[i]);
+      sListHeadlines << Parser::replaceHeadlines(sTmp);
+      listTocBlocks << i;
+    } else {
+      vParsedBlocks[i] = this->parseBlock(sListBlocks[i], QStringList(),
+                                          setUsedKeys);
+      sListHeadlines << vParsedBlocks[i].sListHeadlines;
+    }
+    if (this->isCanceled()) {
+      return QString();
+    }
+  }
+  for (const int i : qAsConst(listTocBlocks)) {
+    vParsedBlocks[i] = this->parseBlock(sListBlocks[i], sListHeadlines,
+                                        setUsedKeys);
+    if (this->isCanceled()) {
+      return QString();
+    }
+  }
 
-  Parser::replaceQuotes(m_pRawText);
-  Parser::generateParagraphs(m_pRawText);
-  Parser::replaceFootnotes(m_pRawText);
+  // Drop blocks which are not part of the article anymore
+  for (auto it = m_BlockCache.begin(); it != m_BlockCache.end();) {
+    if (setUsedKeys.contains(it.key())) {
+      ++it;
+    } else {
+      it = m_BlockCache.erase(it);
+    }
+  }
 
-  this->reinstertNoTranslate(m_pRawText);
+  // Footnotes are numbered throughout the whole article
+  sDoc.clear();
+  QString sFootnotes(QLatin1String(""));
+  QStringList sListSourceLines;
+  quint16 nFootnote = 0;
+  for (int i = 0; i < vParsedBlocks.size(); i++) {
+    const ParsedBlock &block = vParsedBlocks.at(i);
+    sListSourceLines << QString::number(
+                          vSourceLines.value(vBlockStarts.at(i)) + 1);
+    QString sHtml(block.sHtml);
+    QString sNotes(Parser::replaceFootnotes(sHtml, nFootnote));
+    m_sListNoTranslate = block.sListNoTranslate;
+    this->reinstertNoTranslate(sHtml);
+    this->reinstertNoTranslate(sNotes);
+    sDoc += QLatin1String(BLOCK_MARKER) + sHtml;
+    sFootnotes += sNotes;
+  }
+  // Empty paragraph of the last line, as generated for the whole article
+  if (vParsedBlocks.isEmpty()) {
+    sDoc += QLatin1String(BLOCK_MARKER);
+  }
+  sDoc += QLatin1String("<p>\n</p>");
+  if (!sFootnotes.isEmpty()) {
+    sDoc += QLatin1String(BLOCK_MARKER) +
+            "<ul class=\"footnotes\">\n" + sFootnotes + "</ul>\n";
+  }
+  sDoc += QLatin1String(BLOCK_END_MARKER);
+  // Not part of the blocks, since inserted lines change all following ones
+  sDoc += QLatin1String(SOURCE_LINES_MARKER) + sListSourceLines.join(',') +
+          "-->";
 
   // File name
   QString sFilename;
@@ -191,18 +408,178 @@ auto Parser::genOutput(const QString &sActFile,
                     QTime::currentTime().toString(
           QStringLiteral("hh:mm")));
   sTemplateCopy = sTemplateCopy.replace(QLatin1String("%tags%"),
-                                        this->generateTags(m_pRawText));
-  sTemplateCopy = sTemplateCopy.replace(QLatin1String("%content%"),
-                                        m_pRawText->toPlainText());
+                                        this->generateTags(sDoc));
+  sTemplateCopy = sTemplateCopy.replace(QLatin1String("%content%"), sDoc);
   QString sRefresh(QLatin1String(""));
   if (m_nTimedPreview > 0) {
     sRefresh = "<meta http-equiv=\"refresh\" content=\"" +
         QString::number(m_nTimedPreview) + "\">";
   }
   sTemplateCopy = sTemplateCopy.replace(QLatin1String("%refresh%"), sRefresh);
+  m_pTemplateParser->logStatistics();
   return sTemplateCopy;
 }
 
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto Parser::parseBlock(const QString &sBlock,
+                        const QStringList &sListTocHeadlines,
+                        QSet<QString> &setUsedKeys) -> ParsedBlock {
+  QString sKey(sBlock);
+  if (!sListTocHeadlines.isEmpty()) {
+    sKey += QChar::Null + sListTocHeadlines.join('\n');
+  }
+  setUsedKeys << sKey;
+
+  auto it = m_BlockCache.constFind(sKey);
+  if (m_BlockCache.constEnd() != it) {
+    return it.value();
+  }
+
+  ParsedBlock block;
+  QString sDoc(sBlock);
+  m_sListNoTranslate.clear();
+  this->filterEscapedChars(sDoc);  // Before everything
+  this->filterNoTranslate(sDoc);   // Before replaceCodeblocks()
+  this->replaceCodeblocks(sDoc);
+
+  m_pTemplateParser->startParsing(sDoc, m_sCurrentFile);
+  block.imageSizes = m_pTemplateParser->getUsedImageSizes();
+
+  block.sListHeadlines = Parser::replaceHeadlines(sDoc);
+  ParseTable::startParsing(sDoc);
+  // Macros are modifying the headline list, thus use a copy
+  QStringList sListHeadlines(sListTocHeadlines);
+  m_pMacros->startParsing(sDoc, m_sCurrentFile,
+                          m_sCommunity, sListHeadlines);
+  const QHash<QString, QSize> macroImageSizes(
+        m_pMacros->getUsedImageSizes());
+  for (auto it = macroImageSizes.constBegin();
+       it != macroImageSizes.constEnd(); ++it) {
+    block.imageSizes.insert(it.key(), it.value());
+  }
+  ParseList::startParsing(sDoc);
+  m_pLinkParser->startParsing(sDoc);
+
+  // Replace flags (only Qt WebEngine is able to render unicode flags)
+#ifdef USEQTWEBENGINE
+  this->replaceFlags(sDoc);
+#else
+  ParseImgMap::startParsing(sDoc,
+                            m_pTemplates->getFlagReplacer(),
+                            m_pTemplates->getListFlagsImg(),
+                            m_sSharePath,
+                            m_sCommunity);
+#endif
+
+  Parser::replaceHorLines(sDoc);  // Before smilies, because of -- smiley
+  // Replace smilies
+  ParseTxtMap::startParsing(sDoc,
+                            m_pTemplates->getSmileyReplacer(),
+                            m_pTemplates->getListSmiliesImg());
+
+  m_pTextformatParser->startParsing(sDoc);
+
+  Parser::replaceQuotes(sDoc);
+  Parser::generateParagraphs(sDoc);
+
+  block.sHtml = sDoc;
+  block.sListNoTranslate = m_sListNoTranslate;
+  if (!this->isCanceled()) {
+    m_BlockCache.insert(sKey, block);
+  }
+  return block;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Top-level blocks are separated by empty lines. Code blocks, macros, text
+// formats and footnotes spanning several lines are never split; an unclosed
+// one joins all following blocks, as if the whole article was parsed.
+auto Parser::splitIntoBlocks(const QString &sDoc,
+                             QVector<int> &vBlockStarts) const -> QStringList {
+  QStringList sListBlocks;
+  QString sBlock(QLatin1String(""));
+  int nCodeDepth = 0;
+  int nMacroDepth = 0;
+  int nOpenSpans = 0;
+  QVector<int> vSpanDepth(m_sListSpanStart.size(), 0);
+  vBlockStarts.clear();
+
+  const QStringList sListLines(sDoc.split('\n'));
+  for (int i = 0; i < sListLines.size(); i++) {
+    const QString &sLine(sListLines.at(i));
+    if (sLine.trimmed().isEmpty() && 0 == nCodeDepth && 0 == nMacroDepth &&
+        0 == nOpenSpans) {
+      if (!sBlock.isEmpty()) {
+        sListBlocks << sBlock;
+        sBlock.clear();
+      }
+      continue;
+    }
+
+    if (sBlock.isEmpty()) {
+      vBlockStarts << i;
+    } else {
+      sBlock += '\n';
+    }
+    sBlock += sLine;
+    nCodeDepth += sLine.count(QLatin1String("{{{")) -
+                  sLine.count(QLatin1String("}}}"));
+    nMacroDepth += sLine.count(QLatin1String("[[")) -
+                   sLine.count(QLatin1String("]]"));
+    nCodeDepth = qMax(0, nCodeDepth);
+    nMacroDepth = qMax(0, nMacroDepth);
+
+    nOpenSpans = 0;
+    for (int j = 0; j < m_sListSpanStart.size(); j++) {
+      const int nStarts = sLine.count(m_sListSpanStart.at(j));
+      if (m_sListSpanStart.at(j) == m_sListSpanEnd.at(j)) {
+        vSpanDepth[j] = (vSpanDepth.at(j) + nStarts) % 2;  // Toggled
+      } else {
+        vSpanDepth[j] = qMax(0, vSpanDepth.at(j) + nStarts -
+                             sLine.count(m_sListSpanEnd.at(j)));
+      }
+      if (0 != vSpanDepth.at(j)) {
+        nOpenSpans++;
+      }
+    }
+  }
+  if (!sBlock.isEmpty()) {
+    sListBlocks << sBlock;
+  }
+
+  return sListBlocks;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Changes as soon as images have been added to / removed from image folders
+auto Parser::getResourceStamp() const -> QString {
+  QString sStamp(QFileInfo(m_tmpImgDir.absolutePath()).lastModified()
+                 .toString(Qt::ISODate));
+  if (!m_sCurrentFile.isEmpty()) {
+    sStamp += "|" + QFileInfo(QFileInfo(m_sCurrentFile).absolutePath())
+              .lastModified().toString(Qt::ISODate);
+  }
+  return sStamp;
+}
+
+// Same check as for cached template expansions; image sizes are checked on
+// disk at most once per parsing run
+auto Parser::isUpToDate(const ParsedBlock &block) -> bool {
+  for (auto it = block.imageSizes.constBegin();
+       it != block.imageSizes.constEnd(); ++it) {
+    if (ImageSizeCache::size(it.key()) != it.value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 /*
@@ -276,22 +653,27 @@ void Parser::replaceTemplates(QTextDocument *pRawDoc) {
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::replaceCodeblocks(QTextDocument *pRawDoc) {
-  QString sDoc(pRawDoc->toPlainText());
-  QStringList sListTplRegExp;
+void Parser::replaceCodeblocks(QString &sDoc) {
+  const QRegularExpression::PatternOptions options(
+        QRegularExpression::CaseInsensitiveOption |
+        QRegularExpression::InvertedGreedinessOption |
+        QRegularExpression::DotMatchesEverythingOption);
   // Search for {{{#!code ...}}} and {{{ ... without #!X ...}}}
-  sListTplRegExp << QStringLiteral("\\{\\{\\{#!code .+\\}\\}\\}")
-                 << QStringLiteral("\\{\\{\\{(?!#!\\S).+\\}\\}\\}");
+  static const QList<QRegularExpression> listFindTemplate{
+    RegExpRegistry::get(
+          QStringLiteral("\\{\\{\\{#!code .+\\}\\}\\}"), options),
+    RegExpRegistry::get(
+          QStringLiteral("\\{\\{\\{(?!#!\\S).+\\}\\}\\}"), options)
+  };
   QStringList sListLines;
 
-  for (int k = 0; k < sListTplRegExp.size(); k++) {
-    QRegExp findTemplate(sListTplRegExp[k], Qt::CaseInsensitive);
-    findTemplate.setMinimal(true);
-    int nPos = 0;
+  for (const auto &findTemplate : listFindTemplate) {
+    QRegularExpressionMatch match(RegExpRegistry::match(findTemplate, sDoc));
+    int nPos;
 
-    while ((nPos = findTemplate.indexIn(sDoc, nPos)) != -1) {
+    while ((nPos = match.capturedStart()) != -1) {
       bool bFormated = false;
-      QString sMacro = findTemplate.cap(0);
+      QString sMacro = match.captured(0);
       sMacro.remove(QStringLiteral("{{{\n"));
       sMacro.remove(QStringLiteral("{{{"));
       if (sMacro.startsWith(QLatin1String("#!code "), Qt::CaseInsensitive)) {
@@ -302,7 +684,7 @@ void Parser::replaceCodeblocks(QTextDocument *pRawDoc) {
       sMacro.remove(QStringLiteral("}}}"));
 
       sListLines.clear();
-      sListLines = sMacro.split(QRegExp(QLatin1String("\\n")));
+      sListLines = sMacro.split('\n');
 
       // Only plain code
       if (!bFormated) {
@@ -362,14 +744,12 @@ void Parser::replaceCodeblocks(QTextDocument *pRawDoc) {
       m_sListNoTranslate << sMacro;  // Save code block
       sMacro = "%%NO_TRANSLATE_" + QString::number(nNoTranslate) + "%%";
 
-      sDoc.replace(nPos, findTemplate.matchedLength(), sMacro);
+      sDoc.replace(nPos, match.capturedLength(), sMacro);
       // Go on with new start position
-      nPos += sMacro.length();
+      match = RegExpRegistry::match(findTemplate, sDoc,
+                                    nPos + sMacro.length());
     }
   }
-
-  // Replace pRawDoc with adapted document
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
@@ -377,106 +757,60 @@ void Parser::replaceCodeblocks(QTextDocument *pRawDoc) {
 
 auto Parser::highlightCode(const QString &sLanguage,
                            const QString &sCode) -> QString {
-  static bool bChecked(false);
-  static bool bPygmentize(false);
-  static QFile sPygmentize(m_sPygmentize);
-  if (!bChecked) {
-    bChecked = true;
-    if (sPygmentize.exists()) {
-      bPygmentize = true;
-      qDebug() << "Pygmentize found:" << sPygmentize.fileName();
-    } else {
-      qDebug() << "Pygmentize NOT found:" << sPygmentize.fileName();
-    }
+  // Runs in the parser thread, thus errors are logged only (no message box)
+  QString sHtml;
+  if (m_bPreferPygments && nullptr != m_pPygments &&
+      m_pPygments->highlight(sLanguage, sCode, sHtml)) {
+    return sHtml;
   }
-
-  if (bPygmentize) {
-    QProcess procPygmentize;
-    QProcess procEcho;
-
-    // Workaround for passing stdin string with code to pygmentize
-    procEcho.setStandardOutputProcess(&procPygmentize);
-    procEcho.start(QStringLiteral("echo"), QStringList() << sCode);
-    if (!procEcho.waitForStarted()) {
-      QMessageBox::critical(nullptr, QStringLiteral("Pygments error"),
-                            QStringLiteral("Could not start echo."));
-      qCritical() << "Pygments error: Could not start echo.";
-      procEcho.kill();
-      return sCode;
-    }
-    if (!procEcho.waitForFinished()) {
-      QMessageBox::critical(nullptr, QStringLiteral("Pygments error"),
-                            QStringLiteral("Error while using echo."));
-      qCritical() << "Pygments error: While using echo.";
-      procEcho.kill();
-      return sCode;
-    }
-
-    procPygmentize.start(sPygmentize.fileName(),
-                         QStringList() << QStringLiteral("-l") << sLanguage <<
-                         QStringLiteral("-f") << QStringLiteral("html") <<
-                         QStringLiteral("-O") << QStringLiteral("nowrap") <<
-                         QStringLiteral("-O") << QStringLiteral("noclasses"));
-
-    if (!procPygmentize.waitForStarted()) {
-      QMessageBox::critical(nullptr, QStringLiteral("Pygments error"),
-                            QStringLiteral("Could not start pygmentize."));
-      qCritical() << "Error while starting pygmentize - waitForStarted";
-      procPygmentize.kill();
-      return sCode;
-    }
-    if (!procPygmentize.waitForFinished()) {
-      QMessageBox::critical(nullptr, QStringLiteral("Pygments error"),
-                            QStringLiteral("Error while using pygmentize."));
-      qCritical() << "Error while executing pygmentize - waitForFinished";
-      procPygmentize.kill();
-      return sCode;
-    }
-
-    return QString::fromUtf8(procPygmentize.readAll());
+  // Built-in highlighter avoids starting python for common languages
+  if (m_CodeHighlighter.highlight(sLanguage, sCode, sHtml)) {
+    return sHtml;
   }
-
-  return sCode;
+  // Unknown languages result in empty output from pygments
+  if (!m_bPreferPygments && nullptr != m_pPygments &&
+      m_pPygments->highlight(sLanguage, sCode, sHtml)) {
+    return sHtml;
+  }
+  // Neither highlighted nor interpreted as html
+  return sCode.toHtmlEscaped();
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::filterEscapedChars(QTextDocument *pRawDoc) {
-  QString sDoc(pRawDoc->toPlainText());
-  QRegExp pattern(QLatin1String("\\\\."), Qt::CaseInsensitive);
+void Parser::filterEscapedChars(QString &sDoc) {
+  static const QRegularExpression pattern(RegExpRegistry::get(
+      QStringLiteral("\\\\."),
+      QRegularExpression::DotMatchesEverythingOption));
   QString sEscChar;
   int nPos(0);
   unsigned int nNoTranslate;
+  QRegularExpressionMatch match;
 
-  while ((nPos = pattern.indexIn(sDoc, nPos)) != -1) {
-    sEscChar = pattern.cap(0);
+  while ((nPos = (match = RegExpRegistry::match(pattern, sDoc,
+                                                nPos)).capturedStart()) != -1) {
+    sEscChar = match.captured(0);
     if ("\\\\" != sEscChar) {
       sEscChar.remove(0, 1);  // Remove escape char
       nNoTranslate = static_cast<unsigned int>(m_sListNoTranslate.size());
       m_sListNoTranslate << sEscChar;
 
-      sDoc.replace(nPos, pattern.matchedLength(), "%%NO_TRANSLATE_" +
+      sDoc.replace(nPos, match.capturedLength(), "%%NO_TRANSLATE_" +
                    QString::number(nNoTranslate) + "%%");
     }
     // Go on with search
     nPos += sEscChar.length();
   }
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::filterNoTranslate(QTextDocument *pRawDoc) {
-  QStringList sListFormatStart;
-  QStringList sListFormatEnd;
-  QStringList sListHtmlStart;
-  QStringList sListHtmlEnd;
-  QString sDoc(QLatin1String(""));
-  QRegExp patternFormat;
-  unsigned int nNoTranslate;
-
+void Parser::getNoTranslateFormats(QStringList &sListFormatStart,
+                                   QStringList &sListFormatEnd,
+                                   QStringList &sListHtmlStart,
+                                   QStringList &sListHtmlEnd) const {
   for (int i = 0; i < m_pTemplates->getListFormatHtmlStart().size(); i++) {
     if (m_pTemplates->getListFormatHtmlStart().at(i)
         .contains(QLatin1String("class=\"notranslate\""))) {
@@ -486,86 +820,78 @@ void Parser::filterNoTranslate(QTextDocument *pRawDoc) {
       sListHtmlEnd << m_pTemplates->getListFormatHtmlEnd().at(i);
     }
   }
+}
 
-  ParseTextformats::startParsing(pRawDoc, sListFormatStart, sListFormatEnd,
-                                 sListHtmlStart, sListHtmlEnd);
+// ----------------------------------------------------------------------------
+
+void Parser::filterNoTranslate(QString &sDoc) {
+  unsigned int nNoTranslate;
 
-  patternFormat.setCaseSensitivity(Qt::CaseInsensitive);
-  patternFormat.setMinimal(true);  // Search only for smallest match
+  m_pNoTranslateParser->startParsing(sDoc);
 
-  sDoc = pRawDoc->toPlainText();  // Init sDoc here; AFTER raw doc is changed
   // qDebug() << "\n\n" << sDoc << "\n\n";
   nNoTranslate = static_cast<unsigned int>(m_sListNoTranslate.size());
-  for (int i = 0; i < sListHtmlStart.size(); i++) {
-    patternFormat.setPattern(sListHtmlStart[i] + ".+" + sListHtmlEnd[i]);
-    int nIndex = patternFormat.indexIn(sDoc);
+  for (const auto &patternFormat : qAsConst(m_NoTranslateRegExps)) {
+    QRegularExpressionMatch match(RegExpRegistry::match(patternFormat, sDoc));
 
-    while (nIndex >= 0) {
-      QString sFormatedText = patternFormat.cap();
+    while (match.hasMatch()) {
+      QString sFormatedText = match.captured();
       m_sListNoTranslate << sFormatedText;
-      nIndex = patternFormat.indexIn(sDoc,
-                                     nIndex + sFormatedText.length());
+      match = RegExpRegistry::match(patternFormat, sDoc,
+                                    match.capturedEnd());
       sDoc.replace(sFormatedText, "%%NO_TRANSLATE_" +
                    QString::number(nNoTranslate) + "%%");
       nNoTranslate++;
     }
   }
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::reinstertNoTranslate(QTextDocument *pRawDoc) {
-  QString sDoc(pRawDoc->toPlainText());
-
+void Parser::reinstertNoTranslate(QString &sDoc) {
   // Reinsert filtered monotype codeblock
   // Has to be decremental, because of possible nested blocks
   for (int i = m_sListNoTranslate.size() - 1; i >= 0; i--) {
     sDoc.replace("%%NO_TRANSLATE_" + QString::number(i) + "%%",
                  m_sListNoTranslate[i]);
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::replaceHorLines(QTextDocument *pRawDoc) {
-  QString sDoc(QLatin1String(""));
+void Parser::replaceHorLines(QString &sDoc) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
 
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if ("----" == block.text()) {
-      sDoc += QLatin1String("\n<hr />\n");
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
+    if ("----" == sRawLine) {
+      sOutput += QLatin1String("\n<hr />\n");
     } else {
-      sDoc += block.text() + "\n";
+      sOutput += sRawLine + "\n";
     }
   }
 
-  // Replace pRawDoc with adapted document
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-auto Parser::generateTags(QTextDocument *pRawDoc) -> QString {
-  QString sDoc(pRawDoc->toPlainText());
+auto Parser::generateTags(QString &sDoc) -> QString {
+  const QStringList sListRawLines(sDoc.split('\n'));
   QString sLine;
   QString sTags(QLatin1String(""));
   QStringList sListTags;
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if (block.text().trimmed().startsWith(QLatin1String("#tag:")) ||
-        block.text().trimmed().startsWith(QLatin1String("# tag:"))) {
-      sLine = block.text();
-      sTags = block.text().trimmed();
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
+    if (sRawLine.trimmed().startsWith(QLatin1String("#tag:")) ||
+        sRawLine.trimmed().startsWith(QLatin1String("# tag:"))) {
+      sLine = sRawLine;
+      sTags = sRawLine.trimmed();
       sTags.remove(QStringLiteral("#tag:"));
       sTags.remove(QStringLiteral("# tag:"));
       sTags = sTags.trimmed();
@@ -584,8 +910,6 @@ auto Parser::generateTags(QTextDocument *pRawDoc) -> QString {
       sTags += QLatin1String(",");
     }
   }
-
-  pRawDoc->setPlainText(sDoc);
   return sTags;
 }
 
@@ -593,18 +917,18 @@ auto Parser::generateTags(QTextDocument *pRawDoc) -> QString {
 // ----------------------------------------------------------------------------
 
 #ifdef USEQTWEBENGINE
-void Parser::replaceFlags(QTextDocument *pRawDoc) {
-  QRegExp findFlag(QLatin1String("\\{([a-z]{2}|[A-Z]{2})\\}"));
-  QString sDoc(pRawDoc->toPlainText());
+void Parser::replaceFlags(QString &sDoc) {
+  static const QRegularExpression findFlag(RegExpRegistry::get(
+      QStringLiteral("\\{([a-z]{2}|[A-Z]{2})\\}")));
   QString sCountry;
   QString sHtml(QLatin1String(""));
   int nIndex;
   int nLength(4);
 
-  nIndex = findFlag.indexIn(sDoc);
-  while (nIndex >= 0) {
+  QRegularExpressionMatch match(RegExpRegistry::match(findFlag, sDoc));
+  while ((nIndex = match.capturedStart()) >= 0) {
     sHtml.clear();
-    sCountry = findFlag.cap(1);
+    sCountry = match.captured(1);
     sCountry = sCountry.toLower();
     if ("en" == sCountry) {
       sCountry = QStringLiteral("gb");
@@ -617,102 +941,119 @@ void Parser::replaceFlags(QTextDocument *pRawDoc) {
     }
 
     sDoc.replace(nIndex, nLength, sHtml);
-    nIndex = findFlag.indexIn(sDoc, nIndex + nLength);
+    match = RegExpRegistry::match(findFlag, sDoc, nIndex + nLength);
   }
-
-  pRawDoc->setPlainText(sDoc);
 }
 #endif
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::replaceQuotes(QTextDocument *pRawDoc) {
-  QString sDoc(QLatin1String(""));
+void Parser::replaceQuotes(QString &sDoc) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
   QString sLine;
   quint16 nQuotes;
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if (block.text().startsWith(QLatin1String(">"))) {
-      sLine = block.text().trimmed();
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
+    if (sRawLine.startsWith(QLatin1String(">"))) {
+      sLine = sRawLine.trimmed();
       nQuotes = static_cast<quint16>(sLine.count(QStringLiteral(">")));
-      sLine.remove(QRegExp(QLatin1String("^>*")));
+      int nStart = 0;
+      while (nStart < sLine.length() && '>' == sLine.at(nStart)) {
+        nStart++;
+      }
+      sLine.remove(0, nStart);
       for (int n = 0; n < nQuotes; n++) {
         sLine = "<blockquote>" + sLine + "</blockquote>";
       }
-      sDoc += sLine + "\n";
+      sOutput += sLine + "\n";
     } else {
-      sDoc += block.text() + "\n";
+      sOutput += sRawLine + "\n";
     }
   }
 
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::generateParagraphs(QTextDocument *pRawDoc) {
-  QString sDoc(QStringLiteral("<p>\n"));
+void Parser::generateParagraphs(QString &sDoc) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QStringLiteral("<p>\n"));
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if (block.text().trimmed().isEmpty()) {
-      sDoc += QLatin1String("</p>\n<p>\n");
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
+    if (sRawLine.trimmed().isEmpty()) {
+      sOutput += QLatin1String("</p>\n<p>\n");
     } else {
-      sDoc += block.text() + "\n";
+      sOutput += sRawLine + "\n";
     }
   }
-  sDoc += QLatin1String("</p>");
+  // Closed by a line break, thus empty paragraphs are removed the same way
+  // for each block as for the whole article followed by an empty line
+  sOutput += QLatin1String("</p>\n");
 
-  pRawDoc->setPlainText(sDoc.remove(QStringLiteral("<p>\n</p>\n")));
+  sDoc = sOutput.remove(QStringLiteral("<p>\n</p>\n"));
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::removeComments(QTextDocument *pRawDoc) {
-  QString sDoc(QLatin1String(""));
+void Parser::normalizeText(QString &sDoc) {
+  // Same conversions QTextDocument applies in setPlainText() / toPlainText(),
+  // so that every following step can split the text by '\n' only
+  sDoc.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+  sDoc.replace('\r', '\n');
+  sDoc.replace(QChar::ParagraphSeparator, '\n');
+  sDoc.replace(QChar::LineSeparator, '\n');
+  sDoc.replace(QChar(0xfdd0), '\n');  // Beginning of frame
+  sDoc.replace(QChar(0xfdd1), '\n');  // End of frame
+  sDoc.replace(QChar::Nbsp, ' ');
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void Parser::removeComments(QString &sDoc, QVector<int> &vSourceLines) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
+  vSourceLines.clear();
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
-    if (!block.text().startsWith(QLatin1String("##"))) {
-      sDoc += block.text() + "\n";
+  // Go through each line
+  for (int i = 0; i < sListRawLines.size(); i++) {
+    if (!sListRawLines.at(i).startsWith(QLatin1String("##"))) {
+      sOutput += sListRawLines.at(i) + "\n";
+      vSourceLines << i;
     }
   }
 
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-auto Parser::replaceHeadlines(QTextDocument *pRawDoc) -> QStringList {
+auto Parser::replaceHeadlines(QString &sDoc) -> QStringList {
   static const quint8 MAXHEAD = 5;
-  QString sDoc(QLatin1String(""));
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
   QString sLine;
   QString sTmp(QLatin1String(""));
   QString sLink(QLatin1String(""));
   quint8 nHeadlineLevel;
   QStringList slistHeadlines;
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
+  // Go through each line
+  for (const auto &sRawLine : sListRawLines) {
     // Order is important! First level 5, 4, 3, 2, 1
     for (int i = MAXHEAD; i >= 0; i--) {
-      sLine = block.text();
+      sLine = sRawLine;
       sTmp.fill('=', i);
       if (0 == i) {
-        sDoc += sLine + "\n";
+        sOutput += sLine + "\n";
         break;
       }
       if (sLine.trimmed().startsWith(sTmp) &&
@@ -764,34 +1105,35 @@ auto Parser::replaceHeadlines(QTextDocument *pRawDoc) -> QStringList {
               sLink + "\">" + sLine + " <a href=\"#" + sLink +
               "\" class=\"headerlink\"> &para;</a></h" +
               QString::number(nHeadlineLevel+1) + ">\n";
-      sDoc += sLine;
+      sOutput += sLine;
       break;
     }
   }
   // qDebug() << "HEADLINES:" << slistHeadlines;
 
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
   return slistHeadlines;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void Parser::replaceFootnotes(QTextDocument *pRawDoc) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sRegExp(QStringLiteral("\\(\\(.*\\)\\)"));
-  QRegExp findMacro(sRegExp, Qt::CaseInsensitive);
-  findMacro.setMinimal(true);
+auto Parser::replaceFootnotes(QString &sDoc, quint16 &nIndex) -> QString {
+  static const QRegularExpression findMacro(RegExpRegistry::get(
+      QStringLiteral("\\(\\(.*\\)\\)"),
+      QRegularExpression::InvertedGreedinessOption |
+      QRegularExpression::DotMatchesEverythingOption));
   QString sNote;
   QString sIndex;
   int nPos = 0;
-  quint16 nIndex = 0;
   QString sFootnotes(QLatin1String(""));
+  QRegularExpressionMatch match;
 
-  while ((nPos = findMacro.indexIn(sDoc, nPos)) != -1) {
+  while ((nPos = (match = RegExpRegistry::match(findMacro, sDoc,
+                                                nPos)).capturedStart()) != -1) {
     nIndex++;
 
-    sNote = findMacro.cap(0);
+    sNote = match.captured(0);
     sNote.remove(QStringLiteral("(("));
     sNote.remove(QStringLiteral("))"));
     sFootnotes += "<li><a id=\"fn-" + QString::number(nIndex) +
@@ -806,15 +1148,10 @@ void Parser::replaceFootnotes(QTextDocument *pRawDoc) {
              "\">"
              "&#091;" + QString::number(nIndex) + "&#093;</a>";
 
-    sDoc.replace(nPos, findMacro.matchedLength(), sIndex);
+    sDoc.replace(nPos, match.capturedLength(), sIndex);
     // Go on with new start position
     nPos += sIndex.length();
   }
 
-  if (!sFootnotes.isEmpty()) {
-    sFootnotes = "<ul class=\"footnotes\">\n" + sFootnotes + "</ul>\n";
-  }
-
-  // Replace pRawDoc with adapted document
-  pRawDoc->setPlainText(sDoc + sFootnotes);
+  return sFootnotes;
 }
@@ -27,17 +27,34 @@
 #ifndef APPLICATION_PARSER_PARSER_H_
 #define APPLICATION_PARSER_PARSER_H_
 
+#include <QAtomicInt>
 #include <QDir>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSize>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
-class QTextDocument;
+#include "./codehighlighter.h"
+#include "../syntaxcheck.h"
 
 class Macros;
 class ParseLinks;
 class ParseTemplates;
+class ParseTextformats;
+class PygmentsWorker;
 class Templates;
 
+// Parsing result of one top-level block, separated by empty lines
+struct ParsedBlock {
+  QString sHtml;
+  QStringList sListNoTranslate;
+  QStringList sListHeadlines;
+  QHash<QString, QSize> imageSizes;  // Output depends on them
+};
+
 /**
  * \class Parser
  * \brief Main parser module.
@@ -49,48 +66,88 @@ class Parser : public QObject {
     Parser(const QString &sSharePath, const QDir &tmpImgDir,
            const QString &sInyokaUrl, const bool bCheckLinks,
            Templates *pTemplates, const QString &sCommunity,
-           const QString &sPygmentize, QObject *pParent = nullptr);
+           const QString &sPygmentize, const bool bPreferPygments = true,
+           QObject *pParent = nullptr);
     ~Parser();
 
+    // Comments in the generated page preceding each top-level block and
+    // following the last one; allow updating single blocks of a preview
+    static const char BLOCK_MARKER[];
+    static const char BLOCK_END_MARKER[];
+    // Follows the end marker: "<!--inyoka-lines:1,4,9-->" with the source
+    // line (starting with 1) of each block; footnotes have none
+    static const char SOURCE_LINES_MARKER[];
+
     // Starts generating HTML-code
-    QString genOutput(const QString &sActFile, QTextDocument *pRawDocument,
-                      const bool bSyntaxCheck = false);
+    Q_INVOKABLE QString genOutput(const QString &sActFile,
+                                  const QString &sRawDoc,
+                                  const bool bSyntaxCheck = false);
+    // Thread-safe; aborts all requests older than nLatestGeneration
+    void cancelOutdatedParsing(const int nLatestGeneration);
+    // Parse the whole article at once instead of cached top-level blocks;
+    // used for comparing both outputs
+    void setBlockwise(const bool bBlockwise);
+    // Thread-safe; macros are loaded once while constructing the parser
+    auto getTplTranslations() const -> QStringList;
 
  public slots:
     void updateSettings(const QString &sInyokaUrl, const bool bCheckLinks,
                         const quint32 nTimedPreview);
+    void parseRequested(const int nGeneration, const QString &sActFile,
+                        const QString &sRawDoc, const bool bSyntaxCheck);
+    void parseSyntaxOverview(const QString &sRawDoc);
 
  signals:
-    void hightlightSyntaxError(const QPair<int, QString>);
+    void hightlightSyntaxError(const QVector<SyntaxDiagnostic> &diagnostics);
+    void parsingFinished(const int nGeneration, const QString &sHtml);
+    void syntaxOverviewFinished(const QString &sHtml);
+    void linkStateChanged(const QString &sPageUrl, const bool bMissing);
+
+ private slots:
+    void updateLinkState(const QString &sPageUrl, const bool bMissing);
 
  private:
     // void replaceTemplates(QTextDocument *pRawDoc);
 
-    void filterEscapedChars(QTextDocument *pRawDoc);
-    void filterNoTranslate(QTextDocument *pRawDoc);
-    void replaceCodeblocks(QTextDocument *pRawDoc);
-    void reinstertNoTranslate(QTextDocument *pRawDoc);
-
-    static void removeComments(QTextDocument *pRawDoc);
-    static void generateParagraphs(QTextDocument *pRawDoc);
+    void filterEscapedChars(QString &sDoc);
+    void getNoTranslateFormats(QStringList &sListFormatStart,
+                               QStringList &sListFormatEnd,
+                               QStringList &sListHtmlStart,
+                               QStringList &sListHtmlEnd) const;
+    void filterNoTranslate(QString &sDoc);
+    void replaceCodeblocks(QString &sDoc);
+    void reinstertNoTranslate(QString &sDoc);
+
+    auto parseBlock(const QString &sBlock,
+                    const QStringList &sListTocHeadlines,
+                    QSet<QString> &setUsedKeys) -> ParsedBlock;
+    auto splitIntoBlocks(const QString &sDoc,
+                         QVector<int> &vBlockStarts) const -> QStringList;
+    auto getResourceStamp() const -> QString;
+    static auto isUpToDate(const ParsedBlock &block) -> bool;
+
+    static void normalizeText(QString &sDoc);
+    static void removeComments(QString &sDoc, QVector<int> &vSourceLines);
+    static void generateParagraphs(QString &sDoc);
 
 #ifdef USEQTWEBENGINE
-    void replaceFlags(QTextDocument *pRawDoc);
+    void replaceFlags(QString &sDoc);
 #endif
-    static void replaceQuotes(QTextDocument *pRawDoc);
-    static void replaceHorLines(QTextDocument *pRawDoc);
-    static auto replaceHeadlines(QTextDocument *pRawDoc) -> QStringList;
-    static void replaceFootnotes(QTextDocument *pRawDoc);
-    auto generateTags(QTextDocument *pRawDoc) -> QString;
+    static void replaceQuotes(QString &sDoc);
+    static void replaceHorLines(QString &sDoc);
+    static auto replaceHeadlines(QString &sDoc) -> QStringList;
+    static auto replaceFootnotes(QString &sDoc, quint16 &nIndex) -> QString;
+    auto generateTags(QString &sDoc) -> QString;
     auto highlightCode(const QString &sLanguage,
                        const QString &sCode) -> QString;
-
-    // Text from editor
-    QTextDocument *m_pRawText;
+    auto isCanceled() const -> bool;
 
     QStringList m_sListNoTranslate;
 
     ParseTemplates *m_pTemplateParser;
+    ParseTextformats *m_pTextformatParser;
+    ParseTextformats *m_pNoTranslateParser;  // Only formats not translated
+    QList<QRegularExpression> m_NoTranslateRegExps;
     ParseLinks *m_pLinkParser;
 
     const QString m_sSharePath;
@@ -101,7 +158,20 @@ class Parser : public QObject {
     Macros *m_pMacros;
     const QString m_sCommunity;
     const QString m_sPygmentize;
+    const bool m_bPygmentize;
+    PygmentsWorker *m_pPygments;
+    const bool m_bPreferPygments;
+    CodeHighlighter m_CodeHighlighter;
     quint32 m_nTimedPreview;
+    bool m_bBlockwise;
+    QStringList m_sListSpanStart;  // Markers which may span empty lines
+    QStringList m_sListSpanEnd;
+
+    int m_nGeneration;  // Request currently parsed, -1 if not cancelable
+    QAtomicInt m_nLatestGeneration;
+
+    QHash<QString, ParsedBlock> m_BlockCache;
+    QString m_sResourceStamp;
 };
 
 #endif  // APPLICATION_PARSER_PARSER_H_
@@ -18,6 +18,9 @@ INCLUDEPATH += $$PWD
 DEPENDPATH  += $$PWD
 
 HEADERS     += $$PWD/parser.h \
+               $$PWD/codehighlighter.h \
+               $$PWD/imagesizecache.h \
+               $$PWD/linkchecker.h \
                $$PWD/macros.h \
                $$PWD/parseimgmap.h \
                $$PWD/parselinks.h \
@@ -26,9 +29,14 @@ HEADERS     += $$PWD/parser.h \
                $$PWD/parsetemplates.h \
                $$PWD/parsetextformats.h \
                $$PWD/parsetxtmap.h \
-               $$PWD/provisionaltplparser.h
+               $$PWD/provisionaltplparser.h \
+               $$PWD/regexpregistry.h \
+               $$PWD/pygmentsworker.h
 
 SOURCES     += $$PWD/parser.cpp \
+               $$PWD/codehighlighter.cpp \
+               $$PWD/imagesizecache.cpp \
+               $$PWD/linkchecker.cpp \
                $$PWD/macros.cpp \
                $$PWD/parseimgmap.cpp \
                $$PWD/parselinks.cpp \
@@ -37,4 +45,6 @@ SOURCES     += $$PWD/parser.cpp \
                $$PWD/parsetemplates.cpp \
                $$PWD/parsetextformats.cpp \
                $$PWD/parsetxtmap.cpp \
-               $$PWD/provisionaltplparser.cpp
+               $$PWD/provisionaltplparser.cpp \
+               $$PWD/regexpregistry.cpp \
+               $$PWD/pygmentsworker.cpp
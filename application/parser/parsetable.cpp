@@ -26,47 +26,47 @@
 
 #include "./parsetable.h"
 
-#include <QRegExp>
 #include <QStringList>
-#include <QTextBlock>
-#include <QTextDocument>
+
+#include "./regexpregistry.h"
 
 ParseTable::ParseTable() = default;
 
-void ParseTable::startParsing(QTextDocument *pRawDoc) {
-  QString sDoc(QLatin1String(""));
+void ParseTable::startParsing(QString &sDoc) {
+  const QStringList sListRawLines(sDoc.split('\n'));
+  QString sOutput(QLatin1String(""));
   QString sLine(QLatin1String(""));
   QStringList sListLines;
   bool bTable = false;
 
-  // Go through each text block
-  for (QTextBlock block = pRawDoc->firstBlock();
-       block.isValid() && !(pRawDoc->lastBlock() < block);
-       block = block.next()) {
+  // Go through each line
+  for (int nLine = 0; nLine < sListRawLines.size(); nLine++) {
+    const QString &sRawLine(sListRawLines.at(nLine));
     // New cell or still in table with unfinished line
-    if (block.text().trimmed().startsWith(QLatin1String("||")) || bTable) {
+    if (sRawLine.trimmed().startsWith(QLatin1String("||")) || bTable) {
       bTable = true;
-      sLine += block.text();
+      sLine += sRawLine;
 
       // Line completed
-      if (block.text().trimmed().endsWith(QLatin1String("||"))) {
+      if (sRawLine.trimmed().endsWith(QLatin1String("||"))) {
         sListLines << sLine.trimmed();
         sLine.clear();
 
         // Table finished
-        if (!(block.next().text().trimmed().startsWith(QLatin1String("||")))) {
-          sDoc += createTable(sListLines);
+        if (!(sListRawLines.value(nLine + 1).trimmed().startsWith(
+                QLatin1String("||")))) {
+          sOutput += createTable(sListLines);
           sListLines.clear();
           sLine.clear();
           bTable = false;
         }
       }
     } else {  // Everything else
-      sDoc += block.text() + "\n";
+      sOutput += sRawLine + "\n";
     }
   }
 
-  pRawDoc->setPlainText(sDoc);
+  sDoc = sOutput;
 }
 
 // ----------------------------------------------------------------------------
@@ -79,19 +79,27 @@ auto ParseTable::createTable(const QStringList &sListLines) -> QString {
   QString sFormating(QLatin1String(""));
   QString sTmpStyle(QLatin1String(""));
 
-  QRegExp formatPattern(QLatin1String("\\<{1,1}.+\\>{1,1}"));
-  QRegExp tableClassPattern(
-        QLatin1String("tableclass=\\\"[\\w\\s:;%#-=]+\\\""));
-  QRegExp tableStylePattern(
-        QLatin1String("tablestyle=\\\"[\\w\\s:;%#-=]+\\\""));
-  QRegExp rowClassPattern(QLatin1String("rowclass=\\\"[\\w.%-]+\\\""));
-  QRegExp rowStylePattern(QLatin1String("rowstyle=\\\"[\\w\\s:;%#-=]+\\\""));
-  QRegExp cellClassPattern(QLatin1String("cellclass=\\\"[\\w.%-]+\\\""));
-  QRegExp cellStylePattern(QLatin1String("cellstyle=\\\"[\\w\\s:;%#-=]+\\\""));
+  static const QRegularExpression formatPattern(RegExpRegistry::get(
+      QStringLiteral("\\<{1,1}.+\\>{1,1}")));
+  static const QRegularExpression tableClassPattern(RegExpRegistry::get(
+      QStringLiteral("tableclass=\\\"[\\w\\s:;%#-=]+\\\"")));
+  static const QRegularExpression tableStylePattern(RegExpRegistry::get(
+      QStringLiteral("tablestyle=\\\"[\\w\\s:;%#-=]+\\\"")));
+  static const QRegularExpression rowClassPattern(RegExpRegistry::get(
+      QStringLiteral("rowclass=\\\"[\\w.%-]+\\\"")));
+  static const QRegularExpression rowStylePattern(RegExpRegistry::get(
+      QStringLiteral("rowstyle=\\\"[\\w\\s:;%#-=]+\\\"")));
+  static const QRegularExpression cellClassPattern(RegExpRegistry::get(
+      QStringLiteral("cellclass=\\\"[\\w.%-]+\\\"")));
+  static const QRegularExpression cellStylePattern(RegExpRegistry::get(
+      QStringLiteral("cellstyle=\\\"[\\w\\s:;%#-=]+\\\"")));
   bool bCellStyle;
 
-  QRegExp connectCells(QLatin1String("-\\d{1,2}"));
-  QRegExp connectRows(QLatin1String("\\|\\d{1,2}"));
+  static const QRegularExpression connectCells(RegExpRegistry::get(
+      QStringLiteral("-\\d{1,2}")));
+  static const QRegularExpression connectRows(RegExpRegistry::get(
+      QStringLiteral("\\|\\d{1,2}")));
+  QRegularExpressionMatch match;
 
   for (int nLine = 0; nLine < sListLines.size(); nLine++) {
     sLine = sListLines[nLine];
@@ -104,8 +112,9 @@ auto ParseTable::createTable(const QStringList &sListLines) -> QString {
       bCellStyle = false;
 
       // Look for formating
-      if (formatPattern.indexIn(sCell) >= 0) {
-        sFormating = formatPattern.cap();
+      match = RegExpRegistry::match(formatPattern, sCell);
+      if (match.hasMatch()) {
+        sFormating = match.captured();
         sCell.remove(sFormating);
       } else {
         sFormating.clear();
@@ -114,14 +123,16 @@ auto ParseTable::createTable(const QStringList &sListLines) -> QString {
       if (0 == nCell) {
         if (0 == nLine) {
           QString sTmpClass(QLatin1String(""));
-          if (tableClassPattern.indexIn(sFormating) >= 0) {
-            sTmpClass = tableClassPattern.cap();
+          match = RegExpRegistry::match(tableClassPattern, sFormating);
+          if (match.hasMatch()) {
+            sTmpClass = match.captured();
             sTmpClass = " class=" + sTmpClass.remove(
                           QStringLiteral("tableclass="));
           }
           sTmpStyle.clear();
-          if (tableStylePattern.indexIn(sFormating) >= 0) {
-            sTmpStyle = tableStylePattern.cap();
+          match = RegExpRegistry::match(tableStylePattern, sFormating);
+          if (match.hasMatch()) {
+            sTmpStyle = match.captured();
             sTmpStyle = " style=" + sTmpStyle.remove(
                           QStringLiteral("tablestyle="));
           }
@@ -131,14 +142,16 @@ auto ParseTable::createTable(const QStringList &sListLines) -> QString {
         // New row
         sRet += QLatin1String("<tr");  // Start tr
         // Found row class info --> in tr
-        if (rowClassPattern.indexIn(sFormating) >= 0) {
-          sTmpStyle = rowClassPattern.cap();
+        match = RegExpRegistry::match(rowClassPattern, sFormating);
+        if (match.hasMatch()) {
+          sTmpStyle = match.captured();
           sRet += " class="
                   + sTmpStyle.remove(QStringLiteral("rowclass="));
         }
         // Found row sytle info --> in tr
-        if (rowStylePattern.indexIn(sFormating) >= 0) {
-          sTmpStyle = rowStylePattern.cap();
+        match = RegExpRegistry::match(rowStylePattern, sFormating);
+        if (match.hasMatch()) {
+          sTmpStyle = match.captured();
           sRet += " style=\""
                   + sTmpStyle.remove(QStringLiteral("rowstyle="))
                   .remove(QStringLiteral("\"")) + "\"";
@@ -150,27 +163,31 @@ auto ParseTable::createTable(const QStringList &sListLines) -> QString {
       sRet += QLatin1String("<td");  // Start td
 
       // Found cell class info --> in td
-      if (cellClassPattern.indexIn(sFormating) >= 0) {
-        sTmpStyle = cellClassPattern.cap();
+      match = RegExpRegistry::match(cellClassPattern, sFormating);
+      if (match.hasMatch()) {
+        sTmpStyle = match.captured();
         sRet += " class="
                 + sTmpStyle.remove(QStringLiteral("cellclass="));
       }
 
       // Connect cells info (-integer, e.g. -3)
-      if (connectCells.indexIn(sFormating) >= 0) {
+      match = RegExpRegistry::match(connectCells, sFormating);
+      if (match.hasMatch()) {
         sRet += " colspan=\""
-                + connectCells.cap().remove(QStringLiteral("-")) + "\"";
+                + match.captured().remove(QStringLiteral("-")) + "\"";
       }
 
       // Connect ROWS info (|integer, e.g. |2)
-      if (connectRows.indexIn(sFormating) >= 0) {
+      match = RegExpRegistry::match(connectRows, sFormating);
+      if (match.hasMatch()) {
         sRet += " rowspan=\""
-                + connectRows.cap().remove(QStringLiteral("|")) + "\"";
+                + match.captured().remove(QStringLiteral("|")) + "\"";
       }
 
       // Found cell sytle info --> in td
-      if (cellStylePattern.indexIn(sFormating) >= 0) {
-        sTmpStyle = cellStylePattern.cap();
+      match = RegExpRegistry::match(cellStylePattern, sFormating);
+      if (match.hasMatch()) {
+        sTmpStyle = match.captured();
         sRet += " style=\""
                 + sTmpStyle.remove(QStringLiteral("cellstyle="))
                 .remove(QStringLiteral("\""));
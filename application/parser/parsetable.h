@@ -29,13 +29,12 @@
 
 #include <QString>
 
-class QTextDocument;
 class QStringList;
 
 class ParseTable {
  public:
     ParseTable();
-    static void startParsing(QTextDocument *pRawDoc);
+    static void startParsing(QString &sDoc);
 
  private:
     static auto createTable(const QStringList &sListLines) -> QString;
@@ -27,9 +27,14 @@
 #include "./parsetemplates.h"
 
 #include <QDebug>
-#include <QTextDocument>
 
+#include "./imagesizecache.h"
 #include "./provisionaltplparser.h"
+#include "./regexpregistry.h"
+
+namespace {
+const int MAX_CACHED_CHARS = 4 * 1024 * 1024;  // Total length of expansions
+}  // namespace
 
 ParseTemplates::ParseTemplates(const QStringList &sListTransTpl,
                                const QStringList &sListTplNames,
@@ -42,7 +47,8 @@ ParseTemplates::ParseTemplates(const QStringList &sListTransTpl,
                                const QStringList &sListTestedWithTouchStrings,
                                const QString &sCommunity)
   : m_sListTransTpl(sListTransTpl),
-    m_sListTplNames(sListTplNames) {
+    m_sListTplNames(sListTplNames),
+    m_ExpansionCache(MAX_CACHED_CHARS) {
   m_pProvTplTarser = new ProvisionalTplParser(sListHtmlStart,
                                               sSharePath,
                                               tmpImgDir,
@@ -51,32 +57,39 @@ ParseTemplates::ParseTemplates(const QStringList &sListTransTpl,
                                               sListTestedWithTouch,
                                               sListTestedWithTouchStrings,
                                               sCommunity);
+
+  const QRegularExpression::PatternOptions options(
+        QRegularExpression::CaseInsensitiveOption |
+        QRegularExpression::InvertedGreedinessOption |
+        QRegularExpression::DotMatchesEverythingOption);
+  for (const auto &s : qAsConst(m_sListTransTpl)) {
+    m_FindTemplates << RegExpRegistry::get(
+                         "\\{\\{\\{#!" + s + " .+\\}\\}\\}", options)
+                    << RegExpRegistry::get(
+                         "\\[\\[" + s + "\\s*\\(.+\\)\\]\\]", options);
+    m_sListFindTemplatesTrans << s << s;
+  }
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void ParseTemplates::startParsing(QTextDocument *pRawDoc,
+void ParseTemplates::startParsing(QString &sDoc,
                                   const QString &sCurrentFile) {
   m_sCurrentFile = sCurrentFile;
-
-  QStringList sListTplRegExp;
-  QStringList sListTrans;
-  for (const auto &s : qAsConst(m_sListTransTpl)) {
-    sListTplRegExp << "\\{\\{\\{#!" + s + " .+\\}\\}\\}"
-                   << "\\[\\[" + s + "\\s*\\(.+\\)\\]\\]";
-    sListTrans << s << s;
-  }
-  QString sDoc(pRawDoc->toPlainText());
+  m_UsedImageSizes.clear();
+  static const QRegularExpression findSpaces(
+        RegExpRegistry::get(QStringLiteral("\\s+")));
+  const QStringList &sListTrans(m_sListFindTemplatesTrans);
   QStringList sListArguments;
 
-  for (int k = 0; k < sListTplRegExp.size(); k++) {
-    QRegExp findTemplate(sListTplRegExp[k], Qt::CaseInsensitive);
-    findTemplate.setMinimal(true);
-    int nPos = 0;
+  for (int k = 0; k < m_FindTemplates.size(); k++) {
+    const QRegularExpression &findTemplate(m_FindTemplates.at(k));
+    QRegularExpressionMatch match(RegExpRegistry::match(findTemplate, sDoc));
+    int nPos;
 
-    while ((nPos = findTemplate.indexIn(sDoc, nPos)) != -1) {
-      QString sMacro = findTemplate.cap(0);
+    while ((nPos = match.capturedStart()) != -1) {
+      QString sMacro = match.captured(0);
       QString sBackupMacro = sMacro;
       if (sMacro.startsWith("[[" + sListTrans[k], Qt::CaseInsensitive)) {
         // Step needed because of possible spaces
@@ -95,8 +108,7 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
 
           // Extract arguments
           // Split by ',' but don't split quoted strings with comma
-          const QStringList tmpList = sMacro.split(
-                QRegExp(QLatin1String("\"")));
+          const QStringList tmpList = sMacro.split('"');
           bool bInside = false;
           for (const auto &s : tmpList) {
             if (bInside) {
@@ -105,11 +117,9 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
             } else {
               // If 's' is outside quotes, get the splitted string
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-              sListArguments.append(s.split(QRegExp(QLatin1String(",+")),
-                                            QString::SkipEmptyParts));
+              sListArguments.append(s.split(',', QString::SkipEmptyParts));
 #else
-              sListArguments.append(s.split(QRegExp(QLatin1String(",+")),
-                                            Qt::SkipEmptyParts));
+              sListArguments.append(s.split(',', Qt::SkipEmptyParts));
 #endif
             }
             bInside = !bInside;
@@ -122,11 +132,9 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
               QString sTmp = sListArguments[m];
               QStringList tmpArgs;
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-              tmpArgs << sTmp.split(QRegExp(QLatin1String("\\n")),
-                                    QString::SkipEmptyParts);
+              tmpArgs << sTmp.split('\n', QString::SkipEmptyParts);
 #else
-              tmpArgs << sTmp.split(QRegExp(QLatin1String("\\n")),
-                                    Qt::SkipEmptyParts);
+              tmpArgs << sTmp.split('\n', Qt::SkipEmptyParts);
 #endif
               for (int j = 0; j < tmpArgs.size(); j++) {
                 sListArguments.insert(m + j + 1, tmpArgs[j]);
@@ -146,13 +154,12 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
           sListArguments.clear();
 
           // Extract arguments
-          sListArguments = sMacro.split(QRegExp(QLatin1String("\\n")));
+          sListArguments = sMacro.split('\n');
 
           if (!sListArguments.isEmpty()) {
             // Split by ' ' - don't split quoted strings with space
             QStringList sList;
-            const QStringList sL = sListArguments[0].split(
-                  QRegExp(QLatin1String("\"")));
+            const QStringList sL = sListArguments[0].split('"');
             bool bInside = false;
             for (const auto &s : sL) {
               if (bInside) {
@@ -161,11 +168,9 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
               } else {
                 // If 's' is outside quotes, get splitted string
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-                sList.append(s.split(QRegExp(QLatin1String("\\s+")),
-                                     QString::SkipEmptyParts));
+                sList.append(s.split(findSpaces, QString::SkipEmptyParts));
 #else
-                sList.append(s.split(QRegExp(QLatin1String("\\s+")),
-                                     Qt::SkipEmptyParts));
+                sList.append(s.split(findSpaces, Qt::SkipEmptyParts));
 #endif
               }
               bInside = !bInside;
@@ -191,16 +196,78 @@ void ParseTemplates::startParsing(QTextDocument *pRawDoc,
       }
 
       // qDebug() << "TPL:" << sListArguments;
-      sMacro = m_pProvTplTarser->parseTpl(sListArguments, m_sCurrentFile);
+      sMacro = this->expandTemplate(sListArguments);
       if (sMacro.isEmpty()) {
         sMacro = sBackupMacro;
       }
-      sDoc.replace(nPos, findTemplate.matchedLength(), sMacro);
+      sDoc.replace(nPos, match.capturedLength(), sMacro);
 
       // Go on with new start position
-      nPos += sMacro.length();
+      match = RegExpRegistry::match(findTemplate, sDoc,
+                                    nPos + sMacro.length());
     }
   }
+}
+
+// ----------------------------------------------------------------------------
+
+void ParseTemplates::clearCache() {
+  m_ExpansionCache.clear();
+}
+
+void ParseTemplates::logStatistics() const {
+  m_pProvTplTarser->logStatistics();
+}
+
+void ParseTemplates::resetStatistics() {
+  m_pProvTplTarser->resetStatistics();
+}
+
+auto ParseTemplates::getUsedImageSizes() const -> QHash<QString, QSize> {
+  return m_UsedImageSizes;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto ParseTemplates::expandTemplate(const QStringList &sListArgs) -> QString {
+  // Relative image paths depend on the current file
+  const QString sKey(m_sCurrentFile + QChar::Null +
+                     sListArgs.join(QChar::Null));
+  const TplExpansion *pCached = m_ExpansionCache.object(sKey);
+  if (nullptr != pCached && ParseTemplates::isUpToDate(*pCached)) {
+    this->addUsedImageSizes(pCached->imageSizes);
+    return pCached->sHtml;
+  }
+
+  auto *pExpansion = new TplExpansion;
+  pExpansion->sHtml = m_pProvTplTarser->parseTpl(sListArgs, m_sCurrentFile);
+  pExpansion->imageSizes = m_pProvTplTarser->getUsedImageSizes();
+  this->addUsedImageSizes(pExpansion->imageSizes);
+  const QString sHtml(pExpansion->sHtml);
+  // Cache takes ownership
+  m_ExpansionCache.insert(sKey, pExpansion, qMax(1, sHtml.size()));
+  return sHtml;
+}
 
-  pRawDoc->setPlainText(sDoc);
+// ----------------------------------------------------------------------------
+
+// No QHash::unite(), which would add duplicate keys (Qt 5)
+void ParseTemplates::addUsedImageSizes(const QHash<QString, QSize> &sizes) {
+  for (auto it = sizes.constBegin(); it != sizes.constEnd(); ++it) {
+    m_UsedImageSizes.insert(it.key(), it.value());
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Image sizes are checked on disk at most once per parsing run
+auto ParseTemplates::isUpToDate(const TplExpansion &expansion) -> bool {
+  for (auto it = expansion.imageSizes.constBegin();
+       it != expansion.imageSizes.constEnd(); ++it) {
+    if (ImageSizeCache::size(it.key()) != it.value()) {
+      return false;
+    }
+  }
+  return true;
 }
@@ -27,11 +27,15 @@
 #ifndef APPLICATION_PARSER_PARSETEMPLATES_H_
 #define APPLICATION_PARSER_PARSETEMPLATES_H_
 
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QSize>
 #include <QString>
 #include <QStringList>
 
 class QDir;
-class QTextDocument;
 
 class ProvisionalTplParser;
 
@@ -48,13 +52,36 @@ class ParseTemplates {
                    const QStringList &sListTestedWithTouchStrings,
                    const QString &sCommunity);
 
-    void startParsing(QTextDocument *pRawDoc, const QString &sCurrentFile);
+    void startParsing(QString &sDoc, const QString &sCurrentFile);
+    // Images (and their sizes) used by the templates of the last
+    // startParsing() call
+    auto getUsedImageSizes() const -> QHash<QString, QSize>;
+    // Has to be called if images or templates may have changed
+    void clearCache();
+    // Template statistics of all startParsing() calls since the reset
+    void logStatistics() const;
+    void resetStatistics();
 
  private:
+    struct TplExpansion {
+      QString sHtml;
+      QHash<QString, QSize> imageSizes;  // Images the output depends on
+    };
+
+    auto expandTemplate(const QStringList &sListArgs) -> QString;
+    void addUsedImageSizes(const QHash<QString, QSize> &sizes);
+    static auto isUpToDate(const TplExpansion &expansion) -> bool;
+
     ProvisionalTplParser *m_pProvTplTarser;
     QStringList m_sListTransTpl;
     QStringList m_sListTplNames;
+    // {{{#!tpl ...}}} and [[tpl(...)]] for each translation
+    QList<QRegularExpression> m_FindTemplates;
+    QStringList m_sListFindTemplatesTrans;
     QString m_sCurrentFile;
+    QHash<QString, QSize> m_UsedImageSizes;
+    // Least recently used expansions by file, template name and arguments
+    QCache<QString, TplExpansion> m_ExpansionCache;
 };
 
 #endif  // APPLICATION_PARSER_PARSETEMPLATES_H_
@@ -26,132 +26,137 @@
 
 #include "./parsetextformats.h"
 
-#include <QRegExp>
-#include <QTextDocument>
+#include <limits>
 
-ParseTextformats::ParseTextformats() = default;
+#include "./regexpregistry.h"
 
-void ParseTextformats::startParsing(QTextDocument *pRawDoc,
-                                    const QStringList &sListFormatStart,
-                                    const QStringList &sListFormatEnd,
-                                    const QStringList &sListHtmlStart,
-                                    const QStringList &sListHtmlEnd) {
-  QString sDoc(pRawDoc->toPlainText());
-  QRegExp patternTextformat;
-  QString sTmpRegExp;
-  int nIndex;
-  int nLength;
+ParseTextformats::ParseTextformats(const QStringList &sListFormatStart,
+                                   const QStringList &sListFormatEnd,
+                                   const QStringList &sListHtmlStart,
+                                   const QStringList &sListHtmlEnd)
+  : m_sListHtmlStart(sListHtmlStart),
+    m_sListHtmlEnd(sListHtmlEnd) {
+  for (int i = 0; i < sListFormatStart.size(); i++) {
+    if (sListFormatStart[i] == sListFormatEnd[i]) {
+      const bool bRegExp(
+            sListFormatStart[i].startsWith(QLatin1String("RegExp=")));
+      this->addKeyword(sListFormatStart[i], bRegExp ? Start : Toggle, i);
+    } else {
+      this->addKeyword(sListFormatStart[i], Start, i);
+      this->addKeyword(sListFormatEnd[i], End, i);
+    }
+  }
+}
 
-  patternTextformat.setCaseSensitivity(Qt::CaseInsensitive);
-  patternTextformat.setMinimal(true);  // Search only for smallest match
+// ----------------------------------------------------------------------------
+
+void ParseTextformats::addKeyword(const QString &sKeyword,
+                                  const KeywordType type,
+                                  const int nFormat) {
+  Keyword keyword;
+  keyword.type = type;
+  keyword.nFormat = nFormat;
+  keyword.bRegExp = sKeyword.startsWith(QLatin1String("RegExp="));
+
+  if (keyword.bRegExp) {
+    QString sPattern(sKeyword);
+    sPattern.remove(QStringLiteral("RegExp="));
+    // Search only for smallest match
+    keyword.regexp = RegExpRegistry::get(
+                       sPattern.trimmed(),
+                       QRegularExpression::CaseInsensitiveOption |
+                       QRegularExpression::InvertedGreedinessOption);
+    if (!keyword.regexp.isValid()) {
+      return;  // Already reported by registry
+    }
+    m_Keywords << keyword;
+    m_vRegExps << m_Keywords.size() - 1;
+  } else if (!sKeyword.isEmpty()) {
+    keyword.sText = sKeyword;
+    m_Keywords << keyword;
+    m_LiteralsByChar[sKeyword.at(0).unicode()] << m_Keywords.size() - 1;
+  }
+}
 
-  for (int i = 0; i < sListFormatStart.size(); i++) {
-    bool bFoundStart = true;
-
-    // Start and end is not identical
-    if (sListFormatStart[i] != sListFormatEnd[i]) {
-      if (!sListFormatStart[i].startsWith(QLatin1String("RegExp="))) {
-        sDoc.replace(sListFormatStart[i], sListHtmlStart[i]);
-      } else {
-        sTmpRegExp = sListFormatStart[i];
-        sTmpRegExp.remove(QStringLiteral("RegExp="));
-        sTmpRegExp = sTmpRegExp.trimmed();
-        patternTextformat.setPattern(sTmpRegExp);
-
-        nIndex = patternTextformat.indexIn(sDoc);
-
-        while (nIndex >= 0) {
-          QString sCap(QLatin1String(""));
-          nLength = patternTextformat.matchedLength();
-          sCap = patternTextformat.cap(1);
-
-          if (sCap.isEmpty()) {
-            sDoc.replace(nIndex, nLength, sListHtmlStart[i]);
-          } else {
-            sDoc.replace(nIndex, nLength,
-                         sListHtmlStart[i].arg(sCap));
-          }
-
-          // Go on with RegExp-Search
-          nIndex = patternTextformat.indexIn(sDoc, nIndex + nLength);
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void ParseTextformats::startParsing(QString &sDoc) const {
+  const int NO_MATCH = std::numeric_limits<int>::max();
+  // Next match of each regular expression, searched again once passed
+  QVector<QRegularExpressionMatch> vMatches(m_vRegExps.size());
+  QVector<int> vNextMatch(m_vRegExps.size(), -1);
+  QVector<bool> vOpen(m_sListHtmlStart.size(), false);
+  QString sResult;
+  int nCopied = 0;
+  int nPos = 0;
+
+  while (nPos < sDoc.length()) {
+    int nBest = -1;
+    int nLength = 0;
+    QString sCap;
+
+    const auto it = m_LiteralsByChar.constFind(sDoc.at(nPos).unicode());
+    if (m_LiteralsByChar.constEnd() != it) {
+      for (const int k : it.value()) {
+        if (sDoc.midRef(nPos, m_Keywords.at(k).sText.length()) ==
+            m_Keywords.at(k).sText) {
+          nBest = k;
+          nLength = m_Keywords.at(k).sText.length();
+          break;
         }
       }
-      if (!sListFormatEnd[i].startsWith(QLatin1String("RegExp="))) {
-        sDoc.replace(sListFormatEnd[i], sListHtmlEnd[i]);
-      } else {
-        sTmpRegExp = sListFormatEnd[i];
-        sTmpRegExp.remove(QStringLiteral("RegExp="));
-        sTmpRegExp = sTmpRegExp.trimmed();
-        patternTextformat.setPattern(sTmpRegExp);
-
-        nIndex = patternTextformat.indexIn(sDoc);
-
-        while (nIndex >= 0) {
-          QString sCap(QLatin1String(""));
-          nLength = patternTextformat.matchedLength();
-          sCap = patternTextformat.cap(1);
-
-          if (sCap.isEmpty()) {
-            sDoc.replace(nIndex, nLength, sListHtmlEnd[i]);
-          } else {
-            sDoc.replace(nIndex, nLength,
-                         sListHtmlEnd[i].arg(sCap));
-          }
-
-          // Go on with RegExp-Search
-          nIndex = patternTextformat.indexIn(sDoc, nIndex + nLength);
-        }
+    }
+
+    for (int i = 0; i < m_vRegExps.size(); i++) {
+      const int k = m_vRegExps.at(i);
+      if (-1 != nBest && k > nBest) {
+        break;
       }
-    } else {  // Start and end is identical
-      if (!sListFormatStart[i].startsWith(QLatin1String("RegExp="))) {
-        while (-1 != sDoc.indexOf(sListFormatStart[i])) {
-          if (bFoundStart) {
-            sDoc.replace(sDoc.indexOf(sListFormatStart[i]),
-                         sListFormatStart[i].length(),
-                         sListHtmlStart[i]);
-          } else {
-            sDoc.replace(sDoc.indexOf(sListFormatStart[i]),
-                         sListFormatStart[i].length(),
-                         sListHtmlEnd[i]);
-          }
-          bFoundStart = !bFoundStart;
-        }
-      } else {
-        sTmpRegExp = sListFormatStart[i];
-        sTmpRegExp.remove(QStringLiteral("RegExp="));
-        sTmpRegExp = sTmpRegExp.trimmed();
-        patternTextformat.setPattern(sTmpRegExp);
-
-        nIndex = patternTextformat.indexIn(sDoc);
-
-        while (nIndex >= 0) {
-          QString sCap(QLatin1String(""));
-          nLength = patternTextformat.matchedLength();
-          sCap = patternTextformat.cap(1);
-
-          if (sCap.isEmpty()) {
-            if (bFoundStart) {
-              sDoc.replace(nIndex, nLength, sListHtmlStart[i]);
-            } else {
-              sDoc.replace(nIndex, nLength, sListHtmlEnd[i]);
-            }
-          } else {
-            if (bFoundStart) {
-              sDoc.replace(nIndex, nLength,
-                           sListHtmlStart[i].arg(sCap));
-            } else {
-              sDoc.replace(nIndex, nLength,
-                           sListHtmlEnd[i].arg(sCap));
-            }
-          }
-
-          // Go on with RegExp-Search
-          nIndex = patternTextformat.indexIn(sDoc, nIndex + nLength);
-        }
+      if (vNextMatch.at(i) < nPos) {
+        vMatches[i] = RegExpRegistry::match(m_Keywords.at(k).regexp, sDoc,
+                                            nPos);
+        vNextMatch[i] = vMatches.at(i).hasMatch()
+                        ? vMatches.at(i).capturedStart() : NO_MATCH;
+      }
+      if (vNextMatch.at(i) == nPos && vMatches.at(i).capturedLength() > 0) {
+        nBest = k;
+        nLength = vMatches.at(i).capturedLength();
+        sCap = vMatches.at(i).captured(1);
+        break;
       }
     }
+
+    if (-1 == nBest) {
+      nPos++;
+      continue;
+    }
+    if (0 == nCopied) {
+      sResult.reserve(sDoc.length());
+    }
+    sResult += sDoc.midRef(nCopied, nPos - nCopied);
+    sResult += this->getHtml(m_Keywords.at(nBest), sCap, vOpen);
+    nPos += nLength;
+    nCopied = nPos;
+  }
+
+  if (nCopied > 0) {
+    sResult += sDoc.midRef(nCopied);
+    sDoc = sResult;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+auto ParseTextformats::getHtml(const Keyword &keyword, const QString &sCap,
+                               QVector<bool> &vOpen) const -> QString {
+  bool bStart = (Start == keyword.type);
+  if (Toggle == keyword.type) {
+    bStart = !vOpen.at(keyword.nFormat);
+    vOpen[keyword.nFormat] = bStart;
   }
 
-  // Replace pRawDoc with adapted document
-  pRawDoc->setPlainText(sDoc);
+  const QString &sHtml(bStart ? m_sListHtmlStart.at(keyword.nFormat)
+                              : m_sListHtmlEnd.at(keyword.nFormat));
+  return sCap.isEmpty() ? sHtml : sHtml.arg(sCap);
 }
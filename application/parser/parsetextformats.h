@@ -27,18 +27,60 @@
 #ifndef APPLICATION_PARSER_PARSETEXTFORMATS_H_
 #define APPLICATION_PARSER_PARSETEXTFORMATS_H_
 
+#include <QHash>
+#include <QRegularExpression>
 #include <QStringList>
+#include <QVector>
 
-class QTextDocument;
-
+/**
+ * \class ParseTextformats
+ * \brief Converts inline text formats (bold, italic, ...) in one scan.
+ *
+ * Start and end keywords of all formats are compiled once. If several
+ * keywords match at the same position, the one defined first in
+ * Textformats.conf wins (start before end). Unlike replacing the formats
+ * one after another, a keyword overlapping a keyword of a format defined
+ * earlier but starting later is converted, too. Inserted HTML is not
+ * scanned again.
+ *
+ * Identical literal start and end keywords are toggling. Identical regular
+ * expressions always insert the start HTML, as they always did.
+ */
 class ParseTextformats {
  public:
-    ParseTextformats();
-    static void startParsing(QTextDocument *pRawDoc,
-                             const QStringList &sListFormatStart,
-                             const QStringList &sListFormatEnd,
-                             const QStringList &sListHtmlStart,
-                             const QStringList &sListHtmlEnd);
+    ParseTextformats(const QStringList &sListFormatStart,
+                     const QStringList &sListFormatEnd,
+                     const QStringList &sListHtmlStart,
+                     const QStringList &sListHtmlEnd);
+
+    // Thread-safe
+    void startParsing(QString &sDoc) const;
+
+ private:
+    enum KeywordType {
+      Start,
+      End,
+      Toggle  // Start and end are identical literals
+    };
+
+    struct Keyword {
+      QString sText;  // Literal keyword, if bRegExp is false
+      QRegularExpression regexp;
+      bool bRegExp;
+      KeywordType type;
+      int nFormat;
+    };
+
+    void addKeyword(const QString &sKeyword, const KeywordType type,
+                    const int nFormat);
+    auto getHtml(const Keyword &keyword, const QString &sCap,
+                 QVector<bool> &vOpen) const -> QString;
+
+    QVector<Keyword> m_Keywords;  // In order of precedence
+    QHash<ushort, QVector<int>> m_LiteralsByChar;  // By first character
+    QVector<int> m_vRegExps;
+    QStringList m_sListHtmlStart;
+    QStringList m_sListHtmlEnd;
 };
 
 #endif  // APPLICATION_PARSER_PARSETEXTFORMATS_H_
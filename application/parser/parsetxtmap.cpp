@@ -26,30 +26,19 @@
 
 #include "./parsetxtmap.h"
 
-#include <QDebug>
-#include <QTextDocument>
+#include "../templates/multireplacer.h"
 
 ParseTxtMap::ParseTxtMap() = default;
 
-void ParseTxtMap::startParsing(QTextDocument *pRawDoc,
-                               QStringList sListElements,
-                               QStringList sListText) {
-  QString sDoc(pRawDoc->toPlainText());
-  QString sReplace;
-
-  for (int i = 0; i < sListElements.size(); i++) {
-    if (0 == i && "error" == sListElements[0].toLower()) {
-      qCritical() << "Error while parsing text map.";
-      break;
-    }
-    sReplace = sListText[i];
+void ParseTxtMap::startParsing(QString &sDoc,
+                               const MultiReplacer &replacer,
+                               const QStringList &sListText) {
+  replacer.replaceAll(sDoc, [&sListText](const int nIndex) {
+    QString sReplace(sListText.at(nIndex));
     if (sReplace.startsWith(QLatin1String("css-class:"))) {
       sReplace = sReplace.remove(QStringLiteral("css-class:"));
       sReplace = "<span class=\"" + sReplace + "\"></span>";
     }
-    sDoc.replace(sListElements[i], sReplace);
-  }
-
-  // Replace raw document with new replaced doc
-  pRawDoc->setPlainText(sDoc);
+    return sReplace;
+  });
 }
@@ -29,14 +29,15 @@
 
 #include <QStringList>
 
-class QTextDocument;
+class MultiReplacer;
 
 class ParseTxtMap {
  public:
     ParseTxtMap();
-    static void startParsing(QTextDocument *pRawDoc,
-                             QStringList sListElements,
-                             QStringList sListText);
+    // Elements are found by replacer, sListText contains their mappings
+    static void startParsing(QString &sDoc,
+                             const MultiReplacer &replacer,
+                             const QStringList &sListText);
 };
 
 #endif  // APPLICATION_PARSER_PARSETXTMAP_H_
@@ -30,8 +30,18 @@
 #include "./provisionaltplparser.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
-#include <QImage>
+#include <QSize>
+
+#include <algorithm>
+
+#include "./imagesizecache.h"
+#include "./regexpregistry.h"
+
+namespace {
+bool g_bStatistics = false;  // Not changed while parsing
+}  // namespace
 
 ProvisionalTplParser::ProvisionalTplParser(
     const QStringList &sListHtmlStart,
@@ -58,183 +68,231 @@ ProvisionalTplParser::ProvisionalTplParser(
 auto ProvisionalTplParser::parseTpl(const QStringList &sListArgs,
                                     const QString &sCurrentFile) -> QString {
   m_sCurrentFile = sCurrentFile;
+  m_UsedImageSizes.clear();
+  if (sListArgs.isEmpty()) {
+    return QString();
+  }
 
-  QStringList sArgs = sListArgs;
-  if (!sArgs.isEmpty()) {
-    if (sArgs[0].toLower() == QString::fromUtf8("Fortgeschritten").toLower()) {
-      return ProvisionalTplParser::parseAdvanced();
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Archiviert").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseArchived(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Befehl").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseBash(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Builddeps").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseBuilddeps(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Code").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseCode(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Kopie").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseCopy(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Experten").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseExperts(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Fehlerhaft").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseFixme(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Fremdquelle-auth").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseForeignAuth(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Fremdquelle").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseForeignSource(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Fremdpaket").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseForeignPackage(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Fremd").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseForeignWarning(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Icon-Übersicht").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseIconOverview(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("IkhayaAutor").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseIkhayaAuthor(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Ikhaya-Award").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseIkhayaAward(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Ikhayabild").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseIkhayaImage(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8(
-                 "Ikhaya-Projektvorstellung").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseIkhayaProjectPresentation();
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Bildersammlung").toLower()) {
-      sArgs.removeFirst();
-      return this->parseImageCollect(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Bildunterschrift").toLower()) {
-      sArgs.removeFirst();
-      return this->parseImageSub(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Ausbaufähig").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseImprovable(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Infobox").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseInfobox(sArgs);
-    }
-    if (sArgs[0].trimmed().toLower() == QString::fromUtf8("Tasten").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseKeys(sArgs);
-    }
-    if (sArgs[0].trimmed().toLower() == QString::fromUtf8("Wissen").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseKnowledge(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Verlassen").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseLeft(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Hinweis").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseNotice(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("OBS").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseOBS(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8(
-                 "Uebersicht").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseOverview(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Uebersicht2").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseOverview2(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Pakete").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parsePackage(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("PipInstallation").toLower()) {
-      sArgs.removeFirst();
-      return this->parsePipInstall(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8(
-                 "Paketinstallation").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parsePkgInstall(sArgs);
-    }
-    if (sArgs[0].trimmed().toLower() == QString::fromUtf8(
-                 "Installbutton").toLower()) {
-      sArgs.removeFirst();
-      return this->parsePkgInstallBut(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("PPA").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parsePPA(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Projekte").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseProjects(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Seitenleiste").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseSidebar(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("StatusIcon").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseStatusIcon(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Tabelle").toLower()) {
-      sArgs.removeFirst();
-      return this->parseTable(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Getestet").toLower()) {
-      sArgs.removeFirst();
-      return this->parseTested(sArgs);
-    }
-    if (sArgs[0].trimmed().toLower() == QString::fromUtf8("UT").toLower()) {
-      sArgs.removeFirst();
-      return this->parseTestedUT(sArgs);
-    }
-    if (sArgs[0].trimmed().toLower() == QString::fromUtf8(
-          "Baustelle").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseUnderConst(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Warnung").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseWarning(sArgs);
-    }
-    if (sArgs[0].toLower() == QString::fromUtf8("Überarbeitung").toLower()) {
-      sArgs.removeFirst();
-      return ProvisionalTplParser::parseWorkInProgr(sArgs);
+  const QHash<QString, TplHandler> &handlers(
+        ProvisionalTplParser::getHandlers());
+  QString sName(sListArgs.at(0).toLower());
+  auto it = handlers.constFind(sName);
+  if (handlers.constEnd() == it) {
+    // Some templates are found with surrounding spaces, too
+    sName = sName.trimmed();
+    it = handlers.constFind(sName);
+    if (handlers.constEnd() == it || !it->bTrimmed) {
+      return QString();
     }
   }
-  return "";
+
+  if (!g_bStatistics) {
+    return it->handler(this, sListArgs.mid(1));
+  }
+  QElapsedTimer timer;
+  timer.start();
+  const QString sOutput(it->handler(this, sListArgs.mid(1)));
+  TplStatistics &statistics = m_Statistics[sName];
+  statistics.nCalls++;
+  statistics.nNanoSecs += timer.nsecsElapsed();
+  return sOutput;
+}
+
+// ----------------------------------------------------------------------------
+
+auto ProvisionalTplParser::getUsedImageSizes() const -> QHash<QString, QSize> {
+  return m_UsedImageSizes;
+}
+
+// ----------------------------------------------------------------------------
+
+void ProvisionalTplParser::setStatisticsEnabled(const bool bEnabled) {
+  g_bStatistics = bEnabled;
+}
+
+void ProvisionalTplParser::logStatistics() const {
+  if (!g_bStatistics) {
+    return;
+  }
+  QStringList sListNames(m_Statistics.keys());
+  std::sort(sListNames.begin(), sListNames.end(),
+            [this](const QString &a, const QString &b) {
+    return m_Statistics[a].nNanoSecs > m_Statistics[b].nNanoSecs;
+  });
+  for (const auto &sName : qAsConst(sListNames)) {
+    const TplStatistics &statistics = m_Statistics[sName];
+    qDebug() << "Template" << sName << "calls:" << statistics.nCalls
+             << "total ms:" << statistics.nNanoSecs / 1000000.0;
+  }
+}
+
+void ProvisionalTplParser::resetStatistics() {
+  m_Statistics.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+// Lookup table is built once; keys are lower case template names
+auto ProvisionalTplParser::getHandlers() -> const QHash<QString, TplHandler> & {
+  static const QHash<QString, TplHandler> handlers(
+        ProvisionalTplParser::createHandlers());
+  return handlers;
+}
+
+// ----------------------------------------------------------------------------
+
+auto ProvisionalTplParser::createHandlers() -> QHash<QString, TplHandler> {
+  QHash<QString, TplHandler> handlers;
+  auto add = [&handlers](const char *sName, Handler handler) {
+    TplHandler tplHandler;
+    tplHandler.handler = handler;
+    tplHandler.bTrimmed = false;
+    handlers.insert(QString::fromUtf8(sName).toLower(), tplHandler);
+  };
+
+  add("Fortgeschritten", [](ProvisionalTplParser *, const QStringList &) {
+    return ProvisionalTplParser::parseAdvanced();
+  });
+  add("Archiviert", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseArchived(sArgs);
+  });
+  add("Befehl", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseBash(sArgs);
+  });
+  add("Builddeps", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseBuilddeps(sArgs);
+  });
+  add("Code", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseCode(sArgs);
+  });
+  add("Kopie", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseCopy(sArgs);
+  });
+  add("Experten", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseExperts(sArgs);
+  });
+  add("Fehlerhaft", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseFixme(sArgs);
+  });
+  add("Fremdquelle-auth", [](ProvisionalTplParser *,
+                             const QStringList &sArgs) {
+    return ProvisionalTplParser::parseForeignAuth(sArgs);
+  });
+  add("Fremdquelle", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseForeignSource(sArgs);
+  });
+  add("Fremdpaket", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseForeignPackage(sArgs);
+  });
+  add("Fremd", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseForeignWarning(sArgs);
+  });
+  add("Icon-Übersicht", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseIconOverview(sArgs);
+  });
+  add("IkhayaAutor", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseIkhayaAuthor(sArgs);
+  });
+  add("Ikhaya-Award", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseIkhayaAward(sArgs);
+  });
+  add("Ikhayabild", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseIkhayaImage(sArgs);
+  });
+  add("Ikhaya-Projektvorstellung", [](ProvisionalTplParser *,
+                                      const QStringList &) {
+    return ProvisionalTplParser::parseIkhayaProjectPresentation();
+  });
+  add("Bildersammlung", [](ProvisionalTplParser *pTpl,
+                           const QStringList &sArgs) {
+    return pTpl->parseImageCollect(sArgs);
+  });
+  add("Bildunterschrift", [](ProvisionalTplParser *pTpl,
+                             const QStringList &sArgs) {
+    return pTpl->parseImageSub(sArgs);
+  });
+  add("Ausbaufähig", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseImprovable(sArgs);
+  });
+  add("Infobox", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseInfobox(sArgs);
+  });
+  add("Tasten", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseKeys(sArgs);
+  });
+  add("Wissen", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseKnowledge(sArgs);
+  });
+  add("Verlassen", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseLeft(sArgs);
+  });
+  add("Hinweis", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseNotice(sArgs);
+  });
+  add("OBS", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseOBS(sArgs);
+  });
+  add("Uebersicht", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseOverview(sArgs);
+  });
+  add("Uebersicht2", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseOverview2(sArgs);
+  });
+  add("Pakete", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parsePackage(sArgs);
+  });
+  add("PipInstallation", [](ProvisionalTplParser *pTpl,
+                            const QStringList &sArgs) {
+    return pTpl->parsePipInstall(sArgs);
+  });
+  add("Paketinstallation", [](ProvisionalTplParser *,
+                              const QStringList &sArgs) {
+    return ProvisionalTplParser::parsePkgInstall(sArgs);
+  });
+  add("Installbutton", [](ProvisionalTplParser *pTpl,
+                          const QStringList &sArgs) {
+    return pTpl->parsePkgInstallBut(sArgs);
+  });
+  add("PPA", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parsePPA(sArgs);
+  });
+  add("Projekte", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseProjects(sArgs);
+  });
+  add("Seitenleiste", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseSidebar(sArgs);
+  });
+  add("StatusIcon", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseStatusIcon(sArgs);
+  });
+  add("Tabelle", [](ProvisionalTplParser *pTpl, const QStringList &sArgs) {
+    return pTpl->parseTable(sArgs);
+  });
+  add("Getestet", [](ProvisionalTplParser *pTpl, const QStringList &sArgs) {
+    return pTpl->parseTested(sArgs);
+  });
+  add("UT", [](ProvisionalTplParser *pTpl, const QStringList &sArgs) {
+    return pTpl->parseTestedUT(sArgs);
+  });
+  add("Baustelle", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseUnderConst(sArgs);
+  });
+  add("Warnung", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseWarning(sArgs);
+  });
+  add("Überarbeitung", [](ProvisionalTplParser *, const QStringList &sArgs) {
+    return ProvisionalTplParser::parseWorkInProgr(sArgs);
+  });
+
+  const QStringList sListTrimmed({QStringLiteral("tasten"),
+                                  QStringLiteral("wissen"),
+                                  QStringLiteral("installbutton"),
+                                  QStringLiteral("ut"),
+                                  QStringLiteral("baustelle")});
+  for (const auto &sName : sListTrimmed) {
+    handlers[sName].bTrimmed = true;
+  }
+  return handlers;
 }
 
 // ----------------------------------------------------------------------------
@@ -775,9 +833,10 @@ auto ProvisionalTplParser::parseImageCollect(
       sImageUrl = m_tmpImgDir.absolutePath() + "/" + sImageUrl;
     }
 
-    iImgHeight = QImage(sImageUrl).height();
+    const QSize imgSize(this->imageSize(sImageUrl));
+    iImgHeight = imgSize.height();
     iImgWidth = static_cast<double>(
-                  QImage(sImageUrl).width())/(iImgHeight/sColHeight.toDouble());
+                  imgSize.width()) / (iImgHeight / sColHeight.toDouble());
 
     if (sImageCollAlign.isEmpty()) {  // With word wrap
       if ((i+1) < sListArgs.size()) {
@@ -902,16 +961,16 @@ auto ProvisionalTplParser::parseImageSub(
     }
   }
 
-  iImgWidth = QImage(sImageUrl).width();
+  const QSize imgSize(this->imageSize(sImageUrl));
+  iImgWidth = imgSize.width();
   if (!sImageWidth.isEmpty()) {
     iImgHeight = static_cast<double>(
-                   QImage(
-                     sImageUrl).height()) / (iImgWidth/sImageWidth.toDouble());
+                   imgSize.height()) / (iImgWidth / sImageWidth.toDouble());
   } else {
     // Default
     sImageWidth = "140";
     iImgHeight = static_cast<double>(
-                   QImage(sImageUrl).height()) / (iImgWidth / 140);
+                   imgSize.height()) / (iImgWidth / 140);
   }
 
   sOutput = "<table style=\"float: " + sImageAlign
@@ -1838,17 +1897,29 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
   QString sOutput("");
   QStringList sArgs(sListArgs);
   sArgs.prepend("DUMMY");  // "Needed" because of usage i-1 !!!
-  QRegExp tablePattern("\\<{1,1}[\\w\\s=.-\":;^|]+\\>{1,1}");
-  QRegExp connectCells("-\\d{1,2}");
-  QRegExp connectRows("\\|\\d{1,2}");
-  QRegExp rowclassPattern("rowclass=\\\"[\\w.%-]+\\\"");
-  QRegExp cellclassPattern("cellclass=\\\"[\\w.%-]+\\\"");
-  QRegExp tableClassPattern("tableclass=\\\"[\\w\\s:;%#-]+\\\"");
-
-  QRegExp cellStylePattern("cellstyle=\\\"[\\w\\s:;%#-]+\\\"");
-  QRegExp rowStylePattern("rowstyle=\\\"[\\w\\s:;%#-]+\\\"");
-  QRegExp tableStylePattern("tablestyle=\\\"[\\w\\s:;%#-]+\\\"");
-
+  // Range '"' to '.' (QRegExp accepted it reversed)
+  static const QRegularExpression tablePattern(RegExpRegistry::get(
+      "\\<{1,1}[\\w\\s=\"-.:;^|]+\\>{1,1}"));
+  static const QRegularExpression connectCells(RegExpRegistry::get(
+      "-\\d{1,2}"));
+  static const QRegularExpression connectRows(RegExpRegistry::get(
+      "\\|\\d{1,2}"));
+  static const QRegularExpression rowclassPattern(RegExpRegistry::get(
+      "rowclass=\\\"[\\w.%-]+\\\""));
+  static const QRegularExpression cellclassPattern(RegExpRegistry::get(
+      "cellclass=\\\"[\\w.%-]+\\\""));
+  static const QRegularExpression tableClassPattern(RegExpRegistry::get(
+      "tableclass=\\\"[\\w\\s:;%#-]+\\\""));
+
+  static const QRegularExpression cellStylePattern(RegExpRegistry::get(
+      "cellstyle=\\\"[\\w\\s:;%#-]+\\\""));
+  static const QRegularExpression rowStylePattern(RegExpRegistry::get(
+      "rowstyle=\\\"[\\w\\s:;%#-]+\\\""));
+  static const QRegularExpression tableStylePattern(RegExpRegistry::get(
+      "tablestyle=\\\"[\\w\\s:;%#-]+\\\""));
+  QRegularExpressionMatch match;
+
+  int nIndex;
   int nLength;
   QString sTmpCellStyle;
   QString sStyleInfo;
@@ -1856,13 +1927,15 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
 
   if (sArgs.length() >= 2) {
     QString sTmpClass("");
-    if (tableClassPattern.indexIn(sArgs[1]) >= 0) {
-      sTmpClass = tableClassPattern.cap();
+    match = RegExpRegistry::match(tableClassPattern, sArgs[1]);
+    if (match.hasMatch()) {
+      sTmpClass = match.captured();
       sTmpClass = " class=" + sTmpClass.remove("tableclass=");
     }
     sTmpCellStyle.clear();
-    if (tableStylePattern.indexIn(sArgs[1]) >= 0) {
-      sTmpCellStyle = tableStylePattern.cap();
+    match = RegExpRegistry::match(tableStylePattern, sArgs[1]);
+    if (match.hasMatch()) {
+      sTmpCellStyle = match.captured();
       sTmpCellStyle = " style=" + sTmpCellStyle.remove("tablestyle=");
     }
     sOutput = "<table" + sTmpClass + sTmpCellStyle + ">\n<tbody>\n";
@@ -1876,7 +1949,7 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
     if (sArgs[i] == "+++") {  // New line
       sOutput += "</tr>\n";
     } else {  // New cell
-      int nIndex = tablePattern.indexIn(sArgs[i]);
+      match = RegExpRegistry::match(tablePattern, sArgs[i]);
 
       // Check if found style info is in reality a html text format
       bool bTextformat = false;
@@ -1888,29 +1961,32 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
 
       // Found style info && pattern which was found is not
       // a <span class=...> element or html text format
-      if (nIndex >= 0
+      if (match.hasMatch()
           && !sArgs[i].trimmed().startsWith("<span")
           && !bTextformat) {
         bool bCellStyleWasSet = false;
-        nLength = tablePattern.matchedLength();
-        sStyleInfo = tablePattern.cap();
+        nIndex = match.capturedStart();
+        nLength = match.capturedLength();
+        sStyleInfo = match.captured();
 
         // Start tr
         if (i == 1 || sArgs[i-1] == "+++"
-            || rowclassPattern.indexIn(sStyleInfo) >= 0
-            || rowStylePattern.indexIn(sStyleInfo) >= 0) {
+            || RegExpRegistry::match(rowclassPattern, sStyleInfo).hasMatch()
+            || RegExpRegistry::match(rowStylePattern, sStyleInfo).hasMatch()) {
           sOutput += "<tr";
         }
 
         // Found row class info --> in tr
-        if (rowclassPattern.indexIn(sStyleInfo) >= 0) {
-          sTmpCellStyle = rowclassPattern.cap();
+        match = RegExpRegistry::match(rowclassPattern, sStyleInfo);
+        if (match.hasMatch()) {
+          sTmpCellStyle = match.captured();
           sOutput += " class="
                      + sTmpCellStyle.remove("rowclass=");
         }
         // Found row sytle info --> in tr
-        if (rowStylePattern.indexIn(sStyleInfo) >= 0) {
-          sTmpCellStyle = rowStylePattern.cap();
+        match = RegExpRegistry::match(rowStylePattern, sStyleInfo);
+        if (match.hasMatch()) {
+          sTmpCellStyle = match.captured();
           sOutput += " style=\""
                      + sTmpCellStyle.remove("rowstyle=")
                      .remove("\"") + "\"";
@@ -1918,8 +1994,8 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
 
         // Close tr
         if (i == 1 || sArgs[i-1] == "+++"
-            || rowclassPattern.indexIn(sStyleInfo) >= 0
-            || rowStylePattern.indexIn(sStyleInfo) >= 0) {
+            || RegExpRegistry::match(rowclassPattern, sStyleInfo).hasMatch()
+            || RegExpRegistry::match(rowStylePattern, sStyleInfo).hasMatch()) {
           sOutput += ">\n";
         }
 
@@ -1927,28 +2003,32 @@ auto ProvisionalTplParser::parseTable(const QStringList &sListArgs) -> QString {
         sOutput += "<td";
 
         // Found cellclass info
-        if (cellclassPattern.indexIn(sStyleInfo) >= 0) {
-          sTmpCellStyle = cellclassPattern.cap();
+        match = RegExpRegistry::match(cellclassPattern, sStyleInfo);
+        if (match.hasMatch()) {
+          sTmpCellStyle = match.captured();
           sTmpTD += " class="
                     + sTmpCellStyle.remove("cellclass=");
         }
 
         // Connect cells info (-integer, e.g. -3)
-        if (connectCells.indexIn(sStyleInfo) >= 0) {
+        match = RegExpRegistry::match(connectCells, sStyleInfo);
+        if (match.hasMatch()) {
           sTmpTD += " colspan=\""
-                    + connectCells.cap().remove("-") + "\"";
+                    + match.captured().remove("-") + "\"";
         }
 
         // Connect ROWS info (|integer, e.g. |2)
-        if (connectRows.indexIn(sStyleInfo) >= 0) {
+        match = RegExpRegistry::match(connectRows, sStyleInfo);
+        if (match.hasMatch()) {
           sTmpTD += " rowspan=\""
-                    + connectRows.cap().remove("|") + "\"";
+                    + match.captured().remove("|") + "\"";
         }
 
         // Cell style attributs
-        if (cellStylePattern.indexIn(sStyleInfo) >= 0) {
+        match = RegExpRegistry::match(cellStylePattern, sStyleInfo);
+        if (match.hasMatch()) {
           sTmpTD += " style=\""
-                    + cellStylePattern.cap().remove("cellstyle=")
+                    + match.captured().remove("cellstyle=")
                     .remove("\"");
           bCellStyleWasSet = true;
         }
@@ -2285,6 +2365,16 @@ auto ProvisionalTplParser::parseWorkInProgr(
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
+// Output depends on the size, thus it is remembered for cached expansions
+auto ProvisionalTplParser::imageSize(const QString &sPath) -> QSize {
+  const QSize size(ImageSizeCache::size(sPath));
+  m_UsedImageSizes.insert(sPath, size);
+  return size;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
 // Insert box
 auto ProvisionalTplParser::insertBox(const QString &sClass,
                                      const QString &sHeadline,
@@ -28,6 +28,8 @@
 #define APPLICATION_PARSER_PROVISIONALTPLPARSER_H_
 
 #include <QDir>
+#include <QHash>
+#include <QSize>
 #include <QString>
 #include <QStringList>
 
@@ -44,8 +46,30 @@ class ProvisionalTplParser {
 
     auto parseTpl(const QStringList &sListArgs,
                   const QString &sCurrentFile) -> QString;
+    // Images read by the last parseTpl() call
+    auto getUsedImageSizes() const -> QHash<QString, QSize>;
+    // Has to be set before any parser is used; done by Parser (--debug)
+    static void setStatisticsEnabled(const bool bEnabled);
+    // Writes number of calls and time per template to the debug log, if
+    // statistics are enabled
+    void logStatistics() const;
+    void resetStatistics();
 
  private:
+    using Handler = QString (*)(ProvisionalTplParser *pTpl,
+                                const QStringList &sListArgs);
+    struct TplHandler {
+      Handler handler;
+      bool bTrimmed;  // Name may be surrounded by spaces
+    };
+    struct TplStatistics {
+      int nCalls = 0;
+      qint64 nNanoSecs = 0;
+    };
+
+    static auto getHandlers() -> const QHash<QString, TplHandler> &;
+    static auto createHandlers() -> QHash<QString, TplHandler>;
+
     static auto parseAdvanced() -> QString;
     static auto parseArchived(const QStringList &sListArgs) -> QString;
     static auto parseBash(const QStringList &sListArgs) -> QString;
@@ -89,6 +113,7 @@ class ProvisionalTplParser {
     static auto parseWarning(const QStringList &sListArgs) -> QString;
     static auto parseWorkInProgr(const QStringList &sListArgs) -> QString;
 
+    auto imageSize(const QString &sPath) -> QSize;
     static auto insertBox(
         const QString &sClass,
         const QString &sHeadline,
@@ -104,6 +129,8 @@ class ProvisionalTplParser {
     QStringList m_sListTestedWithTouch;
     QStringList m_sListTestedWithTouchStrings;
     const QString m_sCommunity;
+    QHash<QString, TplStatistics> m_Statistics;
+    QHash<QString, QSize> m_UsedImageSizes;
 };
 
 #endif  // APPLICATION_PARSER_PROVISIONALTPLPARSER_H_
@@ -0,0 +1,336 @@
+/**
+ * \file pygmentsworker.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Syntax highlighting of code blocks with one long-lived pygments process.
+ */
+
+#include "./pygmentsworker.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+
+namespace {
+// Request:  "<language>\t<number of bytes>\n<utf-8 code>"
+// Response: "OK|ERR <number of bytes>\n<utf-8 html or error message>"
+const char PYGMENTS_WORKER[] = R"(
+import sys
+from pygments import __version__, highlight
+from pygments.formatters import HtmlFormatter
+from pygments.lexers import get_lexer_by_name
+
+stdin = sys.stdin.buffer
+stdout = sys.stdout.buffer
+stdout.write(('VERSION %s\n' % __version__).encode('utf-8'))
+stdout.flush()
+formatter = HtmlFormatter(nowrap=True, noclasses=True)
+
+while True:
+    header = stdin.readline()
+    if not header:
+        break
+    try:
+        lang, size = header.decode('utf-8').rstrip('\n').rsplit('\t', 1)
+        code = stdin.read(int(size)).decode('utf-8')
+        result = highlight(code, get_lexer_by_name(lang), formatter)
+        status = 'OK'
+    except Exception as error:
+        result = str(error)
+        status = 'ERR'
+    result = result.encode('utf-8')
+    stdout.write(('%s %d\n' % (status, len(result))).encode('utf-8'))
+    stdout.write(result)
+    stdout.flush()
+)";
+
+// Kept short, since the parser thread is blocked (and not cancelable)
+// while waiting; pygments is disabled for the session after a timeout
+const int START_TIMEOUT = 5000;  // Including loading pygments
+const int TIMEOUT = 2000;
+const int MEMCACHE_SIZE = 4 * 1024 * 1024;  // Characters
+}  // namespace
+
+PygmentsWorker::PygmentsWorker(const QString &sPygmentize)
+  : m_sPygmentize(sPygmentize),
+    m_sCacheDir(QStandardPaths::writableLocation(
+                  QStandardPaths::CacheLocation) + "/pygments"),
+    m_pProcess(nullptr),
+    m_bWorkerFailed(false),
+    m_bUnavailable(false),
+    m_MemCache(MEMCACHE_SIZE) {
+}
+
+PygmentsWorker::~PygmentsWorker() {
+  this->stopWorker();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::highlight(const QString &sLanguage, const QString &sCode,
+                               QString &sHtml) -> bool {
+  // The pygments version is part of the cache key, thus the worker is
+  // started first; nothing has been cached before anyway
+  if (!m_bUnavailable && !m_bWorkerFailed && nullptr == m_pProcess &&
+      !this->startWorker()) {
+    qWarning() << "Pygments worker not available, falling back to"
+               << "one pygmentize call per code block.";
+    m_bWorkerFailed = true;
+  }
+
+  const QString sKey(this->getCacheKey(sLanguage, sCode));
+  if (m_MemCache.contains(sKey)) {
+    sHtml = *m_MemCache.object(sKey);
+    return true;
+  }
+  if (m_bUnavailable) {
+    return false;
+  }
+
+  // Disk cache is only used if the pygments version is known
+  QFile cacheFile(m_sCacheDir + "/" + sKey + ".html");
+  if (!m_sVersion.isEmpty() && cacheFile.open(QIODevice::ReadOnly)) {
+    sHtml = QString::fromUtf8(cacheFile.readAll());
+    cacheFile.close();
+    m_MemCache.insert(sKey, new QString(sHtml), sHtml.size());
+    return true;
+  }
+
+  bool bOk;
+  if (m_bWorkerFailed) {
+    bOk = this->highlightOnce(sLanguage, sCode, sHtml);
+  } else {
+    bOk = this->highlightWorker(sLanguage, sCode, sHtml);
+  }
+  if (!bOk) {
+    return false;
+  }
+
+  m_MemCache.insert(sKey, new QString(sHtml), sHtml.size());
+  if (!m_sVersion.isEmpty() && QDir().mkpath(m_sCacheDir)) {
+    if (cacheFile.open(QIODevice::WriteOnly)) {
+      cacheFile.write(sHtml.toUtf8());
+      cacheFile.close();
+    } else {
+      qWarning() << "Could not write pygments cache:" << cacheFile.fileName();
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::startWorker() -> bool {
+  QStringList sListArgs(this->getPythonCommand());
+  const QString sPython(sListArgs.takeFirst());
+  sListArgs << QStringLiteral("-c") << QString::fromUtf8(PYGMENTS_WORKER);
+
+  m_pProcess = new QProcess();
+  // Show python errors on the console
+  m_pProcess->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  m_pProcess->start(sPython, sListArgs);
+  if (!m_pProcess->waitForStarted(START_TIMEOUT)) {
+    qWarning() << "Could not start pygments worker:" << sPython;
+    this->stopWorker();
+    return false;
+  }
+
+  QByteArray sLine;
+  if (!this->readLine(sLine, START_TIMEOUT) ||
+      !sLine.startsWith("VERSION ")) {
+    qWarning() << "Pygments worker did not respond:" << sPython;
+    this->stopWorker();
+    return false;
+  }
+  m_sVersion = QString::fromUtf8(sLine.mid(8)).trimmed();
+  qDebug() << "Pygments worker started, version" << m_sVersion;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void PygmentsWorker::stopWorker() {
+  if (nullptr != m_pProcess) {
+    m_pProcess->closeWriteChannel();  // Worker exits on EOF
+    if (!m_pProcess->waitForFinished(1000)) {
+      m_pProcess->kill();
+      m_pProcess->waitForFinished(1000);
+    }
+    delete m_pProcess;
+    m_pProcess = nullptr;
+  }
+  m_Buffer.clear();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::readLine(QByteArray &sLine, const int nTimeout) -> bool {
+  int nEnd;
+  while ((nEnd = m_Buffer.indexOf('\n')) < 0) {
+    if (!m_pProcess->waitForReadyRead(nTimeout)) {
+      return false;
+    }
+    m_Buffer += m_pProcess->readAllStandardOutput();
+  }
+  sLine = m_Buffer.left(nEnd);
+  m_Buffer.remove(0, nEnd + 1);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::readBytes(const int nSize, QByteArray &sData) -> bool {
+  while (m_Buffer.size() < nSize) {
+    if (!m_pProcess->waitForReadyRead(TIMEOUT)) {
+      return false;
+    }
+    m_Buffer += m_pProcess->readAllStandardOutput();
+  }
+  sData = m_Buffer.left(nSize);
+  m_Buffer.remove(0, nSize);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::highlightWorker(const QString &sLanguage,
+                                     const QString &sCode,
+                                     QString &sHtml) -> bool {
+  const QByteArray code(sCode.toUtf8());
+  // Separators of the request header; such a lexer does not exist anyway
+  QString sLexer(sLanguage.trimmed());
+  sLexer.replace(QLatin1Char('\t'), QLatin1Char(' '));
+  sLexer.replace(QLatin1Char('\n'), QLatin1Char(' '));
+  m_pProcess->write(sLexer.toUtf8() + '\t' +
+                    QByteArray::number(code.size()) + '\n' + code);
+
+  QByteArray sHeader;
+  QByteArray result;
+  if (!this->readLine(sHeader, TIMEOUT) ||
+      !this->readBytes(sHeader.mid(sHeader.indexOf(' ') + 1).toInt(),
+                       result)) {
+    // Not restarted, each further request would block the parser again
+    qCritical() << "Pygments worker timed out or crashed, pygments disabled"
+                << "for this session.";
+    this->stopWorker();
+    m_bUnavailable = true;
+    return false;
+  }
+
+  // E.g. unknown lexer; empty output as by pygmentize
+  if (!sHeader.startsWith("OK ")) {
+    qCritical() << "Pygments error:" << QString::fromUtf8(result);
+    sHtml.clear();
+    return true;
+  }
+  sHtml = QString::fromUtf8(result);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+// Fallback if the worker script cannot be used (e.g. unknown interpreter)
+auto PygmentsWorker::highlightOnce(const QString &sLanguage,
+                                   const QString &sCode,
+                                   QString &sHtml) -> bool {
+  QProcess procPygmentize;
+  procPygmentize.start(m_sPygmentize,
+                       QStringList() << QStringLiteral("-l") << sLanguage <<
+                       QStringLiteral("-f") << QStringLiteral("html") <<
+                       QStringLiteral("-O") << QStringLiteral("nowrap") <<
+                       QStringLiteral("-O") << QStringLiteral("noclasses"));
+
+  if (!procPygmentize.waitForStarted(START_TIMEOUT)) {
+    qCritical() << "Error while starting pygmentize - waitForStarted";
+    procPygmentize.kill();
+    m_bUnavailable = true;
+    return false;
+  }
+  procPygmentize.write(sCode.toUtf8() + '\n');
+  procPygmentize.closeWriteChannel();
+  if (!procPygmentize.waitForFinished(START_TIMEOUT)) {
+    qCritical() << "Error while executing pygmentize - waitForFinished";
+    procPygmentize.kill();
+    m_bUnavailable = true;
+    return false;
+  }
+  if (QProcess::NormalExit != procPygmentize.exitStatus()) {
+    qCritical() << "Pygmentize crashed, pygments disabled for this session.";
+    m_bUnavailable = true;
+    return false;
+  }
+  // E.g. unknown lexer; output is empty then
+  if (0 != procPygmentize.exitCode()) {
+    qCritical() << "Pygments error:"
+                << QString::fromUtf8(procPygmentize.readAllStandardError());
+  }
+
+  sHtml = QString::fromUtf8(procPygmentize.readAllStandardOutput());
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Use the interpreter pygmentize is installed for (shebang line)
+auto PygmentsWorker::getPythonCommand() const -> QStringList {
+  QFile script(m_sPygmentize);
+  if (script.open(QIODevice::ReadOnly)) {
+    const QByteArray sFirstLine(script.readLine(256).trimmed());
+    script.close();
+    if (sFirstLine.startsWith("#!")) {
+      QStringList sListCmd(
+            QString::fromUtf8(sFirstLine.mid(2)).split(QLatin1Char(' ')));
+      sListCmd.removeAll(QString());
+      if (!sListCmd.isEmpty()) {
+        return sListCmd;
+      }
+    }
+  }
+
+#if defined _WIN32
+  return QStringList() << QStringLiteral("python");
+#else
+  return QStringList() << QStringLiteral("python3");
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+auto PygmentsWorker::getCacheKey(const QString &sLanguage,
+                                 const QString &sCode) const -> QString {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(sLanguage.trimmed().toUtf8());
+  hash.addData("\0", 1);
+  hash.addData(QCryptographicHash::hash(sCode.toUtf8(),
+                                        QCryptographicHash::Sha1));
+  hash.addData("\0", 1);
+  hash.addData(m_sVersion.toUtf8());
+  return QString::fromLatin1(hash.result().toHex());
+}
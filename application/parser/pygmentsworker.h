@@ -0,0 +1,79 @@
+/**
+ * \file pygmentsworker.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for pygments worker.
+ */
+
+#ifndef APPLICATION_PARSER_PYGMENTSWORKER_H_
+#define APPLICATION_PARSER_PYGMENTSWORKER_H_
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+#include <QStringList>
+
+class QProcess;
+
+/**
+ * \class PygmentsWorker
+ * \brief Long-lived pygments process with memory and disk cache.
+ *
+ * Has to be used from one thread only; the process is started with the
+ * first request in the calling thread.
+ */
+class PygmentsWorker {
+ public:
+    explicit PygmentsWorker(const QString &sPygmentize);
+    ~PygmentsWorker();
+
+    // False if pygments is not available (anymore); an unknown language
+    // results in empty output
+    auto highlight(const QString &sLanguage, const QString &sCode,
+                   QString &sHtml) -> bool;
+
+ private:
+    Q_DISABLE_COPY(PygmentsWorker)
+
+    auto startWorker() -> bool;
+    void stopWorker();
+    auto readLine(QByteArray &sLine, const int nTimeout) -> bool;
+    auto readBytes(const int nSize, QByteArray &sData) -> bool;
+    auto highlightWorker(const QString &sLanguage, const QString &sCode,
+                         QString &sHtml) -> bool;
+    auto highlightOnce(const QString &sLanguage, const QString &sCode,
+                       QString &sHtml) -> bool;
+    auto getPythonCommand() const -> QStringList;
+    auto getCacheKey(const QString &sLanguage,
+                     const QString &sCode) const -> QString;
+
+    const QString m_sPygmentize;
+    const QString m_sCacheDir;
+    QProcess *m_pProcess;
+    QByteArray m_Buffer;
+    QString m_sVersion;
+    bool m_bWorkerFailed;  // Using one pygmentize call per request
+    bool m_bUnavailable;  // Timed out or crashed, not tried again
+    QCache<QString, QString> m_MemCache;
+};
+
+#endif  // APPLICATION_PARSER_PYGMENTSWORKER_H_
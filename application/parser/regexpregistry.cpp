@@ -0,0 +1,109 @@
+/**
+ * \file regexpregistry.cpp
+ *
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * \section DESCRIPTION
+ * Shared, precompiled regular expressions.
+ */
+
+#include "./regexpregistry.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QStringList>
+#include <QThreadStorage>
+
+#include <algorithm>
+
+namespace {
+typedef QPair<QString, int> RegExpKey;  // Pattern and options
+
+QMutex g_Mutex;
+QHash<RegExpKey, QRegularExpression> g_RegExps;
+QThreadStorage<QHash<QString, int> > g_Executions;  // By pattern
+bool g_bStatistics = false;  // Not changed while parsing
+}  // namespace
+
+auto RegExpRegistry::get(
+    const QString &sPattern,
+    const QRegularExpression::PatternOptions options) -> QRegularExpression {
+  const RegExpKey key(sPattern, static_cast<int>(options));
+  QMutexLocker locker(&g_Mutex);
+  auto it = g_RegExps.constFind(key);
+  if (g_RegExps.constEnd() != it) {
+    return it.value();
+  }
+
+  QRegularExpression regexp(sPattern, options);
+  if (!regexp.isValid()) {
+    qWarning() << "Invalid regular expression:" << sPattern
+               << regexp.errorString();
+  }
+  regexp.optimize();
+  g_RegExps.insert(key, regexp);
+  return regexp;
+}
+
+// ----------------------------------------------------------------------------
+
+auto RegExpRegistry::match(const QRegularExpression &regexp,
+                           const QString &sSubject,
+                           const int nOffset) -> QRegularExpressionMatch {
+  if (g_bStatistics) {
+    g_Executions.localData()[regexp.pattern()]++;
+  }
+  return regexp.match(sSubject, nOffset);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void RegExpRegistry::setStatisticsEnabled(const bool bEnabled) {
+  g_bStatistics = bEnabled;
+}
+
+// ----------------------------------------------------------------------------
+
+void RegExpRegistry::logStatistics() {
+  if (!g_bStatistics || !g_Executions.hasLocalData()) {
+    return;
+  }
+  const QHash<QString, int> &executions = g_Executions.localData();
+  QStringList sListPatterns(executions.keys());
+  std::sort(sListPatterns.begin(), sListPatterns.end(),
+            [&executions](const QString &a, const QString &b) {
+    return executions[a] > executions[b];
+  });
+
+  int nTotal = 0;
+  for (const int n : executions) {
+    nTotal += n;
+  }
+  qDebug() << "Regular expression executions:" << nTotal;
+  for (const auto &sPattern : qAsConst(sListPatterns)) {
+    qDebug() << "  " << executions[sPattern] << sPattern;
+  }
+}
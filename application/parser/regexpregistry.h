@@ -0,0 +1,67 @@
+/**
+ * \file regexpregistry.h
+ *
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * \section DESCRIPTION
+ * Class definition for shared, precompiled regular expressions.
+ */
+
+#ifndef APPLICATION_PARSER_REGEXPREGISTRY_H_
+#define APPLICATION_PARSER_REGEXPREGISTRY_H_
+
+#include <QRegularExpression>
+#include <QString>
+
+/**
+ * \class RegExpRegistry
+ * \brief Thread-safe registry of the parser's regular expressions.
+ *
+ * Each pattern is compiled and optimized (JIT) on first request and shared
+ * afterwards. Patterns containing translations are requested once when
+ * the parser modules are created. Call sites keep the returned expression,
+ * thus nothing is looked up while matching. In debug mode, executions are
+ * counted per thread for the whole session (see logStatistics()).
+ *
+ * Unlike QRegExp, '.' does not match line breaks by default; patterns
+ * converted from QRegExp use DotMatchesEverythingOption where needed.
+ */
+class RegExpRegistry {
+ public:
+    static auto get(
+        const QString &sPattern,
+        const QRegularExpression::PatternOptions options =
+          QRegularExpression::NoPatternOption) -> QRegularExpression;
+
+    // Execution, counted if statistics are enabled
+    static auto match(const QRegularExpression &regexp,
+                      const QString &sSubject,
+                      const int nOffset = 0) -> QRegularExpressionMatch;
+
+    // Has to be set before any parser is used; done by Parser (--debug)
+    static void setStatisticsEnabled(const bool bEnabled);
+    // Writes executions of the current thread to the debug log; to be
+    // called once when the thread's parser is not needed anymore
+    static void logStatistics();
+};
+
+#endif  // APPLICATION_PARSER_REGEXPREGISTRY_H_
@@ -0,0 +1,504 @@
+/**
+ * \file previewcontent.cpp
+ *
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * \section DESCRIPTION
+ * Delivering the preview from memory.
+ */
+
+#include "./previewcontent.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMimeDatabase>
+#include <QTextStream>
+
+#include <algorithm>
+
+#ifdef USEQTWEBKIT
+#include <QTimer>
+
+#include <cstring>
+#endif
+#ifdef USEQTWEBENGINE
+#include <QBuffer>
+#include <QWebEngineUrlRequestJob>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QWebEngineUrlScheme>
+#endif
+#endif
+
+#include "./parser/parser.h"
+
+namespace {
+const char PREVIEW_HOST[] = "preview";
+const char PREVIEW_PATH[] = "/preview.html";
+const char HTML_MIME_TYPE[] = "text/html;charset=utf-8";
+const int MAX_CACHED_BYTES = 32 * 1024 * 1024;  // Referenced files
+
+// Replaces nRemoved blocks starting with block nFirst; comments are the
+// markers of Parser::BLOCK_MARKER and BLOCK_END_MARKER. If the page does
+// not match (markers not found or nested), nothing is changed.
+const char PATCH_SCRIPT[] =
+    "(function(nBlocks, nFirst, nRemoved, blocks) {"
+    "  var markers = [];"
+    "  var it = document.createNodeIterator("
+    "    document.body, NodeFilter.SHOW_COMMENT, null, false);"
+    "  var node;"
+    "  while ((node = it.nextNode())) {"
+    "    if ('inyoka-block' === node.data ||"
+    "        '/inyoka-block' === node.data) {"
+    "      markers.push(node);"
+    "    }"
+    "  }"
+    "  if (markers.length !== nBlocks + 1) {"
+    "    return false;"
+    "  }"
+    "  var parent = markers[0].parentNode;"
+    "  for (var i = 1; i < markers.length; i++) {"
+    "    if (markers[i].parentNode !== parent) {"
+    "      return false;"
+    "    }"
+    "  }"
+    "  var end = markers[nFirst + nRemoved];"
+    "  for (node = markers[nFirst]; node !== end;) {"
+    "    var next = node.nextSibling;"
+    "    parent.removeChild(node);"
+    "    node = next;"
+    "  }"
+    "  var range = document.createRange();"
+    "  range.selectNode(end);"
+    "  parent.insertBefore("
+    "    range.createContextualFragment(blocks.join('')), end);"
+    "  return true;"
+    "})(%1, %2, %3, %4);";
+
+// Returns source line and document position of each block as flat list
+const char SOURCE_MAP_SCRIPT[] =
+    "(function(lines) {"
+    "  var map = [];"
+    "  var it = document.createNodeIterator("
+    "    document.body, NodeFilter.SHOW_COMMENT, null, false);"
+    "  var node;"
+    "  var i = 0;"
+    "  while ((node = it.nextNode()) && i < lines.length) {"
+    "    if ('inyoka-block' !== node.data) {"
+    "      continue;"
+    "    }"
+    "    var elem = node.nextSibling;"
+    "    while (elem && 1 !== elem.nodeType && 8 !== elem.nodeType) {"
+    "      elem = elem.nextSibling;"
+    "    }"
+    "    if (elem && 1 === elem.nodeType) {"
+    "      elem.setAttribute('data-src-line', lines[i]);"
+    "      map.push(lines[i], elem.getBoundingClientRect().top +"
+    "                         window.pageYOffset);"
+    "    }"
+    "    i++;"
+    "  }"
+    "  return map;"
+    "})([%1]);";
+}  // namespace
+
+const char PreviewContent::SCHEME[] = "inyokapreview";
+
+PreviewContent::PreviewContent(const QString &sPreviewFile, QObject *pParent)
+  : QObject(pParent),
+    m_sPreviewFile(sPreviewFile),
+    m_bHasBlocks(false),
+    m_Resources(MAX_CACHED_BYTES) {
+}
+
+// ----------------------------------------------------------------------------
+
+void PreviewContent::registerScheme() {
+#if defined USEQTWEBENGINE && QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+  QWebEngineUrlScheme scheme(SCHEME);
+  scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+  scheme.setFlags(QWebEngineUrlScheme::LocalScheme |
+                  QWebEngineUrlScheme::LocalAccessAllowed);
+  QWebEngineUrlScheme::registerScheme(scheme);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::setHtml(const QString &sHtml) -> bool {
+  m_sHtml = sHtml;
+  m_bHasBlocks = PreviewContent::splitBlocks(m_sHtml, m_sFrame,
+                                             m_sListBlocks, m_sSourceLines);
+#ifdef NOPREVIEW
+  // External browser needs a file
+  QFile tmphtmlfile(m_sPreviewFile);
+  if (!tmphtmlfile.open(QFile::WriteOnly | QFile::Text)) {
+    qWarning() << "Could not create temporary HTML file:" << m_sPreviewFile;
+    return false;
+  }
+  QTextStream tmpoutputstream(&tmphtmlfile);
+  tmpoutputstream.setCodec("UTF-8");
+  tmpoutputstream << sHtml;
+  tmphtmlfile.close();
+#else
+  m_baHtml = sHtml.toUtf8();
+#endif
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::getHtml() const -> QString {
+  return m_sHtml;
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::getUrl() const -> QUrl {
+#ifdef NOPREVIEW
+  return QUrl::fromLocalFile(QFileInfo(m_sPreviewFile).absoluteFilePath());
+#else
+  QUrl url;
+  url.setScheme(QString::fromLatin1(SCHEME));
+  url.setHost(QString::fromLatin1(PREVIEW_HOST));
+  url.setPath(QString::fromLatin1(PREVIEW_PATH));
+  return url;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::isPreviewUrl(const QUrl &url) const -> bool {
+  return url.adjusted(QUrl::RemoveFragment | QUrl::RemoveQuery) ==
+      this->getUrl();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::createPatch(const QString &sHtml,
+                                 QString &sScript) const -> bool {
+  sScript.clear();
+  QString sFrame;
+  QStringList sListBlocks;
+  QString sSourceLines;
+  if (!m_bHasBlocks ||
+      !PreviewContent::splitBlocks(sHtml, sFrame, sListBlocks,
+                                   sSourceLines) ||
+      sFrame != m_sFrame) {
+    return false;
+  }
+
+  // Only the range between unchanged blocks at start and end is replaced
+  const int nOld = m_sListBlocks.size();
+  const int nNew = sListBlocks.size();
+  int nFirst = 0;
+  while (nFirst < nOld && nFirst < nNew &&
+         m_sListBlocks.at(nFirst) == sListBlocks.at(nFirst)) {
+    nFirst++;
+  }
+  int nKeptAtEnd = 0;
+  while (nKeptAtEnd < nOld - nFirst && nKeptAtEnd < nNew - nFirst &&
+         m_sListBlocks.at(nOld - 1 - nKeptAtEnd) ==
+         sListBlocks.at(nNew - 1 - nKeptAtEnd)) {
+    nKeptAtEnd++;
+  }
+  if (nOld == nNew && nFirst == nOld) {
+    return true;  // Nothing changed
+  }
+
+  QJsonArray blocks;
+  for (int i = nFirst; i < nNew - nKeptAtEnd; i++) {
+    blocks.append(QLatin1String(Parser::BLOCK_MARKER) + sListBlocks.at(i));
+  }
+  QString sBlocks(QString::fromUtf8(
+                    QJsonDocument(blocks).toJson(QJsonDocument::Compact)));
+  // Not allowed unescaped in strings of older JavaScript engines
+  sBlocks.replace(QChar(0x2028), QLatin1String("\\u2028"));
+  sBlocks.replace(QChar(0x2029), QLatin1String("\\u2029"));
+
+  // Blocks are inserted last, thus %-signs in there are not replaced
+  sScript = QString::fromLatin1(PATCH_SCRIPT)
+            .arg(nOld).arg(nFirst).arg(nOld - nKeptAtEnd - nFirst)
+            .arg(sBlocks);
+  qDebug() << "Patching preview blocks" << nFirst << "to"
+           << nNew - nKeptAtEnd - 1 << "of" << nNew;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::splitBlocks(const QString &sHtml, QString &sFrame,
+                                 QStringList &sListBlocks,
+                                 QString &sSourceLines) -> bool {
+  const QString sMarker(QLatin1String(Parser::BLOCK_MARKER));
+  const QLatin1String sEndMarker(Parser::BLOCK_END_MARKER);
+  const int nEnd = sHtml.indexOf(sEndMarker);
+  sSourceLines.clear();
+  if (-1 == nEnd) {
+    sFrame.clear();
+    sListBlocks.clear();
+    return false;
+  }
+
+  int nStart = sHtml.indexOf(sMarker);
+  if (-1 == nStart || nStart > nEnd) {
+    nStart = nEnd;  // Empty document
+  }
+
+  // Source lines are not part of the frame, they change with every line
+  // inserted or removed
+  int nRest = nEnd + sEndMarker.size();
+  const QLatin1String sLinesMarker(Parser::SOURCE_LINES_MARKER);
+  if (sHtml.midRef(nRest, sLinesMarker.size()) == sLinesMarker) {
+    const int nLinesEnd = sHtml.indexOf(QLatin1String("-->"), nRest);
+    if (-1 != nLinesEnd) {
+      nRest += sLinesMarker.size();
+      sSourceLines = sHtml.mid(nRest, nLinesEnd - nRest);
+      nRest = nLinesEnd + 3;
+    }
+  }
+  sFrame = sHtml.left(nStart) + sEndMarker + sHtml.mid(nRest);
+  sListBlocks = sHtml.mid(nStart, nEnd - nStart).split(sMarker);
+  sListBlocks.removeFirst();  // Content is starting with a marker
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::getSourceMapScript() const -> QString {
+  return QString::fromLatin1(SOURCE_MAP_SCRIPT).arg(m_sSourceLines);
+}
+
+// ----------------------------------------------------------------------------
+
+void PreviewContent::setSourceMap(const QVariant &result) {
+  const QVariantList map(result.toList());
+  m_vMapLines.clear();
+  m_vMapPositions.clear();
+  if (map.isEmpty()) {
+    return;
+  }
+
+  // Start of document; floating elements may be out of order, skip them
+  m_vMapLines << 1;
+  m_vMapPositions << 0;
+  for (int i = 0; i + 1 < map.size(); i += 2) {
+    const double dLine = map.at(i).toDouble();
+    const double dPos = map.at(i + 1).toDouble();
+    if (dLine >= m_vMapLines.last() && dPos >= m_vMapPositions.last()) {
+      m_vMapLines << dLine;
+      m_vMapPositions << dPos;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::getScrollPosition(const double dLine) const -> double {
+  return PreviewContent::interpolate(m_vMapLines, m_vMapPositions, dLine);
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::getSourceLine(const double dScrollPos) const -> double {
+  return PreviewContent::interpolate(m_vMapPositions, m_vMapLines,
+                                     dScrollPos);
+}
+
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::interpolate(const QVector<double> &vFrom,
+                                 const QVector<double> &vTo,
+                                 const double dValue) -> double {
+  if (vFrom.isEmpty()) {
+    return -1;
+  }
+
+  // Binary search for the last entry not behind dValue
+  const auto it = std::upper_bound(vFrom.constBegin(), vFrom.constEnd(),
+                                   dValue);
+  if (vFrom.constBegin() == it) {
+    return vTo.first();
+  }
+  const int i = static_cast<int>(it - vFrom.constBegin()) - 1;
+  if (i + 1 >= vFrom.size() || vFrom.at(i + 1) <= vFrom.at(i)) {
+    return vTo.at(i);
+  }
+  const double dRatio = (dValue - vFrom.at(i)) /
+                        (vFrom.at(i + 1) - vFrom.at(i));
+  return vTo.at(i) + dRatio * (vTo.at(i + 1) - vTo.at(i));
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto PreviewContent::resource(const QUrl &url, QByteArray &baData,
+                              QByteArray &baMimeType) -> bool {
+  if (this->isPreviewUrl(url)) {
+    baData = m_baHtml;
+    baMimeType = HTML_MIME_TYPE;
+    return true;
+  }
+
+  // Absolute paths in the page are resolved below the preview host
+  const QFileInfo fi(url.path());
+  if (url.host() != QLatin1String(PREVIEW_HOST) || !fi.isFile()) {
+    return false;
+  }
+
+  const QString sPath(fi.absoluteFilePath());
+  const Resource *pCached = m_Resources.object(sPath);
+  if (nullptr != pCached && pCached->lastModified == fi.lastModified()) {
+    baData = pCached->baData;
+    baMimeType = pCached->baMimeType;
+    return true;
+  }
+
+  QFile file(sPath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Could not read preview resource:" << sPath;
+    return false;
+  }
+  auto *pResource = new Resource;
+  pResource->baData = file.readAll();
+  pResource->baMimeType = QMimeDatabase().mimeTypeForFile(fi).name().toLatin1();
+  pResource->lastModified = fi.lastModified();
+  baData = pResource->baData;
+  baMimeType = pResource->baMimeType;
+  // Takes ownership (deleted immediately if exceeding the budget)
+  m_Resources.insert(sPath, pResource, qMax(1, pResource->baData.size()));
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#ifdef USEQTWEBKIT
+PreviewNetworkAccessManager::PreviewNetworkAccessManager(
+    PreviewContent *pContent, QObject *pParent)
+  : QNetworkAccessManager(pParent),
+    m_pContent(pContent) {
+}
+
+auto PreviewNetworkAccessManager::createRequest(
+    Operation op, const QNetworkRequest &request,
+    QIODevice *pOutgoingData) -> QNetworkReply * {
+  if (request.url().scheme() != QLatin1String(PreviewContent::SCHEME)) {
+    return QNetworkAccessManager::createRequest(op, request, pOutgoingData);
+  }
+
+  QByteArray baData;
+  QByteArray baMimeType;
+  const bool bFound = m_pContent->resource(request.url(), baData, baMimeType);
+  return new PreviewReply(request, bFound, baData, baMimeType, this);
+}
+
+// ----------------------------------------------------------------------------
+
+PreviewReply::PreviewReply(const QNetworkRequest &request, const bool bFound,
+                           const QByteArray &baData,
+                           const QByteArray &baMimeType, QObject *pParent)
+  : QNetworkReply(pParent),
+    m_baData(baData),
+    m_nOffset(0),
+    m_bFound(bFound) {
+  this->setRequest(request);
+  this->setUrl(request.url());
+  this->setOperation(QNetworkAccessManager::GetOperation);
+  this->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+  if (m_bFound) {
+    this->setHeader(QNetworkRequest::ContentTypeHeader, baMimeType);
+    this->setHeader(QNetworkRequest::ContentLengthHeader, m_baData.size());
+  } else {
+    this->setError(QNetworkReply::ContentNotFoundError,
+                   "Not found: " + request.url().toString());
+  }
+  // Signals have to be emitted after the caller has connected
+  QTimer::singleShot(0, this, &PreviewReply::deliver);
+}
+
+void PreviewReply::deliver() {
+  if (m_bFound) {
+    emit this->metaDataChanged();
+    emit this->readyRead();
+  } else {
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    emit this->error(QNetworkReply::ContentNotFoundError);
+#else
+    emit this->errorOccurred(QNetworkReply::ContentNotFoundError);
+#endif
+  }
+  this->setFinished(true);
+  emit this->finished();
+}
+
+void PreviewReply::abort() {
+  this->close();
+}
+
+auto PreviewReply::bytesAvailable() const -> qint64 {
+  return m_baData.size() - m_nOffset + QNetworkReply::bytesAvailable();
+}
+
+auto PreviewReply::isSequential() const -> bool {
+  return true;
+}
+
+auto PreviewReply::readData(char *pData, qint64 nMaxSize) -> qint64 {
+  if (m_nOffset >= m_baData.size()) {
+    return -1;
+  }
+  const qint64 nSize = qMin(nMaxSize, m_baData.size() - m_nOffset);
+  std::memcpy(pData, m_baData.constData() + m_nOffset,
+              static_cast<size_t>(nSize));
+  m_nOffset += nSize;
+  return nSize;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#ifdef USEQTWEBENGINE
+PreviewSchemeHandler::PreviewSchemeHandler(PreviewContent *pContent,
+                                           QObject *pParent)
+  : QWebEngineUrlSchemeHandler(pParent),
+    m_pContent(pContent) {
+}
+
+void PreviewSchemeHandler::requestStarted(QWebEngineUrlRequestJob *pJob) {
+  QByteArray baData;
+  QByteArray baMimeType;
+  if (!m_pContent->resource(pJob->requestUrl(), baData, baMimeType)) {
+    pJob->fail(QWebEngineUrlRequestJob::UrlNotFound);
+    return;
+  }
+  auto *pBuffer = new QBuffer(pJob);  // Deleted together with the job
+  pBuffer->setData(baData);
+  pJob->reply(baMimeType, pBuffer);
+}
+#endif
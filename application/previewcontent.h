@@ -0,0 +1,187 @@
+/**
+ * \file previewcontent.h
+ *
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * \section DESCRIPTION
+ * Class definition for delivering the preview from memory.
+ */
+
+#ifndef APPLICATION_PREVIEWCONTENT_H_
+#define APPLICATION_PREVIEWCONTENT_H_
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVariant>
+#include <QVector>
+
+#ifdef USEQTWEBKIT
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#endif
+#ifdef USEQTWEBENGINE
+#include <QWebEngineUrlSchemeHandler>
+#endif
+
+/**
+ * \class PreviewContent
+ * \brief Latest rendered preview, served to the webview from memory.
+ *
+ * The page is available under getUrl(); referenced local files (images,
+ * style sheets) are resolved below the same scheme and kept in memory as
+ * long as they are not modified. Only without integrated preview
+ * (NOPREVIEW) the page is written to a temporary file for the external
+ * browser.
+ */
+class PreviewContent : public QObject {
+  Q_OBJECT
+
+ public:
+    explicit PreviewContent(const QString &sPreviewFile,
+                            QObject *pParent = nullptr);
+
+    static const char SCHEME[];
+    // Has to be called before the application object is created
+    static void registerScheme();
+
+    auto setHtml(const QString &sHtml) -> bool;
+    auto getHtml() const -> QString;
+    auto getUrl() const -> QUrl;
+    auto isPreviewUrl(const QUrl &url) const -> bool;
+    // Script replacing the changed top-level blocks of the current page in
+    // the webview by those of sHtml (empty if nothing changed). False if
+    // the page has to be loaded again, e.g. if the title or tags changed.
+    auto createPatch(const QString &sHtml, QString &sScript) const -> bool;
+
+    // Script marking the first element of each block with data-src-line;
+    // its result (source lines and positions) is passed to setSourceMap()
+    auto getSourceMapScript() const -> QString;
+    void setSourceMap(const QVariant &result);
+    // Interpolated between the blocks; -1 without source map
+    auto getScrollPosition(const double dLine) const -> double;
+    auto getSourceLine(const double dScrollPos) const -> double;
+
+    // Data of the page or of a local file requested below the scheme
+    auto resource(const QUrl &url, QByteArray &baData,
+                  QByteArray &baMimeType) -> bool;
+
+ private:
+    struct Resource {
+      QByteArray baData;
+      QByteArray baMimeType;
+      QDateTime lastModified;
+    };
+
+    // Page without content (frame) and its top-level blocks
+    static auto splitBlocks(const QString &sHtml, QString &sFrame,
+                            QStringList &sListBlocks,
+                            QString &sSourceLines) -> bool;
+    static auto interpolate(const QVector<double> &vFrom,
+                            const QVector<double> &vTo,
+                            const double dValue) -> double;
+
+    const QString m_sPreviewFile;
+    QString m_sHtml;
+    QByteArray m_baHtml;  // UTF-8
+    bool m_bHasBlocks;
+    QString m_sFrame;
+    QStringList m_sListBlocks;
+    QString m_sSourceLines;  // Comma separated
+    QVector<double> m_vMapLines;  // Both ascending
+    QVector<double> m_vMapPositions;
+    QCache<QString, Resource> m_Resources;  // By file path
+};
+
+#ifdef USEQTWEBKIT
+/**
+ * \class PreviewNetworkAccessManager
+ * \brief Answers requests of the preview scheme from PreviewContent.
+ */
+class PreviewNetworkAccessManager : public QNetworkAccessManager {
+  Q_OBJECT
+
+ public:
+    explicit PreviewNetworkAccessManager(PreviewContent *pContent,
+                                         QObject *pParent = nullptr);
+
+ protected:
+    auto createRequest(Operation op, const QNetworkRequest &request,
+                       QIODevice *pOutgoingData) -> QNetworkReply * override;
+
+ private:
+    PreviewContent *m_pContent;
+};
+
+/**
+ * \class PreviewReply
+ * \brief Reply with data already in memory.
+ */
+class PreviewReply : public QNetworkReply {
+  Q_OBJECT
+
+ public:
+    PreviewReply(const QNetworkRequest &request, const bool bFound,
+                 const QByteArray &baData, const QByteArray &baMimeType,
+                 QObject *pParent = nullptr);
+
+    void abort() override;
+    auto bytesAvailable() const -> qint64 override;
+    auto isSequential() const -> bool override;
+
+ protected:
+    auto readData(char *pData, qint64 nMaxSize) -> qint64 override;
+
+ private slots:
+    void deliver();
+
+ private:
+    const QByteArray m_baData;
+    qint64 m_nOffset;
+    const bool m_bFound;
+};
+#endif
+
+#ifdef USEQTWEBENGINE
+/**
+ * \class PreviewSchemeHandler
+ * \brief Answers requests of the preview scheme from PreviewContent.
+ */
+class PreviewSchemeHandler : public QWebEngineUrlSchemeHandler {
+  Q_OBJECT
+
+ public:
+    explicit PreviewSchemeHandler(PreviewContent *pContent,
+                                  QObject *pParent = nullptr);
+
+    void requestStarted(QWebEngineUrlRequestJob *pJob) override;
+
+ private:
+    PreviewContent *m_pContent;
+};
+#endif
+
+#endif  // APPLICATION_PREVIEWCONTENT_H_
@@ -36,6 +36,8 @@
 #include <QUrl>
 #include <QUrlQuery>
 
+#include "./connectivitymonitor.h"
+
 Session::Session(QWidget *pParent, const QString &sHash, QObject *pObj)
   : m_pParent(pParent),
     m_State(REQUTOKEN),
@@ -287,6 +289,7 @@ void Session::replyFinished(QNetworkReply *pReply) {
 #ifndef QT_NO_CURSOR
   QApplication::restoreOverrideCursor();
 #endif
+  ConnectivityMonitor::instance()->reportReply(pReply);
 
   QIODevice *pData(pReply);
 
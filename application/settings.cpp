@@ -117,6 +117,9 @@ void Settings::readSettings(const QString &sSharePath) {
 
   m_sPygmentize = m_pSettings->value(QStringLiteral("Pygmentize"),
                                      "/usr/bin/pygmentize").toString();
+  // Built-in highlighter is used if pygments is not installed
+  m_bPreferPygments = m_pSettings->value(QStringLiteral("PreferPygments"),
+                                         true).toBool();
 
   m_bWinCheckUpdate = m_pSettings->value(
                         QStringLiteral("WindowsCheckForUpdate"),
@@ -275,6 +278,7 @@ void Settings::writeSettings(const QByteArray &WinGeometry,
   m_pSettings->setValue(QStringLiteral("TimedPreview"), m_nTimedPreview);
   m_pSettings->setValue(QStringLiteral("SyncScrollbars"), m_bSyncScrollbars);
   m_pSettings->setValue(QStringLiteral("Pygmentize"), m_sPygmentize);
+  m_pSettings->setValue(QStringLiteral("PreferPygments"), m_bPreferPygments);
 #if defined _WIN32
   m_pSettings->setValue(QStringLiteral("WindowsCheckForUpdate"),
                         m_bWinCheckUpdate);
@@ -440,6 +444,10 @@ auto Settings::getPygmentize() const -> QString {
   return m_sPygmentize;
 }
 
+auto Settings::getPreferPygments() const -> bool {
+  return m_bPreferPygments;
+}
+
 // ----------------------------------------------------
 
 auto Settings::getInyokaCommunity() const -> QString {
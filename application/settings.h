@@ -69,6 +69,7 @@ class Settings : public QObject {
     auto getSyncScrollbars() const -> bool;
     auto getWindowsCheckUpdate() const -> bool;
     auto getPygmentize() const -> QString;
+    auto getPreferPygments() const -> bool;
 
     // Inyoka community
     auto getInyokaCommunity() const-> QString;
@@ -136,6 +137,7 @@ class Settings : public QObject {
     bool m_bSyncScrollbars{};
     bool m_bWinCheckUpdate{};
     QString m_sPygmentize;
+    bool m_bPreferPygments{};
 
     // Inyoka community
     QString m_sInyokaCommunity;
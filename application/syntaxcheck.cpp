@@ -26,9 +26,7 @@
 
 #include "./syntaxcheck.h"
 
-#include <QMessageBox>
-#include <QRegularExpression>
-#include <QTextDocument>
+#include <algorithm>
 
 SyntaxCheck::SyntaxCheck(QObject *pParent) {
   Q_UNUSED(pParent)
@@ -37,186 +35,278 @@ SyntaxCheck::SyntaxCheck(QObject *pParent) {
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-auto SyntaxCheck::checkInyokaSyntax(
-    const QTextDocument *pRawDoc,
+auto SyntaxCheck::prepareRules(
     const QStringList &sListTplMacros,
     const QStringList &sListSmilies,
-    const QStringList &sListTplTrans) -> QPair<int, QString> {
-  QPair<int, QString> ret(-1, QLatin1String(""));
-  ret = SyntaxCheck::checkParenthesis(pRawDoc, sListSmilies);
-  if (-1 == ret.first) {
-    ret = SyntaxCheck::checkKnownTemplates(pRawDoc, sListTplMacros,
-                                           sListTplTrans);
+    const QStringList &sListTplTrans) -> Rules {
+  Rules rules;
+  for (const auto &s : sListSmilies) {
+    if (!s.isEmpty()) {
+      rules.smilies[s.at(0)] << s;
+    }
   }
-
-  return ret;
+  for (auto &sList : rules.smilies) {
+    std::stable_sort(sList.begin(), sList.end(),
+                     [](const QString &a, const QString &b) {
+      return a.length() > b.length();
+    });
+  }
+  for (const auto &s : sListTplMacros) {
+    rules.setTplMacros << s.toLower();
+  }
+  rules.sListTplTrans = sListTplTrans;
+  return rules;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-auto SyntaxCheck::checkParenthesis(
-    const QTextDocument *pRawDoc,
-    const QStringList &sListSmilies) -> QPair<int, QString> {
-  QList<QChar> listParenthesis;
-  QList<qint32> listPos;
-  QString sDoc(pRawDoc->toPlainText());
-  QString sReplace(QLatin1String(""));
+auto SyntaxCheck::checkInyokaSyntax(
+    const QString &sRawDoc,
+    const QStringList &sListTplMacros,
+    const QStringList &sListSmilies,
+    const QStringList &sListTplTrans) -> QVector<SyntaxDiagnostic> {
+  const Rules rules(SyntaxCheck::prepareRules(sListTplMacros, sListSmilies,
+                                              sListTplTrans));
+  const QStringList sListLines(sRawDoc.split('\n'));
+  QVector<int> vLineStarts;
+  vLineStarts.reserve(sListLines.size());
+  QVector<OpenBracket> vOpenBrackets;
+  QVector<SyntaxDiagnostic> diagnostics;
+
+  int nPos = 0;
+  for (int i = 0; i < sListLines.size(); i++) {
+    vLineStarts << nPos;
+    diagnostics << SyntaxCheck::checkLine(sListLines.at(i), i, rules,
+                                          vOpenBrackets);
+    nPos += sListLines.at(i).length() + 1;
+  }
+  diagnostics << SyntaxCheck::unclosedBrackets(vOpenBrackets);
 
-  // Replace smilies, since most of them are including open parenthesis
-  for (const auto &s : sListSmilies) {
-    sDoc = sDoc.replace(s, sReplace.fill('X', s.length()));
+  for (auto &diagnostic : diagnostics) {
+    diagnostic.nStart = vLineStarts.at(diagnostic.nLine - 1) +
+                        diagnostic.nColumn - 1;
+  }
+  std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                   [](const SyntaxDiagnostic &a, const SyntaxDiagnostic &b) {
+    return a.nStart < b.nStart;
+  });
+  return diagnostics;
+}
+
+// ----------------------------------------------------------------------------
+
+auto SyntaxCheck::checkLine(
+    const QString &sLine, const int nLine, const Rules &rules,
+    QVector<OpenBracket> &vOpenBrackets) -> QVector<SyntaxDiagnostic> {
+  QVector<SyntaxDiagnostic> diagnostics;
+  // Comments are not part of the output
+  if (sLine.startsWith(QLatin1String("##"))) {
+    return diagnostics;
   }
-  // Replace left/right text alignment in tables
-  sDoc = sDoc.replace(QLatin1String("<(>"), sReplace.fill('X', 3));
-  sDoc = sDoc.replace(QLatin1String("<)>"), sReplace.fill('X', 3));
 
-  SyntaxCheck::filterMonotype(sDoc);
+  int i = 0;
+  while (i < sLine.length()) {
+    const QChar c(sLine.at(i));
+
+    // Smilies, since most of them are including parenthesis
+    const int nSmiley = SyntaxCheck::matchSmiley(sLine, i, rules.smilies);
+    if (nSmiley > 0) {
+      i += nSmiley;
+      continue;
+    }
+
+    // Left/right text alignment in tables
+    if ('<' == c && (sLine.midRef(i, 3) == QLatin1String("<(>") ||
+                     sLine.midRef(i, 3) == QLatin1String("<)>"))) {
+      i += 3;
+      continue;
+    }
+
+    if ('`' == c) {
+      i = SyntaxCheck::skipMonotype(sLine, i);
+      continue;
+    }
 
-  listParenthesis.clear();
-  QPair<int, QString> ret(-1, QLatin1String(""));
-  qint32 nCnt(-1);
-  for (const auto c : qAsConst(sDoc)) {
-    nCnt++;
+    if ('[' == c || '{' == c) {
+      SyntaxCheck::checkTemplate(sLine, nLine, i, rules, diagnostics);
+    }
     if ('(' == c || '{' == c || '[' == c) {
-      listParenthesis.push_back(c);
-      listPos.push_back(nCnt);
+      OpenBracket open;
+      open.c = c;
+      open.nLine = nLine;
+      open.nColumn = i;
+      vOpenBrackets << open;
     } else if (')' == c || '}' == c || ']' == c) {
-      if (listParenthesis.isEmpty() ||
-          !SyntaxCheck::checkParenthesisPair(listParenthesis.last(), c)) {
-        ret.first = nCnt;
-        ret.second = QStringLiteral("OPEN_PAR_MISSING");
-        return ret;
-      }
-      listParenthesis.pop_back();
-      listPos.pop_back();
+      SyntaxCheck::closeBracket(c, nLine, i, vOpenBrackets, diagnostics);
     }
+    i++;
   }
 
-  if (!listParenthesis.isEmpty()) {
-    ret.first = listPos.last();
-    ret.second = QStringLiteral("CLOSE_PAR_MISSING");
-    return ret;
+  return diagnostics;
+}
+
+// ----------------------------------------------------------------------------
+
+auto SyntaxCheck::unclosedBrackets(
+    const QVector<OpenBracket> &vOpenBrackets) -> QVector<SyntaxDiagnostic> {
+  QVector<SyntaxDiagnostic> diagnostics;
+  for (const auto &open : vOpenBrackets) {
+    diagnostics << SyntaxCheck::createDiagnostic(
+                     QStringLiteral("CLOSE_PAR_MISSING"),
+                     open.nLine, open.nColumn, 1);
   }
-  return ret;
+  return diagnostics;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-auto SyntaxCheck::checkParenthesisPair(const QChar cLeft,
-                                       const QChar cRight) -> bool {
-  if ('[' == cLeft && ']' == cRight) {
-    return true;
-  }
-  if ('(' == cLeft && ')' == cRight) {
-    return true;
+// Returns length of the smiley at nPos or 0
+auto SyntaxCheck::matchSmiley(
+    const QString &sLine, const int nPos,
+    const QHash<QChar, QStringList> &smilies) -> int {
+  const auto it = smilies.constFind(sLine.at(nPos));
+  if (smilies.constEnd() == it) {
+    return 0;
   }
-  if ('{' == cLeft && '}' == cRight) {
-    return true;
+  for (const auto &s : it.value()) {
+    if (sLine.midRef(nPos, s.length()) == s) {
+      return s.length();
+    }
   }
-  return false;
+  return 0;
 }
 
 // ----------------------------------------------------------------------------
+
+// Returns position after monotype text starting at nPos (`` or `)
+auto SyntaxCheck::skipMonotype(const QString &sLine, const int nPos) -> int {
+  if (sLine.midRef(nPos, 2) == QLatin1String("``")) {
+    const int nEnd = sLine.indexOf(QLatin1String("``"), nPos + 2);
+    if (-1 != nEnd) {
+      return nEnd + 2;
+    }
+  }
+  const int nEnd = sLine.indexOf('`', nPos + 1);
+  return (-1 == nEnd) ? nPos + 1 : nEnd + 1;
+}
+
 // ----------------------------------------------------------------------------
 
-auto SyntaxCheck::checkKnownTemplates(
-    const QTextDocument *pRawDoc,
-    const QStringList &sListTplMacros,
-    const QStringList &sListTplTrans) -> QPair<int, QString> {
-  QStringList sListTplRegExp;
-  QStringList sListTrans;
-  for (const auto &s : sListTplTrans) {
-    sListTplRegExp << "\\{\\{\\{#!" + s + " .+\\}\\}\\}"
-                   << "\\[\\[" + s + "\\s*\\(.+\\)\\]\\]";
-    sListTrans << s << s;
+auto SyntaxCheck::closingBracket(const QChar cOpen) -> QChar {
+  if ('[' == cOpen) {
+    return ']';
   }
-  QString sDoc(pRawDoc->toPlainText());
-  SyntaxCheck::filterMonotype(sDoc);
-  QPair<int, QString> ret(-1, QLatin1String(""));
-
-  for (int i = 0; i < sListTplRegExp.size(); i++) {
-    QRegularExpression findTemplate(
-          sListTplRegExp[i],
-          QRegularExpression::InvertedGreedinessOption |
-          QRegularExpression::DotMatchesEverythingOption |
-          QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatchIterator it = findTemplate.globalMatch(sDoc);
-
-    while (it.hasNext()) {
-      QRegularExpressionMatch match = it.next();
-      QString sMacro = match.captured(0);
-      if (sMacro.startsWith("[[" + sListTrans[i],
-                            Qt::CaseInsensitive)) {
-        sMacro.remove("[[" + sListTrans[i], Qt::CaseInsensitive);
-        sMacro = sMacro.trimmed();
-        sMacro.remove(0, 1);  // Remove (
-        sMacro = sMacro.left(sMacro.indexOf(QLatin1String(","))).trimmed();
-        sMacro.remove(QStringLiteral(")]]"));  // Needed if no "," is used
-        sMacro = sMacro.trimmed();
-
-        if (sListTplMacros.contains(sMacro, Qt::CaseInsensitive)) {
-          sMacro.clear();
-        }
-      } else if (sMacro.startsWith("{{{#!" + sListTrans[i] + " ",
-                                   Qt::CaseInsensitive)) {
-        sMacro.remove("{{{#!" + sListTrans[i] + " ", Qt::CaseInsensitive);
-        sMacro = sMacro.trimmed();
-        if (-1 != sMacro.indexOf(QLatin1String(" ")) &&
-            -1 != sMacro.indexOf(QLatin1String("\n"))) {
-          if (sMacro.indexOf(QLatin1String(" ")) < sMacro.indexOf(
-                QLatin1String("\n"))) {
-            sMacro = sMacro.left(sMacro.indexOf(QLatin1String(" "))).trimmed();
-          } else {
-            sMacro = sMacro.left(sMacro.indexOf(QLatin1String("\n"))).trimmed();
-          }
-        } else {
-          sMacro = sMacro.left(sMacro.indexOf(QLatin1String("\n"))).trimmed();
-        }
-
-        sMacro = sMacro.remove(',');
-        sMacro = sMacro.trimmed();
-
-        if (sListTplMacros.contains(sMacro, Qt::CaseInsensitive)) {
-          sMacro.clear();
-        }
-      }
+  if ('(' == cOpen) {
+    return ')';
+  }
+  return '}';
+}
+
+// ----------------------------------------------------------------------------
 
-      if (!sMacro.isEmpty()) {
-        ret.first = match.capturedStart();
-        ret.second = QStringLiteral("UNKNOWN_TPL|") + sMacro;
+void SyntaxCheck::closeBracket(const QChar c, const int nLine, const int nPos,
+                               QVector<OpenBracket> &vOpenBrackets,
+                               QVector<SyntaxDiagnostic> &diagnostics) {
+  for (int i = vOpenBrackets.size() - 1; i >= 0; i--) {
+    if (SyntaxCheck::closingBracket(vOpenBrackets.at(i).c) == c) {
+      // Brackets opened in between have not been closed
+      for (int j = vOpenBrackets.size() - 1; j > i; j--) {
+        diagnostics << SyntaxCheck::createDiagnostic(
+                         QStringLiteral("CLOSE_PAR_MISSING"),
+                         vOpenBrackets.at(j).nLine,
+                         vOpenBrackets.at(j).nColumn, 1);
       }
+      vOpenBrackets.resize(i);
+      return;
     }
   }
 
-  return ret;
+  diagnostics << SyntaxCheck::createDiagnostic(
+                   QStringLiteral("OPEN_PAR_MISSING"), nLine, nPos, 1);
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void SyntaxCheck::filterMonotype(QString &sDoc) {
-  QString sReplace(QLatin1String(""));
-  QStringList sListMonotype;
-  sListMonotype << QStringLiteral("``");
-  sListMonotype << QStringLiteral("`");
-  for (int i = 0; i < sListMonotype.size(); i++) {
-    int nStart = -1;
-    int nEnd = -1;
-    int nIndex = 0;
-    while (-1 != sDoc.indexOf(sListMonotype[i], nIndex)) {
-      if (-1 == nStart) {
-        nStart = sDoc.indexOf(sListMonotype[i], nIndex);
-        nIndex = nStart + sListMonotype[i].length();
-      } else {
-        nEnd = sDoc.indexOf(sListMonotype[i], nIndex);
-        sDoc.replace(nStart, nEnd - nStart + sListMonotype[i].length(),
-                     sReplace.fill('X',
-                                   nEnd - nStart + sListMonotype[i].length()));
-        nIndex = nEnd + sListMonotype[i].length();
-        nStart = -1;
+// Checks template name of [[Vorlage(Name, ...)]] / {{{#!vorlage Name ...}}}
+void SyntaxCheck::checkTemplate(const QString &sLine, const int nLine,
+                                const int nPos, const Rules &rules,
+                                QVector<SyntaxDiagnostic> &diagnostics) {
+  const int nLen = sLine.length();
+  for (const auto &sTrans : rules.sListTplTrans) {
+    int nNameStart = -1;
+    int nNameEnd = -1;
+
+    if ('[' == sLine.at(nPos) &&
+        0 == sLine.midRef(nPos, 2 + sTrans.length()).compare(
+          "[[" + sTrans, Qt::CaseInsensitive)) {
+      int i = nPos + 2 + sTrans.length();
+      while (i < nLen && sLine.at(i).isSpace()) {
+        i++;
+      }
+      if (i >= nLen || '(' != sLine.at(i)) {
+        continue;
+      }
+      // Name ends with first argument or macro, whichever comes first
+      // (further macros may follow in the same line); arguments may be
+      // continued in the following lines
+      const int nComma = sLine.indexOf(',', i + 1);
+      int nEnd = sLine.indexOf(QLatin1String(")]]"), i + 1);
+      if (-1 == nEnd || (-1 != nComma && nComma < nEnd)) {
+        nEnd = nComma;
+      }
+      if (-1 == nEnd) {
+        continue;
+      }
+      nNameStart = i + 1;
+      nNameEnd = nEnd;
+    } else if ('{' == sLine.at(nPos) &&
+               0 == sLine.midRef(nPos, 6 + sTrans.length()).compare(
+                 "{{{#!" + sTrans + " ", Qt::CaseInsensitive)) {
+      int i = nPos + 6 + sTrans.length();
+      int nEnd = sLine.indexOf(QLatin1String("}}}"), i);
+      if (-1 == nEnd) {
+        nEnd = nLen;
+      }
+      while (i < nEnd && sLine.at(i).isSpace()) {
+        i++;
+      }
+      nNameStart = i;
+      while (i < nEnd && !sLine.at(i).isSpace()) {
+        i++;
       }
+      nNameEnd = i;
+    } else {
+      continue;
     }
+
+    QString sName(sLine.mid(nNameStart, nNameEnd - nNameStart));
+    sName = sName.remove(',').trimmed();
+    if (!sName.isEmpty() && !rules.setTplMacros.contains(sName.toLower())) {
+      diagnostics << SyntaxCheck::createDiagnostic(
+                       QStringLiteral("UNKNOWN_TPL"), nLine, nPos,
+                       nNameEnd - nPos, sName);
+    }
+    return;
   }
 }
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto SyntaxCheck::createDiagnostic(
+    const QString &sCode, const int nLine, const int nColumn,
+    const int nLength, const QString &sDetail) -> SyntaxDiagnostic {
+  SyntaxDiagnostic diagnostic;
+  diagnostic.sCode = sCode;
+  diagnostic.sDetail = sDetail;
+  diagnostic.nStart = -1;
+  diagnostic.nLength = nLength;
+  diagnostic.nLine = nLine + 1;
+  diagnostic.nColumn = nColumn + 1;
+  diagnostic.nEndLine = nLine + 1;
+  diagnostic.nEndColumn = nColumn + nLength + 1;
+  return diagnostic;
+}
@@ -27,9 +27,25 @@
 #ifndef APPLICATION_SYNTAXCHECK_H_
 #define APPLICATION_SYNTAXCHECK_H_
 
+#include <QHash>
+#include <QMetaType>
 #include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
 
-class QTextDocument;
+// One problem found by the syntax check; positions refer to the checked text
+struct SyntaxDiagnostic {
+  QString sCode;  // OPEN_PAR_MISSING, CLOSE_PAR_MISSING, UNKNOWN_TPL
+  QString sDetail;  // E.g. name of an unknown template
+  int nStart;
+  int nLength;
+  int nLine;  // Lines and columns are starting with 1
+  int nColumn;
+  int nEndLine;  // End is exclusive
+  int nEndColumn;
+};
+Q_DECLARE_METATYPE(SyntaxDiagnostic)
 
 class SyntaxCheck : public QObject {
   Q_OBJECT
@@ -37,24 +53,62 @@ class SyntaxCheck : public QObject {
  public:
     explicit SyntaxCheck(QObject *pParent = nullptr);
 
+    // Bracket which has not been closed yet (line and column start with 0)
+    struct OpenBracket {
+      QChar c;
+      int nLine;
+      int nColumn;
+
+      auto operator==(const OpenBracket &other) const -> bool {
+        return c == other.c && nLine == other.nLine &&
+            nColumn == other.nColumn;
+      }
+    };
+
+    // Lookup tables prepared once for checking many lines
+    struct Rules {
+      QHash<QChar, QStringList> smilies;  // By first character, longest first
+      QSet<QString> setTplMacros;  // Lower case
+      QStringList sListTplTrans;
+    };
+
+    static auto prepareRules(const QStringList &sListTplMacros,
+                             const QStringList &sListSmilies,
+                             const QStringList &sListTplTrans) -> Rules;
+
+    // Checks the whole text in one pass and returns all diagnostics sorted
+    // by position. Comment lines (##) are ignored.
     static auto checkInyokaSyntax(
-        const QTextDocument *pRawDoc,
+        const QString &sRawDoc,
         const QStringList &sListTplMacros,
         const QStringList &sListSmilies,
-        const QStringList &sListTplTrans) -> QPair <int, QString>;
+        const QStringList &sListTplTrans) -> QVector<SyntaxDiagnostic>;
 
- private:
-    static auto checkParenthesis(
-        const QTextDocument *pRawDoc,
-        const QStringList &sListSmilies) -> QPair <int, QString>;
-    static auto checkParenthesisPair(const QChar cLeft,
-                                     const QChar cRight) -> bool;
-    static auto checkKnownTemplates(
-        const QTextDocument *pRawDoc,
-        const QStringList &sListTplMacros,
-        const QStringList &sListTplTrans) -> QPair <int, QString>;
+    // Checks a single line; vOpenBrackets contains the brackets left open by
+    // the previous lines and is updated. Only lines and columns of the
+    // returned diagnostics are set, start positions are -1.
+    static auto checkLine(
+        const QString &sLine, const int nLine, const Rules &rules,
+        QVector<OpenBracket> &vOpenBrackets) -> QVector<SyntaxDiagnostic>;
+    // Diagnostics for brackets still open at the end of the text
+    static auto unclosedBrackets(
+        const QVector<OpenBracket> &vOpenBrackets) -> QVector<SyntaxDiagnostic>;
 
-    static void filterMonotype(QString &sDoc);
+ private:
+    static auto matchSmiley(const QString &sLine, const int nPos,
+                            const QHash<QChar, QStringList> &smilies) -> int;
+    static auto skipMonotype(const QString &sLine, const int nPos) -> int;
+    static auto closingBracket(const QChar cOpen) -> QChar;
+    static void closeBracket(const QChar c, const int nLine, const int nPos,
+                             QVector<OpenBracket> &vOpenBrackets,
+                             QVector<SyntaxDiagnostic> &diagnostics);
+    static void checkTemplate(const QString &sLine, const int nLine,
+                              const int nPos, const Rules &rules,
+                              QVector<SyntaxDiagnostic> &diagnostics);
+    static auto createDiagnostic(
+        const QString &sCode, const int nLine, const int nColumn,
+        const int nLength,
+        const QString &sDetail = QString()) -> SyntaxDiagnostic;
 };
 
 #endif  // APPLICATION_SYNTAXCHECK_H_
@@ -0,0 +1,164 @@
+/**
+ * \file multireplacer.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Replacing many patterns in one pass.
+ */
+
+#include "./multireplacer.h"
+
+#include <QQueue>
+
+MultiReplacer::MultiReplacer()
+  : m_Nodes(1) {
+}
+
+MultiReplacer::MultiReplacer(const QStringList &sListPatterns)
+  : m_Nodes(1) {
+  for (int i = 0; i < sListPatterns.size(); i++) {
+    m_vPatternLengths << sListPatterns.at(i).length();
+    if (sListPatterns.at(i).isEmpty()) {
+      continue;
+    }
+
+    int nNode = 0;
+    for (const auto c : sListPatterns.at(i)) {
+      auto it = m_Nodes[nNode].next.constFind(c.unicode());
+      if (m_Nodes[nNode].next.constEnd() == it) {
+        m_Nodes.append(Node());
+        m_Nodes[nNode].next.insert(c.unicode(), m_Nodes.size() - 1);
+        nNode = m_Nodes.size() - 1;
+      } else {
+        nNode = it.value();
+      }
+    }
+    if (-1 == m_Nodes.at(nNode).nPattern) {  // First one wins for duplicates
+      m_Nodes[nNode].nPattern = i;
+    }
+  }
+  this->buildFailLinks();
+}
+
+// ----------------------------------------------------------------------------
+
+// Breadth first, thus fail links always point to already finished nodes
+void MultiReplacer::buildFailLinks() {
+  QQueue<int> queue;
+  for (const int nChild : qAsConst(m_Nodes[0].next)) {
+    queue.enqueue(nChild);
+  }
+
+  while (!queue.isEmpty()) {
+    const int nNode = queue.dequeue();
+    for (auto it = m_Nodes.at(nNode).next.constBegin();
+         it != m_Nodes.at(nNode).next.constEnd(); ++it) {
+      const int nChild = it.value();
+      queue.enqueue(nChild);
+
+      int nFail = m_Nodes.at(nNode).nFail;
+      while (0 != nFail && !m_Nodes.at(nFail).next.contains(it.key())) {
+        nFail = m_Nodes.at(nFail).nFail;
+      }
+      nFail = m_Nodes.at(nFail).next.value(it.key(), 0);
+      m_Nodes[nChild].nFail = nFail;
+      m_Nodes[nChild].nOutput = (-1 != m_Nodes.at(nFail).nPattern)
+                                ? nFail : m_Nodes.at(nFail).nOutput;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto MultiReplacer::isEmpty() const -> bool {
+  return m_Nodes.at(0).next.isEmpty();
+}
+
+// ----------------------------------------------------------------------------
+
+auto MultiReplacer::findAll(const QString &sText) const -> QVector<Match> {
+  QVector<Match> matches;
+  if (this->isEmpty()) {
+    return matches;
+  }
+
+  // Longest pattern starting at each position
+  QVector<int> vLongest;
+  int nNode = 0;
+  for (int i = 0; i < sText.length(); i++) {
+    const ushort c = sText.at(i).unicode();
+    while (0 != nNode && !m_Nodes.at(nNode).next.contains(c)) {
+      nNode = m_Nodes.at(nNode).nFail;
+    }
+    nNode = m_Nodes.at(nNode).next.value(c, 0);
+
+    int nOut = (-1 != m_Nodes.at(nNode).nPattern) ? nNode
+                                                   : m_Nodes.at(nNode).nOutput;
+    while (0 != nOut) {
+      const int nPattern = m_Nodes.at(nOut).nPattern;
+      const int nStart = i + 1 - m_vPatternLengths.at(nPattern);
+      if (vLongest.isEmpty()) {
+        vLongest.fill(-1, sText.length());
+      }
+      if (-1 == vLongest.at(nStart) ||
+          m_vPatternLengths.at(vLongest.at(nStart)) <
+          m_vPatternLengths.at(nPattern)) {
+        vLongest[nStart] = nPattern;
+      }
+      nOut = m_Nodes.at(nOut).nOutput;
+    }
+  }
+
+  int i = 0;
+  while (i < vLongest.size()) {
+    const int nPattern = vLongest.at(i);
+    if (-1 == nPattern) {
+      i++;
+      continue;
+    }
+    matches.append({i, m_vPatternLengths.at(nPattern), nPattern});
+    i += m_vPatternLengths.at(nPattern);
+  }
+  return matches;
+}
+
+// ----------------------------------------------------------------------------
+
+void MultiReplacer::replaceAll(
+    QString &sText,
+    const std::function<QString(int)> &replacement) const {
+  const QVector<Match> matches(this->findAll(sText));
+  if (matches.isEmpty()) {
+    return;
+  }
+
+  QString sResult;
+  sResult.reserve(sText.length());
+  int nLast = 0;
+  for (const auto &match : matches) {
+    sResult += sText.midRef(nLast, match.nPos - nLast);
+    sResult += replacement(match.nPattern);
+    nLast = match.nPos + match.nLength;
+  }
+  sResult += sText.midRef(nLast);
+  sText = sResult;
+}
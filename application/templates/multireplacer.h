@@ -0,0 +1,76 @@
+/**
+ * \file multireplacer.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for replacing many patterns in one pass.
+ */
+
+#ifndef APPLICATION_TEMPLATES_MULTIREPLACER_H_
+#define APPLICATION_TEMPLATES_MULTIREPLACER_H_
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * \class MultiReplacer
+ * \brief Finds all occurrences of a fixed set of patterns in one pass.
+ *
+ * Patterns are stored in an Aho-Corasick automaton, which is built once.
+ * Matching is leftmost-longest: at each position the longest pattern
+ * wins and matches do not overlap.
+ */
+class MultiReplacer {
+ public:
+    struct Match {
+      int nPos;
+      int nLength;
+      int nPattern;  // Index in pattern list
+    };
+
+    MultiReplacer();
+    explicit MultiReplacer(const QStringList &sListPatterns);
+
+    auto isEmpty() const -> bool;
+    // Thread-safe
+    auto findAll(const QString &sText) const -> QVector<Match>;
+    // Replaces each match by the text returned for its pattern index
+    void replaceAll(QString &sText,
+                    const std::function<QString(int)> &replacement) const;
+
+ private:
+    struct Node {
+      QHash<ushort, int> next;
+      int nFail = 0;
+      int nPattern = -1;  // Pattern ending here
+      int nOutput = 0;  // Next node on the fail path ending a pattern
+    };
+
+    void buildFailLinks();
+
+    QVector<Node> m_Nodes;
+    QVector<int> m_vPatternLengths;
+};
+
+#endif  // APPLICATION_TEMPLATES_MULTIREPLACER_H_
@@ -26,10 +26,8 @@
 
 #include "./templates.h"
 
-#include <QApplication>
 #include <QDebug>
 #include <QDir>
-#include <QMessageBox>
 #include <QSettings>
 
 Templates::Templates(const QString &sCommunity, const QString &sSharePath,
@@ -39,44 +37,46 @@ Templates::Templates(const QString &sCommunity, const QString &sSharePath,
   this->initHtmlTpl(sPath + "/Preview.tpl");
   m_sListIWLs.clear();
   m_sListIWLUrls.clear();
-  Templates::initMappings(sPath + "/linkmap/linkmap.csv", ',',
-                          m_sListIWLs, m_sListIWLUrls);
+  this->initMappings(sPath + "/linkmap/linkmap.csv", ',',
+                     m_sListIWLs, m_sListIWLUrls);
   m_sListIWLs << QStringLiteral("user");      // "Build-in" IWL
   m_sListIWLUrls << QStringLiteral("user/");  // TODO(): Add community URL?
 
   m_sListFlags.clear();
   m_sListFlagsImg.clear();
-  Templates::initMappings(sPath + "/flagmap/flagmap.csv", ',',
-                          m_sListFlags, m_sListFlagsImg);
+  this->initMappings(sPath + "/flagmap/flagmap.csv", ',',
+                     m_sListFlags, m_sListFlagsImg);
   m_sListSmilies.clear();
   m_sListSmiliesImg.clear();
-  Templates::initMappings(sPath + "/SmileysMap.csv", ',',
-                          m_sListSmilies, m_sListSmiliesImg);
+  this->initMappings(sPath + "/SmileysMap.csv", ',',
+                     m_sListSmilies, m_sListSmiliesImg);
+  m_FlagReplacer = Templates::createReplacer(m_sListFlags);
+  m_SmileyReplacer = Templates::createReplacer(m_sListSmilies);
   this->initTextformats(sPath + "/Textformats.conf");
 
   sPath = "/community/" + sCommunity;
 
   m_sListTestedWith.clear();
   m_sListTestedWithStrings.clear();
-  Templates::initMappings(sSharePath + sPath + "/templates/TestedWith.conf",
-                          '=', m_sListTestedWith, m_sListTestedWithStrings);
+  this->initMappings(sSharePath + sPath + "/templates/TestedWith.conf",
+                     '=', m_sListTestedWith, m_sListTestedWithStrings);
   QFile tmpFile(sUserDataDir + sPath + "/templates/TestedWith.conf");
   if (tmpFile.exists()) {
-    Templates::initMappings(tmpFile.fileName(), '=',
-                            m_sListTestedWith, m_sListTestedWithStrings);
+    this->initMappings(tmpFile.fileName(), '=',
+                       m_sListTestedWith, m_sListTestedWithStrings);
   }
 
   m_sListTestedWithTouch.clear();
   m_sListTestedWithTouchStrings.clear();
-  Templates::initMappings(
+  this->initMappings(
         sSharePath + sPath + "/templates/TestedWithTouch.conf",
         '=', m_sListTestedWithTouch,
         m_sListTestedWithTouchStrings);
   tmpFile.setFileName(sUserDataDir + sPath + "/templates/TestedWithTouch.conf");
   if (tmpFile.exists()) {
-    Templates::initMappings(tmpFile.fileName(), '=',
-                            m_sListTestedWithTouch,
-                            m_sListTestedWithTouchStrings);
+    this->initMappings(tmpFile.fileName(), '=',
+                       m_sListTestedWithTouch,
+                       m_sListTestedWithTouchStrings);
   }
 }
 
@@ -128,9 +128,8 @@ void Templates::initTemplates(const QString &sTplPath) {
         }
         TplFile.close();
       } else {
-        QMessageBox::warning(nullptr, QStringLiteral("Warning"),
-                             "Could not open template file: \n" +
-                             fi.absoluteFilePath());
+        m_sListWarnings << "Could not open template file: \n" +
+                           fi.absoluteFilePath();
         qWarning() << "Could not open template file:"
                    << fi.absoluteFilePath();
       }
@@ -147,9 +146,8 @@ void Templates::initTemplates(const QString &sTplPath) {
         }
         TplFile.close();
       } else {
-        QMessageBox::warning(nullptr, QStringLiteral("Warning"),
-                             "Could not open macro file: \n" +
-                             fi.absoluteFilePath());
+        m_sListWarnings << "Could not open macro file: \n" +
+                           fi.absoluteFilePath();
         qWarning() << "Could not open macro file:"
                    << fi.absoluteFilePath();
       }
@@ -160,9 +158,8 @@ void Templates::initTemplates(const QString &sTplPath) {
   m_sListTplNamesALL.append(m_sListTplNamesINY);
 
   if (m_sListTplNamesINY.isEmpty()) {
-    QMessageBox::warning(
-          nullptr, QStringLiteral("Warning"),
-          QStringLiteral("Could not find any markup template files!"));
+    m_sListWarnings << QStringLiteral(
+                         "Could not find any markup template files!");
     qWarning() << "Could not find any template files in:"
                << TplDir.absolutePath();
   }
@@ -176,9 +173,8 @@ void Templates::initTemplates(const QString &sTplPath) {
 void Templates::initHtmlTpl(const QString &sTplFile) {
   QFile HTMLTplFile(sTplFile);
   if (!HTMLTplFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(
-          nullptr, QStringLiteral("Warning"),
-          QStringLiteral("Could not open preview template file!"));
+    m_sListWarnings << QStringLiteral(
+                         "Could not open preview template file!");
     qWarning() << "Could not open preview template file:"
                << HTMLTplFile.fileName();
     m_sPreviewTemplate = QStringLiteral("ERROR");
@@ -200,9 +196,7 @@ void Templates::initMappings(const QString &sFileName,
                              QStringList &sListMapping) {
   QFile MapFile(sFileName);
   if (!MapFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(
-          nullptr, QStringLiteral("Warning"),
-          QStringLiteral("Could not open mapping file!"));
+    m_sListWarnings << QStringLiteral("Could not open mapping file!");
     qWarning() << "Could not open mapping config file:"
                << MapFile.fileName();
     sListElements << QStringLiteral("ERROR");
@@ -230,6 +224,18 @@ void Templates::initMappings(const QString &sFileName,
   }
 }
 
+// ----------------------------------------------------------------------------
+
+auto Templates::createReplacer(
+    const QStringList &sListElements) -> MultiReplacer {
+  // Mapping could not be loaded
+  if (!sListElements.isEmpty() &&
+      QLatin1String("error") == sListElements.at(0).toLower()) {
+    return MultiReplacer();
+  }
+  return MultiReplacer(sListElements);
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
@@ -238,9 +244,7 @@ void Templates::initTextformats(const QString &sFilename) {
   QStringList sListInput;
 
   if (!formatsFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(
-          nullptr, QStringLiteral("Warning"),
-          QStringLiteral("Could not open text formats file!"));
+    m_sListWarnings << QStringLiteral("Could not open text formats file!");
     qWarning() << "Could not open text formats config file:"
                << formatsFile.fileName();
     // Initialize possible text formats
@@ -329,6 +333,12 @@ auto Templates::getListSmilies() const -> QStringList {
 auto Templates::getListSmiliesImg() const -> QStringList {
   return m_sListSmiliesImg;
 }
+auto Templates::getFlagReplacer() const -> const MultiReplacer & {
+  return m_FlagReplacer;
+}
+auto Templates::getSmileyReplacer() const -> const MultiReplacer & {
+  return m_SmileyReplacer;
+}
 
 auto Templates::getListTestedWith() const -> QStringList {
   return m_sListTestedWith;
@@ -343,3 +353,9 @@ auto Templates::getListTestedWithTouch() const -> QStringList {
 auto Templates::getListTestedWithTouchStrings() const -> QStringList {
   return m_sListTestedWithTouchStrings;
 }
+
+// ----------------------------------------------------------------------------
+
+auto Templates::getWarnings() const -> QStringList {
+  return m_sListWarnings;
+}
@@ -30,6 +30,8 @@
 #include <QString>
 #include <QStringList>
 
+#include "./multireplacer.h"
+
 class Templates {
  public:
     Templates(const QString &sCommunity, const QString &sSharePath,
@@ -54,20 +56,29 @@ class Templates {
     auto getListFlagsImg() const -> QStringList;
     auto getListSmilies() const -> QStringList;
     auto getListSmiliesImg() const -> QStringList;
+    // Matchers for the elements of above lists, built once
+    auto getFlagReplacer() const -> const MultiReplacer &;
+    auto getSmileyReplacer() const -> const MultiReplacer &;
     auto getListTestedWith() const -> QStringList;
     auto getListTestedWithStrings() const -> QStringList;
     auto getListTestedWithTouch() const -> QStringList;
     auto getListTestedWithTouchStrings() const -> QStringList;
 
+    // Problems while loading the community files, to be shown by the GUI
+    auto getWarnings() const -> QStringList;
+
  private:
     void initTemplates(const QString &sTplPath);
     void initHtmlTpl(const QString &sTplFile);
-    static void initMappings(const QString &sFileName,
-                             const QChar cSplit,
-                             QStringList &sListElements,
-                             QStringList &sListMapping);
+    void initMappings(const QString &sFileName,
+                      const QChar cSplit,
+                      QStringList &sListElements,
+                      QStringList &sListMapping);
     void initTextformats(const QString &sFileName);
+    static auto createReplacer(
+        const QStringList &sListElements) -> MultiReplacer;
 
+    QStringList m_sListWarnings;
     QString m_sPreviewTemplate;
     QStringList m_sListTplNamesINY;
     QStringList m_sListTemplatesINY;
@@ -90,6 +101,8 @@ class Templates {
     QStringList m_sListFlagsImg;
     QStringList m_sListSmilies;
     QStringList m_sListSmiliesImg;
+    MultiReplacer m_FlagReplacer;
+    MultiReplacer m_SmileyReplacer;
     QStringList m_sListTestedWith;
     QStringList m_sListTestedWithStrings;
     QStringList m_sListTestedWithTouch;
@@ -17,8 +17,8 @@
 INCLUDEPATH += $$PWD
 DEPENDPATH  += $$PWD
 
-QT          += widgets
+HEADERS     += $$PWD/templates.h \
+               $$PWD/multireplacer.h
 
-HEADERS     += $$PWD/templates.h
-
-SOURCES     += $$PWD/templates.cpp
+SOURCES     += $$PWD/templates.cpp \
+               $$PWD/multireplacer.cpp
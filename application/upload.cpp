@@ -39,6 +39,7 @@
 #include <QRegularExpression>
 #include <QTextEdit>
 
+#include "./connectivitymonitor.h"
 #include "./session.h"
 #include "./utils.h"
 
@@ -325,6 +326,7 @@ void Upload::replyFinished(QNetworkReply *pReply) {
 #ifndef QT_NO_CURSOR
   QApplication::restoreOverrideCursor();
 #endif
+  ConnectivityMonitor::instance()->reportReply(pReply);
 
   QIODevice *pData(pReply);
 
@@ -29,7 +29,6 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDesktopServices>
-#include <QEventLoop>
 #include <QNetworkProxy>
 #include <QMessageBox>
 #include <QPushButton>
@@ -37,6 +36,8 @@
 #include <QNetworkReply>
 #include <QRegularExpression>
 
+#include "./connectivitymonitor.h"
+
 Utils::Utils(QWidget *pParent, QObject *pParentObj)
   : m_pParent(pParent) {
   Q_UNUSED(pParentObj)
@@ -49,22 +50,8 @@ Utils::Utils(QWidget *pParent, QObject *pParentObj)
 // ----------------------------------------------------------------------------
 
 auto Utils::getOnlineState() -> bool {
-  QNetworkAccessManager nam;
-  QNetworkRequest req(
-        QUrl(QStringLiteral("https://github.com/inyokaproject/inyokaedit")));
-  QNetworkReply *reply = nam.get(req);
-  QEventLoop loop;
-  connect(reply, &QNetworkReply::readyRead, &loop, &QEventLoop::quit);
-  connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-  if (!reply->isFinished()) {
-    loop.exec();
-  }
-  if (reply->bytesAvailable()) {
-    return true;
-  } else {
-    qDebug() << "NO internet connection available!";
-    return false;
-  }
+  // Never blocks; state is refreshed in background
+  return ConnectivityMonitor::instance()->isOnline();
 }
 
 // ----------------------------------------------------------------------------
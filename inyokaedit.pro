@@ -23,5 +23,6 @@ equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 8) {
 
 TEMPLATE = subdirs
 CONFIG  += ordered
-SUBDIRS  = plugins \
+SUBDIRS  = libinyokaparser \
+           plugins \
            application
@@ -0,0 +1,38 @@
+#  This file is part of InyokaEdit.
+#  Copyright (C) 2011-2021 The InyokaEdit developers
+#
+#  InyokaEdit is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  InyokaEdit is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+
+# Link the parser library (libinyokaparser.pro has to be built first).
+# The library is placed in the top build folder, i.e. the same relative
+# path from the including project's build folder as in the source tree.
+# It is static, thus each binary has its own caches and registries; a
+# binary creating a parser has to set the image size fallback reader
+# (see imagesizereader.h).
+
+INCLUDEPATH   += $$PWD/../application/parser \
+                 $$PWD/../application/templates
+DEPENDPATH    += $$PWD/../application/parser \
+                 $$PWD/../application/templates
+
+QT            += network
+
+INYOKAPARSER_DIR = $$OUT_PWD/$$relative_path($$PWD/.., $$_PRO_FILE_PWD_)
+
+LIBS          += -L$$INYOKAPARSER_DIR -linyokaparser
+win32-msvc* {
+  PRE_TARGETDEPS += $$INYOKAPARSER_DIR/inyokaparser.lib
+} else {
+  PRE_TARGETDEPS += $$INYOKAPARSER_DIR/libinyokaparser.a
+}
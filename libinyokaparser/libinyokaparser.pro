@@ -0,0 +1,75 @@
+#  This file is part of InyokaEdit.
+#  Copyright (C) 2011-2021 The InyokaEdit developers
+#
+#  InyokaEdit is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  InyokaEdit is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+
+# Inyoka markup parser (without any GUI dependency), linked by the
+# application, plugins and tools. See libinyokaparser.pri for usage.
+
+TEMPLATE      = lib
+CONFIG       += staticlib
+TARGET        = inyokaparser
+DESTDIR       = ../
+
+MOC_DIR       = ./.moc
+OBJECTS_DIR   = ./.objs
+RCC_DIR       = ./.rcc
+
+# Qt GUI is not needed (see ImageSizeCache::setFallbackReader()); Qt
+# Network is used by the link checker of the parser
+QT            = core network
+CONFIG       += c++11
+DEFINES      += QT_NO_FOREACH
+
+CONFIG(debug, debug|release) {
+  CONFIG     += warn_on
+  DEFINES    += QT_DEPRECATED_WARNINGS
+  DEFINES    += QT_DISABLE_DEPRECATED_BEFORE=0x060000
+}
+
+# Linked into the (shared) plugins as well
+unix: QMAKE_CXXFLAGS += $$QMAKE_CXXFLAGS_SHLIB
+
+# Same preview selection as the application (without linking the modules),
+# since the generated HTML differs slightly
+isEmpty(PREVIEW) {
+  qtHaveModule(webkitwidgets) {
+    DEFINES   += USEQTWEBKIT
+  } else {
+    qtHaveModule(webenginewidgets) {
+      DEFINES += USEQTWEBENGINE
+    } else {
+      DEFINES += NOPREVIEW
+    }
+  }
+} else {
+  equals(PREVIEW, "useqtwebkit") {
+    DEFINES   += USEQTWEBKIT
+  } else {
+    equals(PREVIEW, "useqtwebengine") {
+      DEFINES += USEQTWEBENGINE
+    } else {
+      DEFINES += NOPREVIEW
+    }
+  }
+}
+
+include(../application/templates/templates.pri)
+include(../application/parser/parser.pri)
+
+HEADERS      += ../application/syntaxcheck.h
+
+SOURCES      += ../application/syntaxcheck.cpp
+
+RESOURCES     = libinyokaparser.qrc
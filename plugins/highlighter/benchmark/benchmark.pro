@@ -0,0 +1,43 @@
+#  This file is part of InyokaEdit.
+#  Copyright (C) 2021 The InyokaEdit developers
+#
+#  InyokaEdit is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  InyokaEdit is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+
+# Highlighting throughput benchmark, not part of the regular build. Build
+# the parser library first, then this project from the same build tree
+# (e.g. _build/plugins/highlighter/benchmark), see main.cpp for usage.
+
+TEMPLATE      = app
+CONFIG       += console
+CONFIG       -= app_bundle
+TARGET        = highlighterbenchmark
+
+MOC_DIR       = ./.moc
+OBJECTS_DIR   = ./.objs
+RCC_DIR       = ./.rcc
+
+QT           += gui
+CONFIG       += c++11
+DEFINES      += QT_NO_FOREACH
+
+include(../../../libinyokaparser/libinyokaparser.pri)
+
+INCLUDEPATH  += ..
+
+HEADERS      += ../inyokatokenizer.h \
+                ../syntaxhighlighter.h
+
+SOURCES      += main.cpp \
+                ../inyokatokenizer.cpp \
+                ../syntaxhighlighter.cpp
@@ -0,0 +1,218 @@
+/**
+ * \file main.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Highlighting throughput benchmark (lines per second).
+ *
+ * Usage: highlighterbenchmark -s <share folder> [-c <community>]
+ *        [-l <minimum lines>] [-r <runs>] <article files>
+ *
+ * Each article is repeated until it has the minimum number of lines. The
+ * best of all runs is reported for the tokenizer alone and for a complete
+ * rehighlight of a document. Without display, run it with
+ * QT_QPA_PLATFORM=offscreen.
+ */
+
+#include <QColor>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QSharedPointer>
+#include <QTextCharFormat>
+#include <QTextDocument>
+#include <QTextStream>
+
+#include "./inyokatokenizer.h"
+#include "./syntaxhighlighter.h"
+#include "./templates.h"
+
+namespace {
+using TokenizerPtr = QSharedPointer<const InyokaTokenizer>;
+
+// Same keyword lists as Highlighter::getTranslations()
+void readMacroKeywords(QStringList *pListMacros, QStringList *pListParser) {
+  QFile fiMacros(QStringLiteral(":/macros.conf"));
+  if (!fiMacros.open(QIODevice::ReadOnly)) {
+    QTextStream(stderr) << "Could not open macros.conf\n";
+    return;
+  }
+  QTextStream in(&fiMacros);
+  in.setCodec("UTF-8");
+  while (!in.atEnd()) {
+    const QStringList tmpList(in.readLine().trimmed().split(
+                                QStringLiteral("=")));
+    if (2 == tmpList.size()) {
+      const QStringList tmpList2(tmpList[1].split(QStringLiteral(",")));
+      for (const auto &s : tmpList2) {
+        *pListMacros << s.trimmed();
+        if ("Template" == tmpList[0].trimmed() ||
+            "Code" == tmpList[0].trimmed()) {
+          *pListParser << s.trimmed().toLower();
+        }
+      }
+    }
+  }
+}
+
+// Same tokenizer as Highlighter::defineRules()
+auto createTokenizer(const Templates &templates) -> TokenizerPtr {
+  QStringList sListMacros;
+  QStringList sListParser;
+  readMacroKeywords(&sListMacros, &sListParser);
+
+  QStringList sListImgMap(templates.getListFlags());
+  sListImgMap << templates.getListSmilies();
+  QStringList sListTextFormats(templates.getListFormatStart());
+  sListTextFormats << templates.getListFormatEnd();
+  sListTextFormats.removeDuplicates();
+
+  return TokenizerPtr(
+        new InyokaTokenizer(sListImgMap, templates.getListIWLs(),
+                            sListMacros, sListParser, sListTextFormats));
+}
+
+auto readArticle(const QString &sFile, const int nMinLines) -> QStringList {
+  QFile file(sFile);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return QStringList();
+  }
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+  const QStringList sListArticle(in.readAll().split('\n'));
+
+  QStringList sListLines;
+  while (sListLines.size() < nMinLines) {
+    sListLines << sListArticle;
+  }
+  return sListLines;
+}
+
+auto linesPerSecond(const int nLines, const qint64 nNsecs) -> qint64 {
+  return static_cast<qint64>(nLines) * Q_INT64_C(1000000000) /
+      qMax(Q_INT64_C(1), nNsecs);
+}
+}  // namespace
+
+// ----------------------------------------------------------------------------
+
+auto main(int argc, char *argv[]) -> int {
+  QGuiApplication app(argc, argv);
+  // Resources of the static parser library (macros.conf)
+  Q_INIT_RESOURCE(libinyokaparser);
+
+  QCommandLineParser cmdparser;
+  cmdparser.setApplicationDescription(
+        QStringLiteral("Benchmark of the Inyoka syntax highlighting"));
+  cmdparser.addHelpOption();
+  QCommandLineOption cmdShare(QStringList() << QStringLiteral("s") <<
+                              QStringLiteral("share"),
+                              QStringLiteral("Share folder (containing the "
+                                             "community files)"),
+                              QStringLiteral("Path to folder"));
+  cmdparser.addOption(cmdShare);
+  QCommandLineOption cmdCommunity(QStringList() << QStringLiteral("c") <<
+                                  QStringLiteral("community"),
+                                  QStringLiteral("Community"),
+                                  QStringLiteral("Name"),
+                                  QStringLiteral("ubuntuusers_de"));
+  cmdparser.addOption(cmdCommunity);
+  QCommandLineOption cmdLines(QStringList() << QStringLiteral("l") <<
+                              QStringLiteral("lines"),
+                              QStringLiteral("Minimum number of lines"),
+                              QStringLiteral("Number"),
+                              QStringLiteral("10000"));
+  cmdparser.addOption(cmdLines);
+  QCommandLineOption cmdRuns(QStringList() << QStringLiteral("r") <<
+                             QStringLiteral("runs"),
+                             QStringLiteral("Number of runs"),
+                             QStringLiteral("Number"),
+                             QStringLiteral("5"));
+  cmdparser.addOption(cmdRuns);
+  cmdparser.addPositionalArgument(QStringLiteral("files"),
+                                  QStringLiteral("Article files"));
+  cmdparser.process(app);
+
+  QTextStream out(stdout);
+  QTextStream err(stderr);
+  if (!cmdparser.isSet(cmdShare) ||
+      cmdparser.positionalArguments().isEmpty()) {
+    cmdparser.showHelp(1);
+  }
+  const int nMinLines = qMax(1, cmdparser.value(cmdLines).toInt());
+  const int nRuns = qMax(1, cmdparser.value(cmdRuns).toInt());
+
+  const Templates templates(cmdparser.value(cmdCommunity),
+                            cmdparser.value(cmdShare), QDir::tempPath());
+  const TokenizerPtr pTokenizer(createTokenizer(templates));
+  QVector<QTextCharFormat> formats(InyokaTokenizer::TokenTypeCount);
+  for (int i = 0; i < formats.size(); i++) {
+    formats[i].setForeground(QColor::fromHsv(i * 30, 255, 200));
+  }
+
+  const QStringList sListFiles(cmdparser.positionalArguments());
+  for (const auto &sFile : sListFiles) {
+    const QStringList sListLines(readArticle(sFile, nMinLines));
+    if (sListLines.isEmpty()) {
+      err << "Could not read: " << sFile << "\n";
+      continue;
+    }
+
+    QTextDocument doc;
+    doc.setPlainText(sListLines.join('\n'));
+    SyntaxHighlighter highlighter(&doc);
+    highlighter.setTokenizer(pTokenizer, formats);
+
+    qint64 nBestTokenize = -1;
+    qint64 nBestHighlight = -1;
+    int nTokens = 0;
+    QElapsedTimer timer;
+    for (int nRun = 0; nRun < nRuns; nRun++) {
+      timer.start();
+      nTokens = 0;
+      for (const auto &sLine : sListLines) {
+        nTokens += pTokenizer->tokenize(sLine).size();
+      }
+      qint64 nElapsed = timer.nsecsElapsed();
+      if (nBestTokenize < 0 || nElapsed < nBestTokenize) {
+        nBestTokenize = nElapsed;
+      }
+
+      timer.start();
+      highlighter.rehighlight();
+      nElapsed = timer.nsecsElapsed();
+      if (nBestHighlight < 0 || nElapsed < nBestHighlight) {
+        nBestHighlight = nElapsed;
+      }
+    }
+
+    out << sFile << ": " << sListLines.size() << " lines, "
+        << nTokens << " tokens\n"
+        << "  tokenizer:    "
+        << linesPerSecond(sListLines.size(), nBestTokenize) << " lines/s\n"
+        << "  highlighting: "
+        << linesPerSecond(doc.blockCount(), nBestHighlight) << " lines/s\n";
+  }
+
+  return 0;
+}
@@ -30,9 +30,13 @@
 #include <QColorDialog>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QSettings>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTimer>
 
 #include "../../application/templates/templates.h"
 #include "../../application/texteditor.h"
@@ -41,6 +45,12 @@
 
 const QString Highlighter::sSEPARATOR = QStringLiteral("|");
 
+namespace {
+// Maximum time spent per rehighlighting chunk before returning to the
+// event loop (milliseconds)
+const qint64 REHIGHLIGHT_SLICE = 15;
+}  // namespace
+
 void Highlighter::initPlugin(QWidget *pParent, TextEditor *pEditor,
                              const QDir &userDataDir,
                              const QString &sSharePath) {
@@ -82,6 +92,12 @@ void Highlighter::initPlugin(QWidget *pParent, TextEditor *pEditor,
   m_pSettings->endGroup();
 
   m_pStyleSet = nullptr;
+  m_pRehighlightTimer = new QTimer(this);
+  m_pRehighlightTimer->setSingleShot(true);
+  m_pRehighlightTimer->setInterval(0);
+  connect(m_pRehighlightTimer, &QTimer::timeout,
+          this, &Highlighter::rehighlightNextChunk);
+
   m_pTemplates = new Templates(
                    m_pSettings->value(QStringLiteral("Inyoka/Community"),
                                       "ubuntuusers_de").toString(),
@@ -726,161 +742,37 @@ void Highlighter::changedStyle(int nIndex) {
 // ----------------------------------------------------------------------------
 
 void Highlighter::defineRules() {
-  HighlightingRule rule;
-  QStringList sListRegExpPatterns;
-  QString sTmpRegExp;
-  m_highlightingRules.clear();
-
-  // Headings (= Heading =)
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  rule.format = m_headingsFormat;
-  for (int i = 5; i > 0; i--) {
-    rule.regexp = QRegularExpression("^\\s*={" + QString::number(i) +
-                                     "}[^=]+={" + QString::number(i) +
-                                     "}\\s*$");
-    m_highlightingRules.append(rule);
-  }
-
-  // Links - everything between [...]
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  rule.format = m_linksFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("\\[{1,1}.+\\]{1,1}"));
-  m_highlightingRules.append(rule);
-
-  // Cell style in tables
-  rule.format = m_tablecellsFormat;
-  rule.regexp = QRegularExpression(
-                  QStringLiteral("^[<]{1,1}.*[>]{1,1}"),
-                  QRegularExpression::MultilineOption |
-                  QRegularExpression::DotMatchesEverythingOption);
-  m_highlightingRules.append(rule);
-  rule.regexp = QRegularExpression(
-                  QStringLiteral("[|][|] *[<]{1,1}.*[>]{1,1}"),
-                  QRegularExpression::DotMatchesEverythingOption);
-  m_highlightingRules.append(rule);
-
-  // New table line
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  rule.format = m_newTableLineFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("^\\+{3}$"));
-  m_highlightingRules.append(rule);
-  rule.regexp = QRegularExpression(QStringLiteral("\\|\\|"));
-  m_highlightingRules.append(rule);
-
   // Image map elements (flags, smilies, etc.)
-  const QStringList listFlags(m_pTemplates->getListFlags());
-  const QStringList listSmilies(m_pTemplates->getListSmilies());
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(listFlags.size() + listSmilies.size());
-  for (const auto &tmpStr : listFlags) {
-    sListRegExpPatterns << QRegularExpression::escape(tmpStr);
-  }
-  // sListRegExpPatterns << "\\{([a-z]{2}|[A-Z]{2})\\}";  // Flags
-  for (const auto &tmpStr : listSmilies) {
-    sListRegExpPatterns << QRegularExpression::escape(tmpStr);
-  }
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  for (const auto &sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.format = m_imgMapFormat;
-    rule.regexp = QRegularExpression(sPattern);
-    m_highlightingRules.append(rule);
-  }
-
-  // InterWiki-Links
-  const QStringList listIWLs(m_pTemplates->getListIWLs());
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(listIWLs.size());
-  for (const auto &tmpStr : listIWLs) {
-    sListRegExpPatterns << "\\[{1,1}\\b" + tmpStr + "\\b:.+\\]{1,1}";
-  }
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  for (const auto &sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.format = m_interwikiLinksFormat;
-    rule.regexp = QRegularExpression(sPattern);
-    m_highlightingRules.append(rule);
-  }
-
-  // Macros ([[Vorlage(...) etc.)
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(m_sListMacroKeywords.size() + 1);
-  for (const auto &tmpStr : qAsConst(m_sListMacroKeywords)) {
-    sListRegExpPatterns << "\\[\\[" + tmpStr + "\\ *\\(";
-  }
-  sListRegExpPatterns << QStringLiteral("\\)\\]\\]");
-  rule.regexp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-  for (const auto &sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.format = m_macrosFormat;
-    rule.regexp.setPattern(sPattern);
-    m_highlightingRules.append(rule);
-  }
-
-  // Parser ({{{#!code etc.)
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(m_sListParserKeywords.size() + 2);
-  for (const auto &tmpStr : qAsConst(m_sListParserKeywords)) {
-    sListRegExpPatterns << QRegularExpression::escape("{{{#!" + tmpStr);
-  }
-  sListRegExpPatterns << QRegularExpression::escape(QStringLiteral("{{{")) <<
-                         QRegularExpression::escape(QStringLiteral("}}}"));
-  rule.regexp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-  for (const auto &sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.format = m_parserFormat;
-    rule.regexp.setPattern(sPattern);
-    m_highlightingRules.append(rule);
-  }
-
-  // Define textformat keywords (bold, italic, etc.)
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(m_pTemplates->getListFormatStart().size() +
-                              m_pTemplates->getListFormatEnd().size());
-  sListRegExpPatterns.append(m_pTemplates->getListFormatStart());
-  sListRegExpPatterns.append(m_pTemplates->getListFormatEnd());
-  sListRegExpPatterns.removeDuplicates();
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  for (auto sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.format = m_textformatFormat;
-    if (sPattern.startsWith(QLatin1String("RegExp="))) {
-      sTmpRegExp = sPattern.remove(QStringLiteral("RegExp="));
-    } else {
-      sTmpRegExp = QRegularExpression::escape(sPattern);
-    }
-    rule.regexp = QRegularExpression(sTmpRegExp);
-    m_highlightingRules.append(rule);
-  }
-
-  // Comments (## comment)
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  rule.format = m_commentFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("^##.*$"));
-  m_highlightingRules.append(rule);
-
-  // List
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  rule.format = m_listFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("^\\s+\\*\\s+"));
-  m_highlightingRules.append(rule);
-  rule.format = m_listFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("^\\s+[1aAiI]\\.\\s+"));
-  m_highlightingRules.append(rule);
-
-  // Misc
-  sListRegExpPatterns.clear();
-  sListRegExpPatterns.reserve(2);
-  sListRegExpPatterns << QRegularExpression::escape(QStringLiteral("[[BR]]")) <<
-                         QRegularExpression::escape(QStringLiteral("\\\\"));
-  rule.regexp.setPatternOptions(QRegularExpression::NoPatternOption);
-  for (const auto &sPattern : qAsConst(sListRegExpPatterns)) {
-    rule.regexp = QRegularExpression(sPattern);
-    rule.format = m_miscFormat;
-    m_highlightingRules.append(rule);
-  }
-  rule.format = m_miscFormat;
-  rule.regexp = QRegularExpression(QStringLiteral("^# *tag:"));
-  m_highlightingRules.append(rule);
-  rule.regexp = QRegularExpression(QStringLiteral("^----$"));
-  m_highlightingRules.append(rule);
-  rule.regexp = QRegularExpression(QStringLiteral("^>+"));
-  m_highlightingRules.append(rule);
+  QStringList sListImgMap(m_pTemplates->getListFlags());
+  sListImgMap << m_pTemplates->getListSmilies();
+
+  // Textformat keywords (bold, italic, etc.)
+  QStringList sListTextFormats(m_pTemplates->getListFormatStart());
+  sListTextFormats << m_pTemplates->getListFormatEnd();
+  sListTextFormats.removeDuplicates();
+
+  // Build once, shared by the highlighters of all editors
+  m_pTokenizer = QSharedPointer<const InyokaTokenizer>(
+                   new InyokaTokenizer(sListImgMap,
+                                       m_pTemplates->getListIWLs(),
+                                       m_sListMacroKeywords,
+                                       m_sListParserKeywords,
+                                       sListTextFormats));
+
+  // Indexed by InyokaTokenizer::TokenType
+  m_Formats.resize(InyokaTokenizer::TokenTypeCount);
+  m_Formats[InyokaTokenizer::Heading] = m_headingsFormat;
+  m_Formats[InyokaTokenizer::Link] = m_linksFormat;
+  m_Formats[InyokaTokenizer::TableCell] = m_tablecellsFormat;
+  m_Formats[InyokaTokenizer::TableLine] = m_newTableLineFormat;
+  m_Formats[InyokaTokenizer::ImgMap] = m_imgMapFormat;
+  m_Formats[InyokaTokenizer::InterWiki] = m_interwikiLinksFormat;
+  m_Formats[InyokaTokenizer::Macro] = m_macrosFormat;
+  m_Formats[InyokaTokenizer::Parser] = m_parserFormat;
+  m_Formats[InyokaTokenizer::TextFormat] = m_textformatFormat;
+  m_Formats[InyokaTokenizer::Comment] = m_commentFormat;
+  m_Formats[InyokaTokenizer::List] = m_listFormat;
+  m_Formats[InyokaTokenizer::Misc] = m_miscFormat;
 }
 
 // ----------------------------------------------------------------------------
@@ -910,24 +802,28 @@ void Highlighter::showSettings() {
 // ----------------------------------------------------------------------------
 
 void Highlighter::setCurrentEditor(TextEditor *pEditor) {
-  Q_UNUSED(pEditor)
+  m_pCurrentEditor = pEditor;
+  // Background tabs are rehighlighted lazily when they get activated
+  this->startRehighlighting();
 }
 
 void Highlighter::setEditorlist(const QList<TextEditor *> &listEditors) {
-  m_ListHighlighters.clear();
-
-  for (auto *pEd : listEditors) {
-    if (!m_listEditors.contains(pEd)) {
-      m_listEditors << pEd;
+  // Highlighters of closed editors are deleted together with the document
+  const QList<TextEditor *> listKnownEditors(m_Highlighters.keys());
+  for (auto *pEd : listKnownEditors) {
+    if (!listEditors.contains(pEd)) {
+      m_Highlighters.remove(pEd);
+      m_StaleEditors.remove(pEd);
     }
   }
-  for (auto *pEd : qAsConst(m_listEditors)) {
-    if (!listEditors.contains(pEd)) {
-      m_listEditors.removeOne(pEd);
-    } else {
-      m_ListHighlighters << new SyntaxHighlighter(pEd->document());
+  for (auto *pEd : listEditors) {
+    if (!m_Highlighters.contains(pEd)) {
+      auto *pHighlighter = new SyntaxHighlighter(pEd->document());
+      pHighlighter->setTokenizer(m_pTokenizer, m_Formats);
+      m_Highlighters.insert(pEd, pHighlighter);
     }
   }
+  m_listEditors = listEditors;
 
   this->rehighlightAll();
 }
@@ -936,9 +832,10 @@ void Highlighter::setEditorlist(const QList<TextEditor *> &listEditors) {
 // ----------------------------------------------------------------------------
 
 void Highlighter::rehighlightAll() {
-  for (auto *hlight : qAsConst(m_ListHighlighters)) {
-    hlight->setRules(m_highlightingRules);
-    hlight->rehighlight();
+  for (auto it = m_Highlighters.constBegin();
+       it != m_Highlighters.constEnd(); ++it) {
+    it.value()->setTokenizer(m_pTokenizer, m_Formats);
+    m_StaleEditors.insert(it.key(), QTextCursor(it.key()->document()));
   }
 
   QPalette pal;
@@ -947,6 +844,66 @@ void Highlighter::rehighlightAll() {
   for (auto *editor : qAsConst(m_listEditors)) {
     editor->setPalette(pal);
   }
+
+  this->startRehighlighting();
+}
+
+// ----------------------------------------------------------------------------
+
+void Highlighter::startRehighlighting() {
+  m_pRehighlightTimer->stop();
+  if (m_pCurrentEditor.isNull() ||
+      !m_StaleEditors.contains(m_pCurrentEditor)) {
+    return;
+  }
+
+  // Visible part first, remaining blocks in chunks while idle
+  this->rehighlightVisible(m_pCurrentEditor);
+  m_pRehighlightTimer->start();
+}
+
+// ----------------------------------------------------------------------------
+
+void Highlighter::rehighlightVisible(TextEditor *pEditor) {
+  SyntaxHighlighter *pHighlighter = m_Highlighters.value(pEditor);
+  QTextBlock block(pEditor->cursorForPosition(QPoint(0, 0)).block());
+  const int nHeight = pEditor->viewport()->height();
+  const QTextBlock lastBlock(
+        pEditor->cursorForPosition(QPoint(0, nHeight)).block());
+  while (block.isValid()) {
+    pHighlighter->rehighlightBlock(block);
+    if (block == lastBlock) {
+      break;
+    }
+    block = block.next();
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void Highlighter::rehighlightNextChunk() {
+  if (m_pCurrentEditor.isNull() ||
+      !m_StaleEditors.contains(m_pCurrentEditor)) {
+    return;
+  }
+
+  SyntaxHighlighter *pHighlighter = m_Highlighters.value(m_pCurrentEditor);
+  QTextCursor &cursor = m_StaleEditors[m_pCurrentEditor];
+  QElapsedTimer timer;
+  timer.start();
+  QTextBlock block(cursor.block());
+  while (block.isValid() && timer.elapsed() < REHIGHLIGHT_SLICE) {
+    pHighlighter->rehighlightBlock(block);
+    block = block.next();
+  }
+
+  if (block.isValid()) {
+    // The cursor keeps track of edits made in the meantime
+    cursor.setPosition(block.position());
+    m_pRehighlightTimer->start();
+  } else {
+    m_StaleEditors.remove(m_pCurrentEditor);
+  }
 }
 
 // ----------------------------------------------------------------------------
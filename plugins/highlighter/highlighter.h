@@ -29,6 +29,10 @@
 #define PLUGINS_HIGHLIGHTER_HIGHLIGHTER_H_
 
 #include <QtPlugin>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTextCursor>
 #include <QTextCharFormat>
 #include <QTranslator>
 #include <QVector>
@@ -37,6 +41,7 @@
 #include "../../application/ieditorplugin.h"
 
 class QSettings;
+class QTimer;
 
 class Templates;
 class TextEditor;
@@ -79,6 +84,7 @@ class Highlighter : public QObject, IEditorPlugin {
     void changedStyle(int nIndex);
     void clickedStyleCell(int nRow, int nCol);
     void accept();
+    void rehighlightNextChunk();
 
  private:
     void copyDefaultStyles();
@@ -94,14 +100,20 @@ class Highlighter : public QObject, IEditorPlugin {
     void writeFormat(const QString &sKey, const QTextCharFormat &charFormat);
     static auto evalKey(const QString &sKey) -> QTextCharFormat;
     void rehighlightAll();
+    void startRehighlighting();
+    void rehighlightVisible(TextEditor *pEditor);
 
     Ui::HighlighterDialog *m_pUi;
     QTranslator m_translator;
     QString m_sSharePath;
     QDialog *m_pDialog;
     QSettings *m_pSettings;
-    QList<SyntaxHighlighter *> m_ListHighlighters;
+    QHash<TextEditor *, SyntaxHighlighter *> m_Highlighters;
     QList<TextEditor *> m_listEditors;
+    QPointer<TextEditor> m_pCurrentEditor;
+    // Start of the blocks not yet rehighlighted with the current style
+    QHash<TextEditor *, QTextCursor> m_StaleEditors;
+    QTimer *m_pRehighlightTimer;
     Templates *m_pTemplates;
 
     QString m_sStyleFile;
@@ -111,7 +123,8 @@ class Highlighter : public QObject, IEditorPlugin {
     QStringList m_sListMacroKeywords;
     QStringList m_sListParserKeywords;
 
-    QVector<HighlightingRule> m_highlightingRules;
+    QSharedPointer<const InyokaTokenizer> m_pTokenizer;
+    QVector<QTextCharFormat> m_Formats;
     QTextCharFormat m_headingsFormat;
     QTextCharFormat m_interwikiLinksFormat;
     QTextCharFormat m_linksFormat;
@@ -32,8 +32,7 @@ OBJECTS_DIR   = ./.objs
 UI_DIR        = ./.ui
 RCC_DIR       = ./.rcc
 
-include(../../application/templates/templates.pri)
-
+QT           += widgets
 CONFIG       += c++11
 DEFINES      += QT_NO_FOREACH
 
@@ -43,10 +42,14 @@ CONFIG(debug, debug|release) {
   DEFINES    += QT_DISABLE_DEPRECATED_BEFORE=0x060000
 }
 
+include(../../libinyokaparser/libinyokaparser.pri)
+
 HEADERS      += highlighter.h \
+                inyokatokenizer.h \
                 syntaxhighlighter.h
 
 SOURCES      += highlighter.cpp \
+                inyokatokenizer.cpp \
                 syntaxhighlighter.cpp
 
 FORMS        += highlighter.ui
@@ -0,0 +1,339 @@
+/**
+ * \file inyokatokenizer.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Single scan tokenizer for Inyoka markup highlighting.
+ */
+
+#include "./inyokatokenizer.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace {
+// Same character classes as \s and \w of QRegularExpression (ASCII only)
+auto isSpace(const QChar c) -> bool {
+  const ushort n = c.unicode();
+  return ' ' == n || (n >= '\t' && n <= '\r');
+}
+
+auto isWordChar(const QChar c) -> bool {
+  const ushort n = c.unicode();
+  return (n >= 'a' && n <= 'z') || (n >= 'A' && n <= 'Z') ||
+      (n >= '0' && n <= '9') || '_' == n;
+}
+}  // namespace
+
+InyokaTokenizer::InyokaTokenizer(const QStringList &sListImgMap,
+                                 const QStringList &sListIWLs,
+                                 const QStringList &sListMacros,
+                                 const QStringList &sListParser,
+                                 const QStringList &sListTextFormats)
+  : m_Trie(1),
+    m_TrieNoCase(1) {
+  // Image map elements (flags, smilies, etc.)
+  for (const auto &s : sListImgMap) {
+    this->addKeyword(s, ImgMap);
+  }
+
+  // InterWiki links [iwl:...], prefix has to be enclosed by word boundaries
+  for (const auto &s : sListIWLs) {
+    if (!s.isEmpty() && isWordChar(s.at(0)) &&
+        isWordChar(s.at(s.size() - 1))) {
+      this->addKeyword("[" + s, InterWiki, true, InterWikiLink);
+    }
+  }
+
+  // Macros [[Macro(...)]]
+  for (const auto &s : sListMacros) {
+    this->addKeyword("[[" + s, Macro, false, MacroArguments);
+  }
+  this->addKeyword(QStringLiteral(")]]"), Macro);
+
+  // Parser {{{#!code ...}}}
+  for (const auto &s : sListParser) {
+    this->addKeyword("{{{#!" + s, Parser, false);
+  }
+  this->addKeyword(QStringLiteral("{{{"), Parser);
+  this->addKeyword(QStringLiteral("}}}"), Parser);
+
+  // Text formats (bold, italic, etc.)
+  for (const auto &s : sListTextFormats) {
+    if (s.startsWith(QLatin1String("RegExp="))) {
+      QRegularExpression regexp(s.mid(7),
+                                QRegularExpression::InvertedGreedinessOption);
+      if (!regexp.isValid()) {
+        qWarning() << "Invalid text format expression:" << regexp.pattern()
+                   << regexp.errorString();
+        continue;
+      }
+      regexp.optimize();
+      m_TextFormatRegExps << regexp;
+    } else {
+      this->addKeyword(s, TextFormat);
+    }
+  }
+
+  // Misc
+  this->addKeyword(QStringLiteral("[[BR]]"), Misc);
+  this->addKeyword(QStringLiteral("\\\\"), Misc);
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaTokenizer::addKeyword(const QString &sKeyword,
+                                 const TokenType type,
+                                 const bool bCaseSensitive,
+                                 const Suffix suffix) {
+  if (sKeyword.isEmpty()) {
+    return;
+  }
+
+  QVector<TrieNode> &trie = bCaseSensitive ? m_Trie : m_TrieNoCase;
+  const QString sKey(bCaseSensitive ? sKeyword : sKeyword.toCaseFolded());
+  int nNode = 0;
+  for (const auto c : sKey) {
+    auto it = trie[nNode].next.constFind(c.unicode());
+    if (trie[nNode].next.constEnd() == it) {
+      trie.append(TrieNode());
+      trie[nNode].next.insert(c.unicode(), trie.size() - 1);
+      nNode = trie.size() - 1;
+    } else {
+      nNode = it.value();
+    }
+  }
+
+  Keyword keyword;
+  keyword.type = type;
+  keyword.suffix = suffix;
+  m_Keywords << keyword;
+  trie[nNode].keywords << m_Keywords.size() - 1;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+auto InyokaTokenizer::tokenize(const QString &sLine) const -> QVector<Token> {
+  QVector<Token> tokens;
+  InyokaTokenizer::scanLineStart(sLine, tokens);
+  InyokaTokenizer::scanBrackets(sLine, tokens);
+
+  // Like a separate global match per keyword, matches of the same keyword
+  // must not overlap; different keywords may
+  QVector<int> vNextStart(m_Keywords.size(), 0);
+  for (int i = 0; i < sLine.length(); i++) {
+    this->scanKeywords(sLine, i, m_Trie, true, vNextStart, tokens);
+    this->scanKeywords(sLine, i, m_TrieNoCase, false, vNextStart, tokens);
+  }
+
+  for (const auto &regexp : m_TextFormatRegExps) {
+    QRegularExpressionMatchIterator it = regexp.globalMatch(sLine);
+    while (it.hasNext()) {
+      const QRegularExpressionMatch match(it.next());
+      tokens.append({match.capturedStart(), match.capturedLength(),
+                     TextFormat});
+    }
+  }
+
+  std::stable_sort(tokens.begin(), tokens.end(),
+                   [](const Token &a, const Token &b) {
+    return a.type < b.type;
+  });
+  return tokens;
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaTokenizer::scanKeywords(const QString &sLine, const int nPos,
+                                   const QVector<TrieNode> &trie,
+                                   const bool bCaseSensitive,
+                                   QVector<int> &vNextStart,
+                                   QVector<Token> &tokens) const {
+  int nNode = 0;
+  for (int i = nPos; i < sLine.length(); i++) {
+    const ushort c = bCaseSensitive ? sLine.at(i).unicode()
+                                    : sLine.at(i).toCaseFolded().unicode();
+    auto it = trie.at(nNode).next.constFind(c);
+    if (trie.at(nNode).next.constEnd() == it) {
+      return;
+    }
+    nNode = it.value();
+
+    for (const int nKeyword : trie.at(nNode).keywords) {
+      if (nPos < vNextStart.at(nKeyword)) {
+        continue;
+      }
+      const Keyword &keyword = m_Keywords.at(nKeyword);
+      const int nEnd = InyokaTokenizer::matchSuffix(sLine, i + 1,
+                                                    keyword.suffix);
+      if (nEnd >= 0) {
+        tokens.append({nPos, nEnd - nPos, keyword.type});
+        vNextStart[nKeyword] = nEnd;
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Returns end of the match or -1
+auto InyokaTokenizer::matchSuffix(const QString &sLine, const int nPos,
+                                  const Suffix suffix) -> int {
+  switch (suffix) {
+    case MacroArguments: {  // " *\("
+      int i = nPos;
+      while (i < sLine.length() && ' ' == sLine.at(i)) {
+        i++;
+      }
+      return (i < sLine.length() && '(' == sLine.at(i)) ? i + 1 : -1;
+    }
+    case InterWikiLink: {  // ":.+\]"
+      if (nPos >= sLine.length() || ':' != sLine.at(nPos)) {
+        return -1;
+      }
+      const int nClose = sLine.indexOf(']', nPos + 2);
+      return (nClose < 0) ? -1 : nClose + 1;
+    }
+    default:
+      return nPos;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaTokenizer::scanLineStart(const QString &sLine,
+                                    QVector<Token> &tokens) {
+  const int nLen = sLine.length();
+  int nIndent = 0;
+  while (nIndent < nLen && isSpace(sLine.at(nIndent))) {
+    nIndent++;
+  }
+
+  // Headings (= Heading =), same number of '=' on both sides (max. 5)
+  int nEnd = nLen;
+  while (nEnd > nIndent && isSpace(sLine.at(nEnd - 1))) {
+    nEnd--;
+  }
+  int nOpen = 0;
+  while (nIndent + nOpen < nEnd && '=' == sLine.at(nIndent + nOpen)) {
+    nOpen++;
+  }
+  int nClose = 0;
+  while (nEnd - nClose > nIndent + nOpen &&
+         '=' == sLine.at(nEnd - nClose - 1)) {
+    nClose++;
+  }
+  if (nOpen > 0 && nOpen <= 5 && nOpen == nClose &&
+      nEnd - nClose > nIndent + nOpen &&
+      sLine.indexOf('=', nIndent + nOpen) == nEnd - nClose) {
+    tokens.append({0, nLen, Heading});
+  }
+
+  // Cell style at the beginning of a line (<...>)
+  if (sLine.startsWith('<')) {
+    const int nCellEnd = sLine.indexOf('>', 1);
+    if (nCellEnd >= 0) {
+      tokens.append({0, nCellEnd + 1, TableCell});
+    }
+  }
+
+  // New table line
+  if (QLatin1String("+++") == sLine) {
+    tokens.append({0, nLen, TableLine});
+  }
+
+  // Comments (## comment)
+  if (sLine.startsWith(QLatin1String("##"))) {
+    tokens.append({0, nLen, Comment});
+  }
+
+  // List (indented "* " or "1. ", "a. ", ...)
+  if (nIndent > 0 && nIndent < nLen) {
+    const QChar c(sLine.at(nIndent));
+    if ('*' == c && nIndent + 1 < nLen && isSpace(sLine.at(nIndent + 1))) {
+      tokens.append({0, nIndent + 2, List});
+    } else if (QStringLiteral("1aAiI").contains(c) && nIndent + 2 < nLen &&
+               '.' == sLine.at(nIndent + 1) &&
+               isSpace(sLine.at(nIndent + 2))) {
+      tokens.append({0, nIndent + 3, List});
+    }
+  }
+
+  // Misc (tags, horizontal line, quotes)
+  if (sLine.startsWith('#')) {
+    int i = 1;
+    while (i < nLen && ' ' == sLine.at(i)) {
+      i++;
+    }
+    if (sLine.midRef(i, 4) == QLatin1String("tag:")) {
+      tokens.append({0, i + 4, Misc});
+    }
+  }
+  if (QLatin1String("----") == sLine) {
+    tokens.append({0, nLen, Misc});
+  }
+  if (sLine.startsWith('>')) {
+    tokens.append({0, 1, Misc});
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void InyokaTokenizer::scanBrackets(const QString &sLine,
+                                   QVector<Token> &tokens) {
+  // Links - everything between [...]
+  int nPos = sLine.indexOf('[');
+  while (nPos >= 0) {
+    const int nClose = sLine.indexOf(']', nPos + 2);
+    if (nClose < 0) {
+      break;
+    }
+    tokens.append({nPos, nClose - nPos + 1, Link});
+    nPos = sLine.indexOf('[', nClose + 1);
+  }
+
+  // Cell style in tables (|| <...>)
+  nPos = sLine.indexOf(QLatin1String("||"));
+  while (nPos >= 0) {
+    int i = nPos + 2;
+    while (i < sLine.length() && ' ' == sLine.at(i)) {
+      i++;
+    }
+    if (i < sLine.length() && '<' == sLine.at(i)) {
+      const int nClose = sLine.indexOf('>', i + 1);
+      if (nClose >= 0) {
+        tokens.append({nPos, nClose - nPos + 1, TableCell});
+        nPos = sLine.indexOf(QLatin1String("||"), nClose + 1);
+        continue;
+      }
+    }
+    nPos = sLine.indexOf(QLatin1String("||"), nPos + 1);
+  }
+
+  // Table cell separator
+  nPos = sLine.indexOf(QLatin1String("||"));
+  while (nPos >= 0) {
+    tokens.append({nPos, 2, TableLine});
+    nPos = sLine.indexOf(QLatin1String("||"), nPos + 2);
+  }
+}
@@ -0,0 +1,114 @@
+/**
+ * \file inyokatokenizer.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2011-2021 The InyokaEdit developers
+ *
+ * This file is part of InyokaEdit.
+ *
+ * InyokaEdit is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * InyokaEdit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with InyokaEdit.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for Inyoka markup tokenizer.
+ */
+
+#ifndef PLUGINS_HIGHLIGHTER_INYOKATOKENIZER_H_
+#define PLUGINS_HIGHLIGHTER_INYOKATOKENIZER_H_
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * \class InyokaTokenizer
+ * \brief Classifies one line of Inyoka markup in a single scan.
+ *
+ * All keywords (image map elements, InterWiki prefixes, macros, parser
+ * keywords, text formats) are stored in one prefix tree, which is walked
+ * once from every position of the line. Tokens are returned in the order
+ * they have to be applied, i.e. later tokens override earlier ones.
+ */
+class InyokaTokenizer {
+ public:
+    // In order of precedence, later types override earlier ones
+    enum TokenType {
+      Heading,
+      Link,
+      TableCell,
+      TableLine,
+      ImgMap,
+      InterWiki,
+      Macro,
+      Parser,
+      TextFormat,
+      Comment,
+      List,
+      Misc,
+      TokenTypeCount
+    };
+
+    struct Token {
+      int nStart;
+      int nLength;
+      TokenType type;
+    };
+
+    InyokaTokenizer(const QStringList &sListImgMap,
+                    const QStringList &sListIWLs,
+                    const QStringList &sListMacros,
+                    const QStringList &sListParser,
+                    const QStringList &sListTextFormats);
+
+    // Thread-safe; tokens are sorted by type
+    auto tokenize(const QString &sLine) const -> QVector<Token>;
+
+ private:
+    // Additional syntax required after a keyword
+    enum Suffix {
+      NoSuffix,
+      MacroArguments,  // [[Macro (
+      InterWikiLink    // [iwl:...]
+    };
+
+    struct Keyword {
+      TokenType type;
+      Suffix suffix;
+    };
+
+    struct TrieNode {
+      QHash<ushort, int> next;
+      QVector<int> keywords;
+    };
+
+    void addKeyword(const QString &sKeyword, const TokenType type,
+                    const bool bCaseSensitive = true,
+                    const Suffix suffix = NoSuffix);
+    void scanKeywords(const QString &sLine, const int nPos,
+                      const QVector<TrieNode> &trie,
+                      const bool bCaseSensitive, QVector<int> &vNextStart,
+                      QVector<Token> &tokens) const;
+    static auto matchSuffix(const QString &sLine, const int nPos,
+                            const Suffix suffix) -> int;
+    static void scanLineStart(const QString &sLine, QVector<Token> &tokens);
+    static void scanBrackets(const QString &sLine, QVector<Token> &tokens);
+
+    QVector<Keyword> m_Keywords;
+    QVector<TrieNode> m_Trie;
+    QVector<TrieNode> m_TrieNoCase;  // Case folded keywords
+    QVector<QRegularExpression> m_TextFormatRegExps;
+};
+
+#endif  // PLUGINS_HIGHLIGHTER_INYOKATOKENIZER_H_
@@ -36,30 +36,23 @@ SyntaxHighlighter::~SyntaxHighlighter() = default;
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void SyntaxHighlighter::setRules(const QVector<HighlightingRule> &rules) {
-  m_highlightingRules = rules;
+void SyntaxHighlighter::setTokenizer(
+    const QSharedPointer<const InyokaTokenizer> &pTokenizer,
+    const QVector<QTextCharFormat> &formats) {
+  m_pTokenizer = pTokenizer;
+  m_Formats = formats;
 }
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-// Apply collected highlighting rules
+// Apply formats of all tokens found in one scan of the line
 void SyntaxHighlighter::highlightBlock(const QString &sText) {
-  // Go through each highlighting rule
-  // rules for every syntax element had been appended in constructor
-  QRegularExpressionMatchIterator i;
-  QRegularExpressionMatch match;
-  for (const auto &rule : qAsConst(m_highlightingRules)) {
-    QRegularExpression express(rule.regexp.pattern(),
-                               rule.regexp.patternOptions() |
-                               QRegularExpression::InvertedGreedinessOption);
-    i = express.globalMatch(sText);
-    while (i.hasNext()) {
-        match = i.next();
-        if (match.hasMatch()) {
-             this->setFormat(match.capturedStart(), match.capturedLength(),
-                             rule.format);
-        }
+  if (!m_pTokenizer.isNull()) {
+    const QVector<InyokaTokenizer::Token> tokens(
+          m_pTokenizer->tokenize(sText));
+    for (const auto &token : tokens) {
+      this->setFormat(token.nStart, token.nLength, m_Formats.at(token.type));
     }
   }
   setCurrentBlockState(0);
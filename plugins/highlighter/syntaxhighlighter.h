@@ -27,17 +27,14 @@
 #ifndef PLUGINS_HIGHLIGHTER_SYNTAXHIGHLIGHTER_H_
 #define PLUGINS_HIGHLIGHTER_SYNTAXHIGHLIGHTER_H_
 
-#include <QRegularExpression>
+#include <QSharedPointer>
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
 #include <QVector>
 
-class QTextDocument;
+#include "./inyokatokenizer.h"
 
-struct HighlightingRule {
-  QRegularExpression regexp;
-  QTextCharFormat format;
-};
+class QTextDocument;
 
 /**
  * \class SyntaxHighlighter
@@ -50,14 +47,19 @@ class SyntaxHighlighter : public QSyntaxHighlighter {
     explicit SyntaxHighlighter(QTextDocument *pDoc = nullptr,
                                QObject *pParent = nullptr);
     ~SyntaxHighlighter();
-    void setRules(const QVector<HighlightingRule> &rules);
+
+    // One tokenizer can be shared by all highlighters; formats are
+    // indexed by InyokaTokenizer::TokenType
+    void setTokenizer(const QSharedPointer<const InyokaTokenizer> &pTokenizer,
+                      const QVector<QTextCharFormat> &formats);
 
  protected:
     // Apply highlighting rules
     void highlightBlock(const QString &sText) override;
 
  private:
-    QVector<HighlightingRule> m_highlightingRules;
+    QSharedPointer<const InyokaTokenizer> m_pTokenizer;
+    QVector<QTextCharFormat> m_Formats;
 };
 
 #endif  // PLUGINS_HIGHLIGHTER_SYNTAXHIGHLIGHTER_H_
@@ -28,10 +28,11 @@
 
 #include <QApplication>
 #include <QDebug>
-#include <QTextDocument>
 #include <QMessageBox>
 #include <QSettings>
 
+#include "../../application/parser/imagesizecache.h"
+#include "../../application/parser/imagesizereader.h"
 #include "../../application/parser/parser.h"
 #include "../../application/templates/templates.h"
 #include "../../application/texteditor.h"
@@ -56,18 +57,21 @@ void Uu_TableTemplate::initPlugin(QWidget *pParent, TextEditor *pEditor,
   m_pParent = pParent;
   m_pEditor = pEditor;
   m_dirPreview = userDataDir;
-  m_pTextDocument = new QTextDocument(this);
   m_sSharePath = sSharePath;
   m_pTemplates = new Templates(
                    m_pSettings->value(QStringLiteral("Inyoka/Community"),
                                       "ubuntuusers_de").toString(),
                    m_sSharePath, m_dirPreview.absolutePath());
+  // Own copy of the static parser library, independent of the application
+  ImageSizeCache::setFallbackReader(readImageSize);
   m_pParser = new Parser(m_sSharePath, QDir(QLatin1String("")),
                          QLatin1String(""), false, m_pTemplates,
                          m_pSettings->value(QStringLiteral("Inyoka/Community"),
                                             "ubuntuusers_de").toString(),
                          m_pSettings->value(QStringLiteral("Pygmentize"),
-                                            "").toString());
+                                            "").toString(),
+                         m_pSettings->value(QStringLiteral("PreferPygments"),
+                                            true).toBool());
 
   // Build UI
   m_pDialog = new QDialog(m_pParent);
@@ -259,9 +263,8 @@ void Uu_TableTemplate::executePlugin() {}
 
 #ifndef NOPREVIEW
 void Uu_TableTemplate::preview() {
-  m_pTextDocument->setPlainText(this->generateTable());
-
-  QString sRetHtml(m_pParser->genOutput(QLatin1String(""), m_pTextDocument));
+  QString sRetHtml(m_pParser->genOutput(QLatin1String(""),
+                                        this->generateTable()));
   // Remove for preview useless elements
   sRetHtml.remove(
         QRegularExpression(QStringLiteral("<h1 class=\"pagetitle\">.*</h1>"),
@@ -44,7 +44,6 @@
 #include "../../application/ieditorplugin.h"
 
 class QSettings;
-class QTextDocument;
 
 class Parser;
 class Templates;
@@ -103,7 +102,6 @@ class Uu_TableTemplate : public QObject, IEditorPlugin {
     Templates *m_pTemplates;
     Parser *m_pParser;
     QDir m_dirPreview;
-    QTextDocument *m_pTextDocument;
 #ifdef USEQTWEBKIT
     QWebView *m_pPreviewWebview;
 #endif
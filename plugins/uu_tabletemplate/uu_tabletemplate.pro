@@ -32,7 +32,7 @@ OBJECTS_DIR   = ./.objs
 UI_DIR        = ./.ui
 RCC_DIR       = ./.rcc
 
-QT           += network
+QT           += widgets
 CONFIG       += c++11
 DEFINES      += QT_NO_FOREACH
 
@@ -74,16 +74,11 @@ isEmpty(PREVIEW) {
   }
 }
 
-include(../../application/templates/templates.pri)
-include(../../application/parser/parser.pri)
+include(../../libinyokaparser/libinyokaparser.pri)
 
-HEADERS      += uu_tabletemplate.h \
-                ../../application/syntaxcheck.h \
-                ../../application/utils.h
+HEADERS      += uu_tabletemplate.h
 
-SOURCES      += uu_tabletemplate.cpp \
-                ../../application/syntaxcheck.cpp \
-                ../../application/utils.cpp
+SOURCES      += uu_tabletemplate.cpp
 
 FORMS        += uu_tabletemplate.ui
 